@@ -0,0 +1,182 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/api/atom_api_app_state.h"
+
+#include <utility>
+
+#include "atom/common/native_mate_converters/callback.h"
+#include "atom/common/native_mate_converters/v8_value_converter.h"
+#include "base/bind.h"
+#include "base/values.h"
+#include "brave/browser/app_state_store.h"
+#include "brave/browser/brave_browser_context.h"
+#include "native_mate/arguments.h"
+#include "native_mate/object_template_builder.h"
+
+namespace atom {
+
+namespace api {
+
+AppState::AppState(v8::Isolate* isolate,
+                   content::BrowserContext* browser_context)
+    : browser_context_(
+          brave::BraveBrowserContext::FromBrowserContext(browser_context)),
+      weak_factory_(this) {
+  Init(isolate);
+}
+
+AppState::~AppState() {
+}
+
+brave::AppStateStore* AppState::GetStore(mate::Arguments* args,
+                                         std::string* section,
+                                         bool write) {
+  if (!args->GetNext(section) ||
+      !brave::AppStateStore::IsValidSectionName(*section)) {
+    args->ThrowError("Invalid section name");
+    return nullptr;
+  }
+
+  if (write && browser_context_->IsOffTheRecord())
+    return nullptr;
+
+  return browser_context_->app_state_store();
+}
+
+std::unique_ptr<base::Value> AppState::GetValue(mate::Arguments* args) {
+  v8::Local<v8::Value> value;
+  if (!args->GetNext(&value) || value->IsUndefined())
+    return nullptr;
+
+  std::unique_ptr<atom::V8ValueConverter> converter(new atom::V8ValueConverter);
+  return std::unique_ptr<base::Value>(converter->FromV8Value(
+      value, isolate()->GetCurrentContext()));
+}
+
+void AppState::Get(mate::Arguments* args) {
+  std::string section;
+  brave::AppStateStore* store = GetStore(args, &section, false);
+  if (!store)
+    return;
+
+  GetCallback callback;
+  if (!args->GetNext(&callback)) {
+    args->ThrowError("callback is a required field");
+    return;
+  }
+
+  store->Get(section, base::Bind(&AppState::OnGet,
+                                 weak_factory_.GetWeakPtr(), callback));
+}
+
+void AppState::Set(mate::Arguments* args) {
+  std::string section;
+  brave::AppStateStore* store = GetStore(args, &section, true);
+  if (!store)
+    return;
+
+  std::unique_ptr<base::Value> value = GetValue(args);
+  if (!value) {
+    args->ThrowError("value is a required field");
+    return;
+  }
+  store->Set(section, std::move(value));
+}
+
+void AppState::Remove(mate::Arguments* args) {
+  std::string section;
+  brave::AppStateStore* store = GetStore(args, &section, true);
+  if (store)
+    store->Set(section, nullptr);
+}
+
+void AppState::SetKey(mate::Arguments* args) {
+  std::string section;
+  brave::AppStateStore* store = GetStore(args, &section, true);
+  if (!store)
+    return;
+
+  std::string key;
+  if (!args->GetNext(&key)) {
+    args->ThrowError("key is a required field");
+    return;
+  }
+
+  std::unique_ptr<base::Value> value = GetValue(args);
+  if (!value) {
+    args->ThrowError("value is a required field");
+    return;
+  }
+  store->SetKey(section, key, std::move(value));
+}
+
+void AppState::RemoveKey(mate::Arguments* args) {
+  std::string section;
+  brave::AppStateStore* store = GetStore(args, &section, true);
+  if (!store)
+    return;
+
+  std::string key;
+  if (!args->GetNext(&key)) {
+    args->ThrowError("key is a required field");
+    return;
+  }
+  store->SetKey(section, key, nullptr);
+}
+
+void AppState::MigrateFromPrefs(mate::Arguments* args) {
+  base::Callback<void(bool)> callback;
+  args->GetNext(&callback);
+  if (callback.is_null())
+    callback = base::DoNothing::Repeatedly<bool>();
+
+  // The store is shared with the original profile, which owns the prefs.
+  if (browser_context_->IsOffTheRecord()) {
+    callback.Run(false);
+    return;
+  }
+  browser_context_->MigrateAppStateFromPrefs(callback);
+}
+
+void AppState::OnGet(const GetCallback& callback,
+                     std::unique_ptr<base::Value> value) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Context> context = GetWrapper()->CreationContext();
+  v8::Context::Scope context_scope(context);
+
+  if (!value) {
+    callback.Run(v8::Undefined(isolate()));
+    return;
+  }
+
+  std::unique_ptr<atom::V8ValueConverter> converter(new atom::V8ValueConverter);
+  callback.Run(converter->ToV8Value(value.get(), context));
+}
+
+// static
+mate::Handle<AppState> AppState::Create(
+    v8::Isolate* isolate,
+    content::BrowserContext* browser_context) {
+  DCHECK(browser_context);
+  return mate::CreateHandle(isolate, new AppState(isolate, browser_context));
+}
+
+// static
+void AppState::BuildPrototype(v8::Isolate* isolate,
+                              v8::Local<v8::FunctionTemplate> prototype) {
+  prototype->SetClassName(mate::StringToV8(isolate, "AppState"));
+  mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
+      .SetMethod("get", &AppState::Get)
+      .SetMethod("set", &AppState::Set)
+      .SetMethod("remove", &AppState::Remove)
+      .SetMethod("setKey", &AppState::SetKey)
+      .SetMethod("removeKey", &AppState::RemoveKey)
+      .SetMethod("migrateFromPrefs", &AppState::MigrateFromPrefs);
+}
+
+}  // namespace api
+
+}  // namespace atom
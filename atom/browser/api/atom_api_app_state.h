@@ -0,0 +1,79 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_API_ATOM_API_APP_STATE_H_
+#define ATOM_BROWSER_API_ATOM_API_APP_STATE_H_
+
+#include <memory>
+#include <string>
+
+#include "atom/browser/api/trackable_object.h"
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "native_mate/handle.h"
+
+namespace base {
+class Value;
+}
+
+namespace brave {
+class AppStateStore;
+class BraveBrowserContext;
+}
+
+namespace content {
+class BrowserContext;
+}
+
+namespace mate {
+class Arguments;
+}
+
+namespace atom {
+
+namespace api {
+
+class AppState : public mate::TrackableObject<AppState> {
+ public:
+  using GetCallback = base::Callback<void(v8::Local<v8::Value>)>;
+
+  static mate::Handle<AppState> Create(
+      v8::Isolate* isolate, content::BrowserContext* browser_context);
+
+  // mate::TrackableObject:
+  static void BuildPrototype(v8::Isolate* isolate,
+                             v8::Local<v8::FunctionTemplate> prototype);
+
+ protected:
+  AppState(v8::Isolate* isolate, content::BrowserContext* browser_context);
+  ~AppState() override;
+
+  void Get(mate::Arguments* args);
+  void Set(mate::Arguments* args);
+  void Remove(mate::Arguments* args);
+  void SetKey(mate::Arguments* args);
+  void RemoveKey(mate::Arguments* args);
+  void MigrateFromPrefs(mate::Arguments* args);
+
+ private:
+  // Reads the section name and returns the store, or null if the call should
+  // be ignored. Writes to off the record sessions are dropped.
+  brave::AppStateStore* GetStore(mate::Arguments* args,
+                                 std::string* section,
+                                 bool write);
+  std::unique_ptr<base::Value> GetValue(mate::Arguments* args);
+  void OnGet(const GetCallback& callback, std::unique_ptr<base::Value> value);
+
+  brave::BraveBrowserContext* browser_context_;  // not owned
+
+  base::WeakPtrFactory<AppState> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppState);
+};
+
+}  // namespace api
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_API_ATOM_API_APP_STATE_H_
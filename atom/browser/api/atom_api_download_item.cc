@@ -7,6 +7,7 @@
 #include <map>
 
 #include "atom/browser/atom_browser_main_parts.h"
+#include "atom/browser/download_progress_tracker.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
@@ -85,7 +86,8 @@ void DownloadItem::OnDownloadUpdated(download::DownloadItem* item) {
     // Destroy the item once item is downloaded.
     base::ThreadTaskRunnerHandle::Get()->PostTask(
         FROM_HERE, GetDestroyClosure());
-  } else {
+  } else if (!DownloadProgressTracker::IsTracked(item)) {
+    // Tracked items are reported by their session's download-progress event.
     Emit("updated", item->GetState());
   }
 }
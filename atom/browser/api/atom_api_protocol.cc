@@ -9,8 +9,10 @@
 #include "atom/browser/browser.h"
 #include "atom/browser/net/url_request_buffer_job.h"
 #include "atom/browser/net/url_request_fetch_job.h"
+#include "atom/browser/net/url_request_stream_job.h"
 #include "atom/browser/net/url_request_string_job.h"
 #include "atom/common/native_mate_converters/callback.h"
+#include "atom/common/native_mate_converters/gurl_converter.h"
 #include "atom/common/native_mate_converters/v8_value_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
 #include "atom/common/node_includes.h"
@@ -52,6 +54,9 @@ namespace {
 // List of registered custom standard schemes.
 std::vector<std::string> g_standard_schemes;
 
+// Size of a response cache when enableResponseCache is not given one.
+const size_t kDefaultResponseCacheSize = 32 * 1024 * 1024;
+
 }  // namespace
 
 std::vector<std::string> GetStandardSchemes() {
@@ -75,6 +80,7 @@ Protocol::Protocol(v8::Isolate* isolate, Profile* profile)
     : profile_(profile),
       request_context_getter_(static_cast<brightray::URLRequestContextGetter*>(
           profile->GetRequestContext())),
+      response_cache_(new ProtocolResponseCache),
       weak_factory_(this) {
   Init(isolate);
 }
@@ -97,7 +103,7 @@ void Protocol::RegisterProtocol(const std::string& scheme,
   content::BrowserThread::PostTaskAndReplyWithResult(
       content::BrowserThread::IO, FROM_HERE,
       base::Bind(&Protocol::RegisterProtocolInIO<RequestJob>,
-          request_context_getter_,
+          request_context_getter_, response_cache_,
           isolate(), scheme, handler),
       base::Bind(&Protocol::OnIOCompleted,
                  GetWeakPtr(), callback));
@@ -107,6 +113,7 @@ void Protocol::RegisterProtocol(const std::string& scheme,
 template<typename RequestJob>
 Protocol::ProtocolError Protocol::RegisterProtocolInIO(
     scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+    scoped_refptr<ProtocolResponseCache> response_cache,
     v8::Isolate* isolate,
     const std::string& scheme,
     const Handler& handler) {
@@ -116,7 +123,8 @@ Protocol::ProtocolError Protocol::RegisterProtocolInIO(
     return PROTOCOL_REGISTERED;
   std::unique_ptr<CustomProtocolHandler<RequestJob>> protocol_handler(
       new CustomProtocolHandler<RequestJob>(
-          isolate, request_context_getter.get(), handler));
+          isolate, request_context_getter.get(), handler,
+          response_cache.get()));
   if (job_factory->SetProtocolHandler(scheme, std::move(protocol_handler)))
     return PROTOCOL_OK;
   else
@@ -130,7 +138,7 @@ void Protocol::UnregisterProtocol(
   content::BrowserThread::PostTaskAndReplyWithResult(
       content::BrowserThread::IO, FROM_HERE,
       base::Bind(&Protocol::UnregisterProtocolInIO,
-          request_context_getter_, scheme),
+          request_context_getter_, response_cache_, scheme),
       base::Bind(&Protocol::OnIOCompleted,
                  GetWeakPtr(), callback));
 }
@@ -138,12 +146,78 @@ void Protocol::UnregisterProtocol(
 // static
 Protocol::ProtocolError Protocol::UnregisterProtocolInIO(
     scoped_refptr<brightray::URLRequestContextGetter> request_context_getter,
+    scoped_refptr<ProtocolResponseCache> response_cache,
     const std::string& scheme) {
   auto job_factory = static_cast<net::URLRequestJobFactoryImpl*>(
       request_context_getter->job_factory());
   if (!job_factory->IsHandledProtocol(scheme))
     return PROTOCOL_NOT_REGISTERED;
   job_factory->SetProtocolHandler(scheme, nullptr);
+  // A handler registered later may respond differently.
+  response_cache->Invalidate(scheme, GURL());
+  return PROTOCOL_OK;
+}
+
+void Protocol::EnableResponseCache(
+    const std::string& scheme, mate::Arguments* args) {
+  ProtocolResponseCache::Options options;
+  options.max_size = kDefaultResponseCacheSize;
+  mate::Dictionary dict;
+  CompletionCallback callback;
+  if (args->GetNext(&dict)) {
+    dict.Get("maxSize", &options.max_size);
+    dict.Get("vary", &options.vary);
+  }
+  args->GetNext(&callback);
+  content::BrowserThread::PostTaskAndReplyWithResult(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::ConfigureResponseCacheInIO,
+          response_cache_, scheme, options),
+      base::Bind(&Protocol::OnIOCompleted,
+                 GetWeakPtr(), callback));
+}
+
+void Protocol::DisableResponseCache(
+    const std::string& scheme, mate::Arguments* args) {
+  CompletionCallback callback;
+  args->GetNext(&callback);
+  content::BrowserThread::PostTaskAndReplyWithResult(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::ConfigureResponseCacheInIO,
+          response_cache_, scheme, ProtocolResponseCache::Options()),
+      base::Bind(&Protocol::OnIOCompleted,
+                 GetWeakPtr(), callback));
+}
+
+void Protocol::InvalidateResponseCache(
+    const std::string& scheme, mate::Arguments* args) {
+  GURL url;
+  CompletionCallback callback;
+  args->GetNext(&url);
+  args->GetNext(&callback);
+  content::BrowserThread::PostTaskAndReplyWithResult(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&Protocol::InvalidateResponseCacheInIO,
+          response_cache_, scheme, url),
+      base::Bind(&Protocol::OnIOCompleted,
+                 GetWeakPtr(), callback));
+}
+
+// static
+Protocol::ProtocolError Protocol::ConfigureResponseCacheInIO(
+    scoped_refptr<ProtocolResponseCache> response_cache,
+    const std::string& scheme,
+    const ProtocolResponseCache::Options& options) {
+  response_cache->Configure(scheme, options);
+  return PROTOCOL_OK;
+}
+
+// static
+Protocol::ProtocolError Protocol::InvalidateResponseCacheInIO(
+    scoped_refptr<ProtocolResponseCache> response_cache,
+    const std::string& scheme,
+    const GURL& url) {
+  response_cache->Invalidate(scheme, url);
   return PROTOCOL_OK;
 }
 
@@ -261,6 +335,12 @@ void Protocol::BuildPrototype(
                  &Protocol::RegisterProtocol<URLRequestBufferJob>)
       .SetMethod("registerHttpProtocol",
                  &Protocol::RegisterProtocol<URLRequestFetchJob>)
+      .SetMethod("registerStreamProtocol",
+                 &Protocol::RegisterProtocol<URLRequestStreamJob>)
+      .SetMethod("enableResponseCache", &Protocol::EnableResponseCache)
+      .SetMethod("disableResponseCache", &Protocol::DisableResponseCache)
+      .SetMethod("invalidateResponseCache",
+                 &Protocol::InvalidateResponseCache)
       .SetMethod("unregisterProtocol", &Protocol::UnregisterProtocol)
       .SetMethod("isProtocolHandled", &Protocol::IsProtocolHandled)
       .SetMethod("isNavigatorProtocolHandled",
@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "atom/browser/api/atom_api_app_state.h"
 #include "atom/browser/api/atom_api_autofill.h"
 #include "atom/browser/api/atom_api_content_settings.h"
 #include "atom/browser/api/atom_api_cookies.h"
@@ -35,9 +36,9 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/task/cancelable_task_tracker.h"
-#include "base/threading/thread_restrictions.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
+#include "brave/browser/brave_browser_context.h"
 #include "brave/browser/brave_content_browser_client.h"
 #include "brave/browser/brave_permission_manager.h"
 #include "brave/browser/tor/tor_launcher_factory.h"
@@ -400,9 +401,29 @@ void Session::OnDownloadCreated(content::DownloadManager* manager,
   if (prevent_default) {
     item->Cancel(true);
     item->Remove();
+  } else if (download_progress_tracker_ && !item->IsDone()) {
+    download_progress_tracker_->Add(item);
   }
 }
 
+void Session::OnDownloadProgress(
+    const std::vector<DownloadProgressTracker::Progress>& batch) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  std::vector<mate::Dictionary> downloads;
+  for (const auto& progress : batch) {
+    mate::Dictionary download = mate::Dictionary::CreateEmpty(isolate());
+    download.Set("item", DownloadItem::Create(isolate(), progress.item));
+    download.Set("receivedBytes", progress.received_bytes);
+    download.Set("totalBytes", progress.total_bytes);
+    download.Set("bytesPerSecond", progress.speed);
+    download.Set("timeRemaining", progress.time_remaining ?
+        progress.time_remaining->InSecondsF() : -1);
+    downloads.push_back(download);
+  }
+  Emit("download-progress", downloads);
+}
+
 void Session::ResolveProxy(const GURL& url, ResolveProxyCallback callback) {
   new ResolveProxyHelper(request_context_getter_, url, callback);
 }
@@ -489,6 +510,25 @@ void Session::SetDownloadPath(const base::FilePath& path) {
       prefs::kDownloadDefaultDirectory, path);
 }
 
+void Session::SetDownloadProgressInterval(mate::Arguments* args) {
+  int interval;
+  if (!args->GetNext(&interval) || interval < 0) {
+    args->ThrowError("`interval` must be a non-negative number");
+    return;
+  }
+  if (interval == 0) {
+    download_progress_tracker_.reset();
+  } else if (download_progress_tracker_) {
+    download_progress_tracker_->SetInterval(
+        base::TimeDelta::FromMilliseconds(interval));
+  } else {
+    download_progress_tracker_.reset(new DownloadProgressTracker(
+        content::BrowserContext::GetDownloadManager(profile_),
+        base::TimeDelta::FromMilliseconds(interval),
+        base::Bind(&Session::OnDownloadProgress, base::Unretained(this))));
+  }
+}
+
 void Session::SetCertVerifyProc(v8::Local<v8::Value> val,
                                 mate::Arguments* args) {
   AtomCertVerifier::VerifyProc proc;
@@ -570,6 +610,14 @@ v8::Local<v8::Value> Session::UserPrefs(v8::Isolate* isolate) {
   return v8::Local<v8::Value>::New(isolate, user_prefs_);
 }
 
+v8::Local<v8::Value> Session::AppState(v8::Isolate* isolate) {
+  if (app_state_.IsEmpty()) {
+    auto handle = atom::api::AppState::Create(isolate, profile_);
+    app_state_.Reset(isolate, handle.ToV8());
+  }
+  return v8::Local<v8::Value>::New(isolate, app_state_);
+}
+
 v8::Local<v8::Value> Session::ContentSettings(v8::Isolate* isolate) {
   if (content_settings_.IsEmpty()) {
     auto handle =
@@ -671,6 +719,51 @@ void Session::SetTorLauncherCallback(mate::Arguments* args) {
   brave_browser_context->SetTorLauncherCallback(callback);
 }
 
+void Session::SetTorBootstrapCallback(mate::Arguments* args) {
+  brave::TorLauncherFactory::TorBootstrapCallback callback;
+  if (!args->GetNext(&callback)) {
+    args->ThrowError("`callback(progress, summary)` is a required field");
+    return;
+  }
+  brave::BraveBrowserContext* brave_browser_context =
+   brave::BraveBrowserContext::FromBrowserContext(profile_);
+  if (!brave_browser_context->IsTorBrowserContext()) {
+    LOG(ERROR) << __func__ << " only available for tor browser context";
+    return;
+  }
+  brave_browser_context->SetTorBootstrapCallback(callback);
+}
+
+int Session::GetTorBootstrapProgress() const {
+  brave::BraveBrowserContext* brave_browser_context =
+   brave::BraveBrowserContext::FromBrowserContext(profile_);
+  if (!brave_browser_context->IsTorBrowserContext()) {
+    LOG(ERROR) << __func__ << " only available for tor browser context";
+    return 0;
+  }
+  return brave_browser_context->GetTorBootstrapProgress();
+}
+
+bool Session::IsTorReady() const {
+  brave::BraveBrowserContext* brave_browser_context =
+   brave::BraveBrowserContext::FromBrowserContext(profile_);
+  if (!brave_browser_context->IsTorBrowserContext()) {
+    LOG(ERROR) << __func__ << " only available for tor browser context";
+    return false;
+  }
+  return brave_browser_context->IsTorReady();
+}
+
+void Session::PrewarmTor(const GURL& url) const {
+  brave::BraveBrowserContext* brave_browser_context =
+   brave::BraveBrowserContext::FromBrowserContext(profile_);
+  if (!brave_browser_context->IsTorBrowserContext()) {
+    LOG(ERROR) << __func__ << " only available for tor browser context";
+    return;
+  }
+  brave_browser_context->PrewarmTor(url);
+}
+
 // static
 mate::Handle<Session> Session::CreateFrom(
     v8::Isolate* isolate, content::BrowserContext* browser_context) {
@@ -698,11 +791,6 @@ mate::Handle<Session> Session::FromPartition(
       brave::BraveBrowserContext::FromPartition(partition, options);
 
   DCHECK(browser_context);
-  // TODO(bridiver) - this is a huge hack to deal with sync call
-  base::ThreadRestrictions::ScopedAllowWait wait_allowed;
-  static_cast<brave::BraveBrowserContext*>(
-      browser_context)->ready()->Wait();
-
   return CreateFrom(isolate, browser_context);
 }
 
@@ -721,6 +809,8 @@ void Session::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("flushStorageData", &Session::FlushStorageData)
       .SetMethod("setProxy", &Session::SetProxy)
       .SetMethod("setDownloadPath", &Session::SetDownloadPath)
+      .SetMethod("setDownloadProgressInterval",
+                 &Session::SetDownloadProgressInterval)
       .SetMethod("setCertificateVerifyProc", &Session::SetCertVerifyProc)
       .SetMethod("setPermissionRequestHandler",
                  &Session::SetPermissionRequestHandler)
@@ -734,9 +824,14 @@ void Session::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("relaunchTor", &Session::RelaunchTor)
       .SetMethod("setTorLauncherCallback", &Session::SetTorLauncherCallback)
       .SetMethod("getTorPid", &Session::GetTorPid)
+      .SetMethod("setTorBootstrapCallback", &Session::SetTorBootstrapCallback)
+      .SetMethod("getTorBootstrapProgress", &Session::GetTorBootstrapProgress)
+      .SetMethod("isTorReady", &Session::IsTorReady)
+      .SetMethod("prewarmTor", &Session::PrewarmTor)
       .SetProperty("partition", &Session::Partition)
       .SetProperty("contentSettings", &Session::ContentSettings)
       .SetProperty("userPrefs", &Session::UserPrefs)
+      .SetProperty("appState", &Session::AppState)
       .SetProperty("cookies", &Session::Cookies)
       .SetProperty("protocol", &Session::Protocol)
       .SetProperty("webRequest", &Session::WebRequest)
@@ -761,7 +856,15 @@ v8::Local<v8::Value> FromPartition(
   }
   base::DictionaryValue options;
   args->GetNext(&options);
-  return Session::FromPartition(args->isolate(), partition, options).ToV8();
+  // The prefs of the default profile are loaded before "ready", but those of
+  // a context created from a partition that is still loading are not.
+  auto browser_context = brave::BraveBrowserContext::FromBrowserContext(
+      brave::BraveBrowserContext::FromPartition(partition, options));
+  if (!browser_context->IsReady()) {
+    args->ThrowError("Session is not ready yet");
+    return v8::Null(args->isolate());
+  }
+  return Session::CreateFrom(args->isolate(), browser_context).ToV8();
 }
 
 void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
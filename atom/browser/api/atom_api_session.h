@@ -5,9 +5,12 @@
 #ifndef ATOM_BROWSER_API_ATOM_API_SESSION_H_
 #define ATOM_BROWSER_API_ATOM_API_SESSION_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "atom/browser/api/trackable_object.h"
+#include "atom/browser/download_progress_tracker.h"
 #include "base/task/cancelable_task_tracker.h"
 #include "base/values.h"
 #include "content/public/browser/download_manager.h"
@@ -75,6 +78,7 @@ class Session: public mate::TrackableObject<Session>,
   void FlushStorageData();
   void SetProxy(const net::ProxyConfig& config, const base::Closure& callback);
   void SetDownloadPath(const base::FilePath& path);
+  void SetDownloadProgressInterval(mate::Arguments* args);
   void EnableNetworkEmulation(const mate::Dictionary& options);
   void DisableNetworkEmulation();
   void SetCertVerifyProc(v8::Local<v8::Value> proc, mate::Arguments* args);
@@ -89,6 +93,7 @@ class Session: public mate::TrackableObject<Session>,
   v8::Local<v8::Value> Protocol(v8::Isolate* isolate);
   v8::Local<v8::Value> WebRequest(v8::Isolate* isolate);
   v8::Local<v8::Value> UserPrefs(v8::Isolate* isolate);
+  v8::Local<v8::Value> AppState(v8::Isolate* isolate);
   v8::Local<v8::Value> Autofill(v8::Isolate* isolate);
   v8::Local<v8::Value> SpellChecker(v8::Isolate* isolate);
   v8::Local<v8::Value> Extensions(v8::Isolate* isolate);
@@ -99,6 +104,10 @@ class Session: public mate::TrackableObject<Session>,
   void RelaunchTor() const;
   void SetTorLauncherCallback(mate::Arguments* args);
   int64_t GetTorPid() const;
+  void SetTorBootstrapCallback(mate::Arguments* args);
+  int GetTorBootstrapProgress() const;
+  bool IsTorReady() const;
+  void PrewarmTor(const GURL& url) const;
 
  protected:
   Session(v8::Isolate* isolate, Profile* browser_context);
@@ -110,12 +119,15 @@ class Session: public mate::TrackableObject<Session>,
 
  private:
   void DefaultDownloadDirectoryChanged();
+  void OnDownloadProgress(
+      const std::vector<DownloadProgressTracker::Progress>& batch);
 
   // Cached object.
   v8::Global<v8::Value> cookies_;
   v8::Global<v8::Value> protocol_;
   v8::Global<v8::Value> web_request_;
   v8::Global<v8::Value> user_prefs_;
+  v8::Global<v8::Value> app_state_;
   v8::Global<v8::Value> content_settings_;
   v8::Global<v8::Value> autofill_;
   v8::Global<v8::Value> spell_checker_;
@@ -127,6 +139,9 @@ class Session: public mate::TrackableObject<Session>,
   // The task tracker for the HistoryService callbacks.
   base::CancelableTaskTracker task_tracker_;
 
+  // Batches the progress of the downloads, while enabled.
+  std::unique_ptr<DownloadProgressTracker> download_progress_tracker_;
+
   Profile* profile_;
   scoped_refptr<net::URLRequestContextGetter> request_context_getter_;
 
@@ -2,6 +2,8 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -28,6 +30,7 @@
 #include "atom/browser/web_contents_preferences.h"
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/event_emitter_caller.h"
+#include "atom/common/api/structured_clone.h"
 #include "atom/common/color_util.h"
 #include "atom/common/mouse_util.h"
 #include "atom/common/native_mate_converters/blink_converter.h"
@@ -43,12 +46,14 @@
 #include "atom/common/options_switches.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/task_scheduler/post_task.h"
 #include "brave/browser/brave_browser_context.h"
 #include "brave/browser/brave_content_browser_client.h"
 #include "brave/browser/guest_view/tab_view/tab_view_guest.h"
 #include "brave/browser/password_manager/brave_password_manager_client.h"
 #include "brave/browser/plugins/brave_plugin_service_filter.h"
 #include "brave/browser/renderer_preferences_helper.h"
+#include "brave/browser/shared_memory_pool.h"
 #include "brave/common/extensions/shared_memory_bindings.h"
 #include "brightray/browser/inspectable_web_contents.h"
 #include "brightray/browser/inspectable_web_contents_view.h"
@@ -108,6 +113,8 @@
 #include "third_party/blink/public/web/web_find_options.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/display/screen.h"
+#include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/codec/png_codec.h"
 
 #if BUILDFLAG(ENABLE_PRINTING)
 #include "chrome/browser/printing/printing_init.h"
@@ -458,6 +465,23 @@ void OnCapturePageDone(base::Callback<void(const gfx::Image&)> callback,
   callback.Run(gfx::Image::CreateFrom1xBitmap(bitmap));
 }
 
+// Runs on a worker, returns null if |bitmap| can't be encoded.
+std::unique_ptr<std::vector<unsigned char>> EncodeThumbnail(
+    const SkBitmap& bitmap, bool jpeg, int quality) {
+  std::unique_ptr<std::vector<unsigned char>> data(
+      new std::vector<unsigned char>);
+  bool success = jpeg ?
+      gfx::JPEGCodec::Encode(bitmap, quality, data.get()) :
+      gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, data.get());
+  if (!success || data->empty())
+    return nullptr;
+  return data;
+}
+
+void DeleteThumbnailData(char*, void* hint) {
+  delete static_cast<std::vector<unsigned char>*>(hint);
+}
+
 }  // namespace
 
 WebContents::WebContents(v8::Isolate* isolate,
@@ -1355,7 +1379,22 @@ void WebContents::RenderViewDeleted(content::RenderViewHost* render_view_host) {
   Emit("render-view-deleted", render_view_host->GetProcess()->GetID());
 }
 
+void WebContents::RenderViewHostChanged(content::RenderViewHost* old_host,
+                                        content::RenderViewHost* new_host) {
+  // Shared values are sent to the main frame, the old one won't acknowledge
+  // them anymore.
+  shared_memory_pool_.reset();
+}
+
+void WebContents::RenderFrameDeleted(
+    content::RenderFrameHost* render_frame_host) {
+  if (!render_frame_host->GetParent())
+    shared_memory_pool_.reset();
+}
+
 void WebContents::RenderProcessGone(base::TerminationStatus status) {
+  // Segments that were in flight will never be acknowledged.
+  shared_memory_pool_.reset();
   Emit("crashed");
 }
 
@@ -1560,6 +1599,9 @@ bool WebContents::OnMessageReceived(const IPC::Message& message,
     IPC_MESSAGE_FORWARD_DELAY_REPLY(AtomViewHostMsg_Message_Sync, &helper,
                                     FrameDispatchHelper::OnRendererMessageSync)
     IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Shared, OnRendererMessageShared)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Shared_Ack,
+                        OnRendererMessageSharedAck)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Cloned, OnRendererMessageCloned)
     IPC_MESSAGE_HANDLER_CODE(ViewHostMsg_SetCursor, OnCursorChange,
                              handled = false)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -2333,11 +2375,31 @@ bool WebContents::ExecuteScriptInTab(mate::Arguments* args) {
 }
 #endif
 
-bool WebContents::SendIPCSharedMemoryInternal(const base::string16& channel,
-                                      base::SharedMemory* shared_memory) {
+bool WebContents::SendIPCSharedMemoryInternal(mate::Arguments* args,
+                                              const base::string16& channel,
+                                              v8::Local<v8::Value> value) {
   auto rfh = web_contents()->GetMainFrame();
-  return SendIPCSharedMemory(
-      rfh->GetProcess()->GetID(), rfh->GetRoutingID(), channel, shared_memory);
+  base::SharedMemory* shared_memory = nullptr;
+  if (mate::ConvertFromV8(isolate(), value, &shared_memory)) {
+    return SendIPCSharedMemory(rfh->GetProcess()->GetID(),
+                               rfh->GetRoutingID(), channel, shared_memory);
+  }
+
+  if (!shared_memory_pool_)
+    shared_memory_pool_.reset(new brave::SharedMemoryPool);
+
+  uint32_t segment_id;
+  base::SharedMemoryHandle handle;
+  if (!shared_memory_pool_->Write(isolate(), channel, value, &segment_id,
+                                  &handle))
+    return false;  // the serializer may have thrown a DataCloneError
+
+  if (!rfh->Send(new AtomViewMsg_Message_Shared_Pooled(
+          rfh->GetRoutingID(), channel, handle, segment_id))) {
+    shared_memory_pool_->Release(channel, segment_id);
+    return false;
+  }
+  return true;
 }
 
 // static
@@ -2370,6 +2432,18 @@ bool WebContents::SendIPCMessageInternal(const base::string16& channel,
       rfh->GetProcess()->GetID(), rfh->GetRoutingID(), channel, args);
 }
 
+bool WebContents::SendIPCClonedInternal(mate::Arguments* args,
+                                        const base::string16& channel,
+                                        v8::Local<v8::Value> value) {
+  std::vector<uint8_t> data;
+  if (!SerializeV8Value(isolate(), value, &data))
+    return false;  // the serializer has thrown a DataCloneError
+
+  auto rfh = web_contents()->GetMainFrame();
+  return rfh->Send(
+      new AtomViewMsg_Message_Cloned(rfh->GetRoutingID(), channel, data));
+}
+
 // static
 bool WebContents::SendIPCMessage(int render_process_id,
                                  int render_frame_id,
@@ -2488,6 +2562,129 @@ void WebContents::CapturePage(mate::Arguments* args) {
       base::BindOnce(&OnCapturePageDone, callback));
 }
 
+void WebContents::CaptureThumbnail(mate::Arguments* args) {
+  mate::Dictionary options;
+  ThumbnailCallback callback;
+  if (!args->GetNext(&options) || !args->GetNext(&callback)) {
+    args->ThrowError("Expected options and a callback");
+    return;
+  }
+
+  int width = 0, height = 0;
+  if (!options.Get("width", &width) || !options.Get("height", &height) ||
+      width <= 0 || height <= 0) {
+    args->ThrowError("width and height must be positive integers");
+    return;
+  }
+
+  bool jpeg = true;
+  std::string format;
+  if (options.Get("format", &format)) {
+    if (format == "png") {
+      jpeg = false;
+    } else if (format != "jpeg") {
+      args->ThrowError("format must be \"jpeg\" or \"png\"");
+      return;
+    }
+  }
+  int quality = 80;
+  options.Get("quality", &quality);
+  quality = std::min(std::max(quality, 0), 100);
+
+  const auto view = web_contents()->GetRenderWidgetHostView();
+  if (!view || !view->GetRenderWidgetHost()) {
+    callback.Run(v8::Exception::Error(mate::StringToV8(
+                     isolate(), "There is nothing to capture")),
+                 v8::Undefined(isolate()));
+    return;
+  }
+
+  // A capture with the same output already in flight serves this one too.
+  ThumbnailKey key(width, height, jpeg, quality);
+  std::vector<ThumbnailCallback>& callbacks = pending_thumbnails_[key];
+  callbacks.push_back(callback);
+  if (callbacks.size() > 1)
+    return;
+
+  // Fit the view into the requested size, the compositor does the scaling
+  // while copying so the full size bitmap is never read back.
+  const gfx::Size view_size = view->GetViewBounds().size();
+  float scale =
+      display::Screen::GetScreen()->GetDisplayNearestView(
+          view->GetNativeView()).device_scale_factor();
+  if (!view_size.IsEmpty()) {
+    scale = std::min(scale, std::min(
+        static_cast<float>(width) / view_size.width(),
+        static_cast<float>(height) / view_size.height()));
+  }
+  gfx::Size output_size = gfx::ScaleToFlooredSize(view_size, scale);
+  output_size.SetToMax(gfx::Size(1, 1));
+
+  view->CopyFromSurface(gfx::Rect(view_size), output_size,
+      base::BindOnce(&WebContents::OnThumbnailCaptured,
+                     weak_ptr_factory_.GetWeakPtr(), key));
+}
+
+void WebContents::OnThumbnailCaptured(const ThumbnailKey& key,
+                                      const SkBitmap& bitmap) {
+  if (bitmap.drawsNothing()) {
+    OnThumbnailEncoded(key, nullptr);
+    return;
+  }
+
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE,
+      {base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      base::BindOnce(&EncodeThumbnail, bitmap, std::get<2>(key),
+                     std::get<3>(key)),
+      base::BindOnce(&WebContents::OnThumbnailEncoded,
+                     weak_ptr_factory_.GetWeakPtr(), key));
+}
+
+void WebContents::OnThumbnailEncoded(
+    const ThumbnailKey& key,
+    std::unique_ptr<std::vector<unsigned char>> data) {
+  auto it = pending_thumbnails_.find(key);
+  if (it == pending_thumbnails_.end())
+    return;
+  std::vector<ThumbnailCallback> callbacks = std::move(it->second);
+  pending_thumbnails_.erase(it);
+
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Object> wrapper = GetWrapper();
+  if (wrapper.IsEmpty())
+    return;
+  v8::Context::Scope context_scope(wrapper->CreationContext());
+
+  v8::Local<v8::Value> error = v8::Null(isolate());
+  std::vector<v8::Local<v8::Value>> buffers(callbacks.size(),
+                                            v8::Undefined(isolate()));
+  if (!data) {
+    error = v8::Exception::Error(
+        mate::StringToV8(isolate(), "Failed to capture the page"));
+  } else {
+    // Every caller of the coalesced capture gets a Buffer of its own, which
+    // are all made before any caller can write to one. The first takes over
+    // the encoder's output instead of copying it.
+    for (size_t i = 1; i < buffers.size(); ++i) {
+      buffers[i] = node::Buffer::Copy(isolate(),
+                                      reinterpret_cast<char*>(data->data()),
+                                      data->size()).ToLocalChecked();
+    }
+    std::vector<unsigned char>* owned = data.release();
+    buffers[0] = node::Buffer::New(isolate(),
+                                   reinterpret_cast<char*>(owned->data()),
+                                   owned->size(),
+                                   &DeleteThumbnailData,
+                                   owned).ToLocalChecked();
+  }
+
+  for (size_t i = 0; i < callbacks.size(); ++i)
+    callbacks[i].Run(error, buffers[i]);
+}
+
 void WebContents::GetPreferredSize(mate::Arguments* args) {
   base::Callback<void(gfx::Size)> callback;
   if (!args->GetNext(&callback)) {
@@ -2680,6 +2877,7 @@ void WebContents::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("_reload", &WebContents::Reload)
       .SetMethod("_send", &WebContents::SendIPCMessageInternal)
       .SetMethod("_sendShared", &WebContents::SendIPCSharedMemoryInternal)
+      .SetMethod("_sendCloned", &WebContents::SendIPCClonedInternal)
       .SetMethod("downloadURL", &WebContents::DownloadURL)
       .SetMethod("getURL", &WebContents::GetURL)
       .SetMethod("getTitle", &WebContents::GetTitle)
@@ -2753,6 +2951,7 @@ void WebContents::BuildPrototype(v8::Isolate* isolate,
                  &WebContents::ShowDefinitionForSelection)
       .SetMethod("copyImageAt", &WebContents::CopyImageAt)
       .SetMethod("capturePage", &WebContents::CapturePage)
+      .SetMethod("captureThumbnail", &WebContents::CaptureThumbnail)
       .SetMethod("getPreferredSize", &WebContents::GetPreferredSize)
       .SetProperty("id", &WebContents::ID)
       .SetProperty("attached", &WebContents::IsAttached)
@@ -2838,6 +3037,39 @@ void WebContents::OnRendererMessageShared(
   Emit("ipc-message", args);
 }
 
+void WebContents::OnRendererMessageSharedAck(
+    content::RenderFrameHost* sender,
+    const base::string16& channel,
+    uint32_t segment_id) {
+  // Ids are only unique within a pool, which is replaced along with the main
+  // frame.
+  if (shared_memory_pool_ && sender == web_contents()->GetMainFrame())
+    shared_memory_pool_->Release(channel, segment_id);
+}
+
+void WebContents::OnRendererMessageCloned(
+    content::RenderFrameHost* sender,
+    const base::string16& channel,
+    const std::vector<uint8_t>& data) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Object> wrapper = GetWrapper();
+  if (wrapper.IsEmpty())
+    return;
+
+  v8::Context::Scope context_scope(wrapper->CreationContext());
+  v8::Local<v8::Value> args;
+  {
+    // Renderers can send anything, drop what doesn't deserialize.
+    v8::TryCatch try_catch(isolate());
+    args = DeserializeV8Value(isolate(), data);
+  }
+  if (args.IsEmpty() || !args->IsArray())
+    return;
+
+  EmitWithSender(base::UTF16ToUTF8(channel), sender, nullptr, args);
+}
+
 // static
 mate::Handle<WebContents> WebContents::FromTabID(v8::Isolate* isolate,
     int tab_id) {
@@ -5,8 +5,10 @@
 #ifndef ATOM_BROWSER_API_ATOM_API_WEB_CONTENTS_H_
 #define ATOM_BROWSER_API_ATOM_API_WEB_CONTENTS_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "atom/browser/api/save_page_handler.h"
@@ -29,6 +31,7 @@
 #include "ui/gfx/image/image.h"
 
 class ProtocolHandler;
+class SkBitmap;
 class TabStripModel;
 
 namespace autofill {
@@ -41,6 +44,7 @@ class SharedMemoryHandle;
 }
 
 namespace brave {
+class SharedMemoryPool;
 class TabViewGuest;
 }
 
@@ -279,6 +283,10 @@ class WebContents : public mate::TrackableObject<WebContents>,
   // done.
   void CapturePage(mate::Arguments* args);
 
+  // Captures the visible page scaled down to fit the requested size and
+  // passes it to the callback encoded as JPEG or PNG.
+  void CaptureThumbnail(mate::Arguments* args);
+
   void EnablePreferredSizeMode(bool enable);
   void GetPreferredSize(mate::Arguments* args);
 
@@ -476,6 +484,9 @@ class WebContents : public mate::TrackableObject<WebContents>,
   void BeforeUnloadFired(const base::TimeTicks& proceed_time) override;
   void RenderViewReady() override;
   void RenderViewDeleted(content::RenderViewHost*) override;
+  void RenderViewHostChanged(content::RenderViewHost* old_host,
+                             content::RenderViewHost* new_host) override;
+  void RenderFrameDeleted(content::RenderFrameHost* render_frame_host) override;
   void RenderProcessGone(base::TerminationStatus status) override;
   void DocumentAvailableInMainFrame() override;
   void DocumentOnLoadCompletedInMainFrame() override;
@@ -535,16 +546,31 @@ class WebContents : public mate::TrackableObject<WebContents>,
   friend brave::TabViewGuest;
   friend struct FrameDispatchHelper;
 
-  bool SendIPCSharedMemoryInternal(const base::string16& channel,
-                                   base::SharedMemory* shared_memory);
+  // Sends a SharedMemoryWrapper as is, other values are written to the
+  // channel's pooled segments.
+  bool SendIPCSharedMemoryInternal(mate::Arguments* args,
+                                   const base::string16& channel,
+                                   v8::Local<v8::Value> value);
   bool SendIPCMessageInternal(const base::string16& channel,
                               const base::ListValue& args);
+  bool SendIPCClonedInternal(mate::Arguments* args,
+                             const base::string16& channel,
+                             v8::Local<v8::Value> value);
   AtomBrowserContext* GetBrowserContext() const;
 
   uint32_t GetNextRequestId() {
     return ++request_id_;
   }
 
+  // Width, height, whether to use JPEG and the quality of a thumbnail.
+  typedef std::tuple<int, int, bool, int> ThumbnailKey;
+  typedef base::Callback<void(v8::Local<v8::Value>, v8::Local<v8::Value>)>
+      ThumbnailCallback;
+
+  void OnThumbnailCaptured(const ThumbnailKey& key, const SkBitmap& bitmap);
+  void OnThumbnailEncoded(const ThumbnailKey& key,
+                          std::unique_ptr<std::vector<unsigned char>> data);
+
   // Called when we receive a CursorChange message from chromium.
   void OnCursorChange(const content::WebCursor& cursor);
 
@@ -563,6 +589,16 @@ class WebContents : public mate::TrackableObject<WebContents>,
                                const base::string16& channel,
                                const base::SharedMemoryHandle& shared_memory);
 
+  // Called when the renderer is done with a pooled segment.
+  void OnRendererMessageSharedAck(content::RenderFrameHost* sender,
+                                  const base::string16& channel,
+                                  uint32_t segment_id);
+
+  // Called when received a structured-clone message from renderer.
+  void OnRendererMessageCloned(content::RenderFrameHost* sender,
+                               const base::string16& channel,
+                               const std::vector<uint8_t>& data);
+
   v8::Global<v8::Value> session_;
   v8::Global<v8::Value> devtools_web_contents_;
   v8::Global<v8::Value> debugger_;
@@ -583,6 +619,12 @@ class WebContents : public mate::TrackableObject<WebContents>,
   // the context menu params for the current context menu;
   content::ContextMenuParams context_menu_params_;
 
+  // Segments for values sent with sendShared, created on first use.
+  std::unique_ptr<brave::SharedMemoryPool> shared_memory_pool_;
+
+  // Callbacks of the thumbnail captures in flight.
+  std::map<ThumbnailKey, std::vector<ThumbnailCallback>> pending_thumbnails_;
+
   base::WeakPtrFactory<WebContents> weak_ptr_factory_;
 
   std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
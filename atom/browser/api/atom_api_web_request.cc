@@ -4,6 +4,10 @@
 
 #include "atom/browser/api/atom_api_web_request.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "atom/browser/net/atom_network_delegate.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
@@ -16,6 +20,7 @@
 #include "extensions/buildflags/buildflags.h"
 #include "native_mate/dictionary.h"
 #include "native_mate/object_template_builder.h"
+#include "net/http/http_util.h"
 #include "net/url_request/url_request_context.h"
 #include "v8/include/v8.h"
 
@@ -27,6 +32,29 @@ using content::BrowserThread;
 
 namespace mate {
 
+namespace {
+
+// Rules end up in header lines, so names and values that could end the line
+// early, like ones holding a CR or LF, are rejected.
+bool AreValidHeaders(const std::map<std::string, std::string>& headers) {
+  for (const auto& header : headers) {
+    if (!net::HttpUtil::IsValidHeaderName(header.first) ||
+        !net::HttpUtil::IsValidHeaderValue(header.second))
+      return false;
+  }
+  return true;
+}
+
+bool AreValidHeaderNames(const std::vector<std::string>& names) {
+  for (const auto& name : names) {
+    if (!net::HttpUtil::IsValidHeaderName(name))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 template<>
 struct Converter<URLPattern> {
   static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
@@ -38,6 +66,62 @@ struct Converter<URLPattern> {
   }
 };
 
+template<>
+struct Converter<atom::WebRequestRule> {
+  static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
+                     atom::WebRequestRule* out) {
+    mate::Dictionary dict;
+    if (!ConvertFromV8(isolate, val, &dict))
+      return false;
+
+    std::string action;
+    if (!dict.Get("action", &action))
+      return false;
+    if (action == "block") {
+      out->action = atom::WebRequestRule::BLOCK;
+    } else if (action == "redirect") {
+      out->action = atom::WebRequestRule::REDIRECT;
+      if (!dict.Get("redirectURL", &out->redirect_url) ||
+          !out->redirect_url.is_valid())
+        return false;
+    } else if (action == "upgradeScheme") {
+      out->action = atom::WebRequestRule::UPGRADE_SCHEME;
+    } else if (action == "modifyHeaders") {
+      out->action = atom::WebRequestRule::MODIFY_HEADERS;
+    } else {
+      return false;
+    }
+
+    URLPatterns patterns;
+    if (dict.Get("urls", &patterns))
+      out->urls = atom::URLPatternMatcher(patterns);
+
+    std::vector<std::string> resource_types;
+    if (dict.Get("resourceTypes", &resource_types)) {
+      for (const auto& name : resource_types) {
+        uint32_t bit = atom::WebRequestRule::ResourceTypeBit(name);
+        if (!bit)
+          return false;
+        out->resource_types |= bit;
+      }
+    }
+
+    mate::Dictionary headers;
+    if (dict.Get("requestHeaders", &headers)) {
+      headers.Get("set", &out->set_request_headers);
+      headers.Get("remove", &out->remove_request_headers);
+    }
+    if (dict.Get("responseHeaders", &headers)) {
+      headers.Get("set", &out->set_response_headers);
+      headers.Get("remove", &out->remove_response_headers);
+    }
+    return AreValidHeaders(out->set_request_headers) &&
+           AreValidHeaderNames(out->remove_request_headers) &&
+           AreValidHeaders(out->set_response_headers) &&
+           AreValidHeaderNames(out->remove_response_headers);
+  }
+};
+
 template<>
 struct Converter<net::URLFetcher::RequestType> {
   static bool FromV8(v8::Isolate* isolate, v8::Handle<v8::Value> val,
@@ -65,6 +149,16 @@ namespace atom {
 
 namespace api {
 
+namespace {
+
+// Returns whether |key| is set to anything but undefined in |dict|.
+bool HasOption(const mate::Dictionary& dict, const base::StringPiece& key) {
+  v8::Local<v8::Value> value;
+  return dict.Get(key, &value) && !value->IsUndefined();
+}
+
+}  // namespace
+
 WebRequest::WebRequest(v8::Isolate* isolate,
                        Profile* profile)
     : profile_(profile) {
@@ -150,6 +244,16 @@ void WebRequest::Fetch(mate::Arguments* args) {
 
 template<AtomNetworkDelegate::SimpleEvent type>
 void WebRequest::SetSimpleListener(mate::Arguments* args) {
+  // { batchSize, batchInterval } turn on batched delivery.
+  mate::Dictionary dict;
+  v8::Local<v8::Value> filter = args->PeekNext();
+  if (!filter.IsEmpty() &&
+      mate::ConvertFromV8(args->isolate(), filter, &dict) &&
+      (HasOption(dict, "batchSize") || HasOption(dict, "batchInterval"))) {
+    SetBatchListener(type, args);
+    return;
+  }
+
   SetListener<AtomNetworkDelegate::SimpleListener>(
       &AtomNetworkDelegate::SetSimpleListenerInIO, type, args);
 }
@@ -195,6 +299,80 @@ void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
           method, type, patterns, listener));
 }
 
+// static
+void WebRequest::SetBatchListenerOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    AtomNetworkDelegate::SimpleEvent type,
+    const URLPatterns& patterns,
+    const AtomNetworkDelegate::BatchOptions& options,
+    const AtomNetworkDelegate::BatchListener& listener) {
+  auto delegate = static_cast<AtomNetworkDelegate*>(
+      getter->GetURLRequestContext()->network_delegate());
+  delegate->SetBatchListenerInIO(type, patterns, options, listener);
+}
+
+void WebRequest::SetBatchListener(AtomNetworkDelegate::SimpleEvent type,
+                                  mate::Arguments* args) {
+  // { urls, batchSize, batchInterval }.
+  URLPatterns patterns;
+  AtomNetworkDelegate::BatchOptions options;
+  mate::Dictionary dict;
+  args->GetNext(&dict);
+  dict.Get("urls", &patterns);
+  int batch_size = static_cast<int>(options.max_size);
+  double batch_interval = options.interval.InMillisecondsF();
+  if ((HasOption(dict, "batchSize") && !dict.Get("batchSize", &batch_size)) ||
+      (HasOption(dict, "batchInterval") &&
+       !dict.Get("batchInterval", &batch_interval)) ||
+      batch_size < 1 || batch_interval < 0) {
+    args->ThrowError("Invalid batchSize or batchInterval");
+    return;
+  }
+  options.max_size = static_cast<size_t>(batch_size);
+  options.interval = base::TimeDelta::FromMillisecondsD(batch_interval);
+
+  // Function or null.
+  v8::Local<v8::Value> value;
+  AtomNetworkDelegate::BatchListener listener;
+  if (!args->GetNext(&listener) &&
+      !(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or a Function");
+    return;
+  }
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&WebRequest::SetBatchListenerOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          profile_->GetRequestContext()),
+        type, patterns, options, listener));
+}
+
+// static
+void WebRequest::SetRulesOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    const std::vector<WebRequestRule>& rules) {
+  auto delegate = static_cast<AtomNetworkDelegate*>(
+      getter->GetURLRequestContext()->network_delegate());
+  delegate->SetRulesInIO(rules);
+}
+
+void WebRequest::SetRules(mate::Arguments* args) {
+  // Array of rules, or null to clear them.
+  std::vector<WebRequestRule> rules;
+  v8::Local<v8::Value> value;
+  if (!args->GetNext(&rules) &&
+      !(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or an Array of valid rules");
+    return;
+  }
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&WebRequest::SetRulesOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          profile_->GetRequestContext()),
+        rules));
+}
+
 void WebRequest::HandleBehaviorChanged() {
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   extension_web_request_api_helpers::ClearCacheOnNavigation();
@@ -239,6 +417,8 @@ void WebRequest::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("onErrorOccurred",
                  &WebRequest::SetSimpleListener<
                     AtomNetworkDelegate::kOnErrorOccurred>)
+      .SetMethod("setRules",
+                 &WebRequest::SetRules)
       .SetMethod("handleBehaviorChanged",
                  &WebRequest::HandleBehaviorChanged)
       .SetMethod("fetch",
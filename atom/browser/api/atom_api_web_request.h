@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "atom/browser/api/trackable_object.h"
 #include "atom/browser/net/atom_network_delegate.h"
@@ -66,6 +67,18 @@ class WebRequest : public mate::TrackableObject<WebRequest>,
       URLPatterns patterns, Listener listener);
   template<typename Listener, typename Method, typename Event>
   void SetListener(Method method, Event type, mate::Arguments* args);
+  static void SetBatchListenerOnIOThread(
+      const scoped_refptr<net::URLRequestContextGetter>& request_context,
+      AtomNetworkDelegate::SimpleEvent type,
+      const URLPatterns& patterns,
+      const AtomNetworkDelegate::BatchOptions& options,
+      const AtomNetworkDelegate::BatchListener& listener);
+  void SetBatchListener(AtomNetworkDelegate::SimpleEvent type,
+                        mate::Arguments* args);
+  static void SetRulesOnIOThread(
+      const scoped_refptr<net::URLRequestContextGetter>& request_context,
+      const std::vector<WebRequestRule>& rules);
+  void SetRules(mate::Arguments* args);
 
  private:
   Profile* profile_;
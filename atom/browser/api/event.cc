@@ -4,14 +4,98 @@
 
 #include "atom/browser/api/event.h"
 
+#include <memory>
+#include <vector>
+
 #include "atom/common/api/api_messages.h"
+#include "atom/common/api/structured_clone.h"
+#include "atom/common/native_mate_converters/v8_value_converter.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/web_contents.h"
+#include "base/values.h"
 #include "native_mate/object_template_builder.h"
 
 namespace mate {
 
+namespace {
+
+// Node allocates small Buffers out of a shared pool, and cloning a view
+// clones all of its ArrayBuffer. Returns a copy of |view| that owns just its
+// bytes.
+v8::Local<v8::Value> CopyArrayBufferView(v8::Isolate* isolate,
+                                         v8::Local<v8::ArrayBufferView> view) {
+  size_t length = view->ByteLength();
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, length);
+  view->CopyContents(buffer->GetContents().Data(), length);
+  if (view->IsInt8Array())
+    return v8::Int8Array::New(buffer, 0, length);
+  if (view->IsUint8ClampedArray())
+    return v8::Uint8ClampedArray::New(buffer, 0, length);
+  if (view->IsInt16Array())
+    return v8::Int16Array::New(buffer, 0, length / 2);
+  if (view->IsUint16Array())
+    return v8::Uint16Array::New(buffer, 0, length / 2);
+  if (view->IsInt32Array())
+    return v8::Int32Array::New(buffer, 0, length / 4);
+  if (view->IsUint32Array())
+    return v8::Uint32Array::New(buffer, 0, length / 4);
+  if (view->IsFloat32Array())
+    return v8::Float32Array::New(buffer, 0, length / 4);
+  if (view->IsFloat64Array())
+    return v8::Float64Array::New(buffer, 0, length / 8);
+  if (view->IsDataView())
+    return v8::DataView::New(buffer, 0, length);
+  return v8::Uint8Array::New(buffer, 0, length);
+}
+
+// Replies are sent the way JSON.stringify() describes them, so toJSON() is
+// honoured, unless |cloned| asks for the structured clone. Values that can't
+// be cloned, like objects holding functions, fall back to JSON, and values
+// JSON can't describe to the base::Value conversion. The renderer blocks
+// until it gets a reply, so null is sent when nothing else works.
+void SerializeReply(v8::Isolate* isolate,
+                    v8::Local<v8::Value> value,
+                    bool cloned,
+                    std::vector<uint8_t>* out) {
+  v8::TryCatch try_catch(isolate);
+  if (cloned) {
+    v8::Local<v8::Value> clone = value;
+    if (value->IsArrayBufferView()) {
+      v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+      if (view->ByteOffset() != 0 ||
+          view->ByteLength() != view->Buffer()->ByteLength())
+        clone = CopyArrayBufferView(isolate, view);
+    }
+    if (atom::SerializeV8Value(isolate, clone, out))
+      return;
+    try_catch.Reset();
+  }
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::String> json;
+  v8::Local<v8::Value> plain;
+  if (v8::JSON::Stringify(context, value).ToLocal(&json) &&
+      v8::JSON::Parse(context, json).ToLocal(&plain) &&
+      atom::SerializeV8Value(isolate, plain, out))
+    return;
+  try_catch.Reset();
+
+  std::unique_ptr<base::Value> converted(
+      atom::V8ValueConverter().FromV8Value(value, context));
+  if (converted &&
+      atom::SerializeV8Value(
+          isolate, atom::V8ValueConverter().ToV8Value(converted.get(), context),
+          out))
+    return;
+  try_catch.Reset();
+
+  out->clear();
+  atom::SerializeV8Value(isolate, v8::Null(isolate), out);
+}
+
+}  // namespace
+
 Event::Event(v8::Isolate* isolate)
     : sender_(nullptr),
       message_(nullptr) {
@@ -48,11 +132,24 @@ void Event::PreventDefault(v8::Isolate* isolate) {
                            v8::True(isolate));
 }
 
-bool Event::SendReply(const base::string16& json) {
+bool Event::SendReply(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  return Reply(isolate, value, false);
+}
+
+bool Event::SendReplyCloned(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  return Reply(isolate, value, true);
+}
+
+bool Event::Reply(v8::Isolate* isolate,
+                  v8::Local<v8::Value> value,
+                  bool cloned) {
   if (message_ == nullptr || sender_ == nullptr)
     return false;
 
-  AtomViewHostMsg_Message_Sync::WriteReplyParams(message_, json);
+  std::vector<uint8_t> reply;
+  SerializeReply(isolate, value, cloned, &reply);
+
+  AtomViewHostMsg_Message_Sync::WriteReplyParams(message_, reply);
   bool success = sender_->Send(message_);
   message_ = nullptr;
   sender_ = nullptr;
@@ -70,7 +167,8 @@ void Event::BuildPrototype(
   prototype->SetClassName(mate::StringToV8(isolate, "Event"));
   mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
       .SetMethod("preventDefault", &Event::PreventDefault)
-      .SetMethod("sendReply", &Event::SendReply);
+      .SetMethod("sendReply", &Event::SendReply)
+      .SetMethod("sendReplyCloned", &Event::SendReplyCloned);
 }
 
 }  // namespace mate
@@ -30,8 +30,11 @@ class Event : public Wrappable<Event>,
   // event.PreventDefault().
   void PreventDefault(v8::Isolate* isolate);
 
-  // event.sendReply(json), used for replying synchronous message.
-  bool SendReply(const base::string16& json);
+  // event.sendReply(value), used for replying synchronous message.
+  bool SendReply(v8::Isolate* isolate, v8::Local<v8::Value> value);
+
+  // event.sendReplyCloned(value), replies with the structured clone of value.
+  bool SendReplyCloned(v8::Isolate* isolate, v8::Local<v8::Value> value);
 
  protected:
   explicit Event(v8::Isolate* isolate);
@@ -42,6 +45,8 @@ class Event : public Wrappable<Event>,
   void WebContentsDestroyed() override;
 
  private:
+  bool Reply(v8::Isolate* isolate, v8::Local<v8::Value> value, bool cloned);
+
   // Replyer for the synchronous messages.
   content::RenderFrameHost* sender_;
   IPC::Message* message_;
@@ -10,12 +10,15 @@
 #include "atom/browser/browser_observer.h"
 #include "atom/browser/native_window.h"
 #include "atom/browser/window_list.h"
+#include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/message_loop/message_loop.h"
 #include "base/path_service.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/trace_event/trace_event_impl.h"
+#include "brave/browser/brave_browser_context.h"
 #include "chrome/browser/lifetime/browser_shutdown.h"
+#include "chrome/browser/profiles/profile_manager.h"
 
 namespace atom {
 
@@ -155,11 +158,30 @@ void Browser::WillFinishLaunching() {
 }
 
 void Browser::DidFinishLaunching(const base::DictionaryValue& launch_info) {
+  // The default profile reads its prefs in the background, "ready" waits for
+  // them so that the app never sees a half loaded session. This overlaps the
+  // read with the rest of startup, but the first window still waits for the
+  // whole of UserPrefs: the profile services need an initialized PrefService,
+  // and serving zoom, content settings and proxy prefs before that would take
+  // a separate startup store and a migration of existing profiles.
+  auto profile = brave::BraveBrowserContext::FromBrowserContext(
+      ProfileManager::GetActiveUserProfile());
+  if (!profile->IsReady()) {
+    profile->RunWhenReady(base::Bind(
+        &Browser::OnProfileReady, base::Unretained(this),
+        base::Passed(launch_info.CreateDeepCopy())));
+    return;
+  }
+
   is_ready_ = true;
   for (BrowserObserver& observer : observers_)
     observer.OnFinishLaunching(launch_info);
 }
 
+void Browser::OnProfileReady(std::unique_ptr<base::DictionaryValue> info) {
+  DidFinishLaunching(*info);
+}
+
 void Browser::OnAccessibilitySupportChanged() {
   for (BrowserObserver& observer : observers_)
     observer.OnAccessibilitySupportChanged();
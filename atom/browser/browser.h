@@ -229,6 +229,8 @@ class Browser : public WindowListObserver {
   void OnWindowCloseCancelled(NativeWindow* window) override;
   void OnWindowAllClosed() override;
 
+  void OnProfileReady(std::unique_ptr<base::DictionaryValue> info);
+
   // Observers of the browser.
   base::ObserverList<BrowserObserver> observers_;
 
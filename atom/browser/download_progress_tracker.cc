@@ -0,0 +1,164 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/download_progress_tracker.h"
+
+#include <memory>
+
+#include "content/public/browser/download_manager.h"
+
+namespace atom {
+
+namespace {
+
+// Marks the items reported by a tracker.
+const char kTrackedKey[] = "atom_download_progress_tracked";
+
+// How far back throughput is measured.
+const int kSpeedWindowSeconds = 5;
+
+}  // namespace
+
+DownloadProgressTracker::Progress::Progress()
+    : item(nullptr), received_bytes(0), total_bytes(0), speed(0) {
+}
+
+DownloadProgressTracker::Progress::Progress(const Progress& other) = default;
+
+DownloadProgressTracker::Progress::~Progress() {
+}
+
+DownloadProgressTracker::ItemState::ItemState() : changed(false) {
+}
+
+DownloadProgressTracker::ItemState::ItemState(const ItemState& other) =
+    default;
+
+DownloadProgressTracker::ItemState::~ItemState() {
+}
+
+DownloadProgressTracker::DownloadProgressTracker(
+    content::DownloadManager* manager,
+    base::TimeDelta interval,
+    const ProgressCallback& callback)
+    : interval_(interval),
+      callback_(callback) {
+  content::DownloadManager::DownloadVector downloads;
+  manager->GetAllDownloads(&downloads);
+  for (download::DownloadItem* item : downloads) {
+    if (!item->IsDone() && !item->IsSavePackageDownload())
+      Add(item);
+  }
+}
+
+DownloadProgressTracker::~DownloadProgressTracker() {
+  for (const auto& it : items_) {
+    it.first->RemoveObserver(this);
+    it.first->RemoveUserData(kTrackedKey);
+  }
+}
+
+void DownloadProgressTracker::SetInterval(base::TimeDelta interval) {
+  interval_ = interval;
+  if (timer_.IsRunning())
+    timer_.Start(FROM_HERE, interval_, this, &DownloadProgressTracker::Report);
+}
+
+void DownloadProgressTracker::Add(download::DownloadItem* item) {
+  DCHECK(!item->IsDone());
+  if (items_.count(item))
+    return;
+
+  item->AddObserver(this);
+  item->SetUserData(kTrackedKey,
+                    std::make_unique<base::SupportsUserData::Data>());
+  ItemState& state = items_[item];
+  state.samples.push_back({base::TimeTicks::Now(), item->GetReceivedBytes()});
+  OnDownloadUpdated(item);
+}
+
+// static
+bool DownloadProgressTracker::IsTracked(download::DownloadItem* item) {
+  return item->GetUserData(kTrackedKey) != nullptr;
+}
+
+void DownloadProgressTracker::OnDownloadUpdated(download::DownloadItem* item) {
+  items_[item].changed = true;
+  if (!timer_.IsRunning())
+    timer_.Start(FROM_HERE, interval_, this, &DownloadProgressTracker::Report);
+}
+
+void DownloadProgressTracker::OnDownloadDestroyed(
+    download::DownloadItem* item) {
+  Remove(item);
+}
+
+void DownloadProgressTracker::Remove(download::DownloadItem* item) {
+  item->RemoveObserver(this);
+  item->RemoveUserData(kTrackedKey);
+  items_.erase(item);
+}
+
+void DownloadProgressTracker::Report() {
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeTicks window_start =
+      now - base::TimeDelta::FromSeconds(kSpeedWindowSeconds);
+  std::vector<Progress> batch;
+  std::vector<download::DownloadItem*> done;
+  for (auto& it : items_) {
+    download::DownloadItem* item = it.first;
+    ItemState& state = it.second;
+    // Items notify their completion themselves.
+    if (item->IsDone()) {
+      done.push_back(item);
+      continue;
+    }
+    // Stalled downloads are reported too, so their speed drops.
+    bool active = item->GetState() == download::DownloadItem::IN_PROGRESS &&
+                  !item->IsPaused();
+    if (!active && !state.changed)
+      continue;
+    state.changed = false;
+
+    int64_t bytes = item->GetReceivedBytes();
+    // Paused downloads restart the window, and resumed ones may start over.
+    if (!active ||
+        (!state.samples.empty() && bytes < state.samples.back().bytes))
+      state.samples.clear();
+    if (active)
+      state.samples.push_back({now, bytes});
+    // Keep the last sample taken before the window, which starts it.
+    while (state.samples.size() > 2 && state.samples[1].time <= window_start)
+      state.samples.pop_front();
+
+    Progress progress;
+    progress.item = item;
+    progress.received_bytes = bytes;
+    progress.total_bytes = item->GetTotalBytes();
+    if (!state.samples.empty()) {
+      const Sample& first = state.samples.front();
+      double elapsed = (now - first.time).InSecondsF();
+      if (elapsed > 0)
+        progress.speed =
+            static_cast<int64_t>((bytes - first.bytes) / elapsed);
+    }
+    if (progress.speed > 0 && progress.total_bytes >= bytes) {
+      progress.time_remaining = base::TimeDelta::FromSecondsD(
+          static_cast<double>(progress.total_bytes - bytes) / progress.speed);
+    }
+    batch.push_back(progress);
+  }
+  for (download::DownloadItem* item : done)
+    Remove(item);
+
+  if (batch.empty()) {
+    timer_.Stop();
+    return;
+  }
+  // The callback may delete this tracker.
+  ProgressCallback callback = callback_;
+  callback.Run(batch);
+}
+
+}  // namespace atom
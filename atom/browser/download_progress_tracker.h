@@ -0,0 +1,95 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_DOWNLOAD_PROGRESS_TRACKER_H_
+#define ATOM_BROWSER_DOWNLOAD_PROGRESS_TRACKER_H_
+
+#include <map>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/optional.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "components/download/public/common/download_item.h"
+
+namespace content {
+class DownloadManager;
+}
+
+namespace atom {
+
+// Reports the progress of the downloads of a browser context in batches.
+//
+// Instead of a notification for every update of every download, the
+// downloads that are in progress or have changed are reported together once
+// per interval, with their throughput and remaining time computed over a
+// moving window. Nothing is reported while all downloads are idle.
+class DownloadProgressTracker : public download::DownloadItem::Observer {
+ public:
+  struct Progress {
+    Progress();
+    Progress(const Progress& other);
+    ~Progress();
+
+    download::DownloadItem* item;
+    int64_t received_bytes;
+    int64_t total_bytes;
+    // Bytes per second over the last few seconds.
+    int64_t speed;
+    // Unset when the total size or the speed is unknown.
+    base::Optional<base::TimeDelta> time_remaining;
+  };
+  using ProgressCallback = base::Callback<void(const std::vector<Progress>&)>;
+
+  // Tracks the downloads of |manager| that are not done yet.
+  DownloadProgressTracker(content::DownloadManager* manager,
+                          base::TimeDelta interval,
+                          const ProgressCallback& callback);
+  ~DownloadProgressTracker() override;
+
+  void SetInterval(base::TimeDelta interval);
+
+  // Starts tracking |item|, which must not be done.
+  void Add(download::DownloadItem* item);
+
+  // Whether |item| is reported by a tracker, in which case it doesn't need to
+  // notify its own updates.
+  static bool IsTracked(download::DownloadItem* item);
+
+ private:
+  struct Sample {
+    base::TimeTicks time;
+    int64_t bytes;
+  };
+
+  struct ItemState {
+    ItemState();
+    ItemState(const ItemState& other);
+    ~ItemState();
+
+    base::circular_deque<Sample> samples;
+    bool changed;
+  };
+
+  // download::DownloadItem::Observer:
+  void OnDownloadUpdated(download::DownloadItem* item) override;
+  void OnDownloadDestroyed(download::DownloadItem* item) override;
+
+  void Remove(download::DownloadItem* item);
+  void Report();
+
+  std::map<download::DownloadItem*, ItemState> items_;
+  base::TimeDelta interval_;
+  ProgressCallback callback_;
+  base::RepeatingTimer timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(DownloadProgressTracker);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_DOWNLOAD_PROGRESS_TRACKER_H_
@@ -19,7 +19,6 @@
 #include "components/prefs/pref_change_registrar.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
-#include "components/user_prefs/user_prefs.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/browser_url_handler.h"
 #include "content/public/browser/child_process_security_policy.h"
@@ -417,14 +416,17 @@ void AtomBrowserClientExtensionsPart::RenderProcessWillLaunch(
        id, context, host->GetStoragePartition()->GetServiceWorkerContext()));
   }
 
+  // The publisher is owned by the context, which destroys the registrar
+  // first.
+  auto publisher = ContentSettingsPublisher::FromBrowserContext(context);
   auto user_prefs_registrar = context->user_prefs_change_registrar();
   if (!user_prefs_registrar->IsObserved("content_settings")) {
     user_prefs_registrar->Add(
         "content_settings",
-        base::Bind(&AtomBrowserClientExtensionsPart::UpdateContentSettings,
-                   base::Unretained(this)));
+        base::Bind(&ContentSettingsPublisher::Update,
+                   base::Unretained(publisher)));
   }
-  UpdateContentSettingsForHost(host->GetID());
+  publisher->AddRenderProcess(host);
 }
 
 // static
@@ -479,29 +481,6 @@ GURL AtomBrowserClientExtensionsPart::GetEffectiveURL(
   return extension->GetResourceURL(url.path());
 }
 
-void AtomBrowserClientExtensionsPart::UpdateContentSettingsForHost(
-  int render_process_id) {
-  auto host = content::RenderProcessHost::FromID(render_process_id);
-  if (!host)
-    return;
-
-  auto context =
-      static_cast<atom::AtomBrowserContext*>(host->GetBrowserContext());
-  auto user_prefs = user_prefs::UserPrefs::Get(context);
-  const base::DictionaryValue* content_settings =
-    user_prefs->GetDictionary("content_settings");
-  host->Send(new AtomMsg_UpdateContentSettings(*content_settings));
-}
-
-void AtomBrowserClientExtensionsPart::UpdateContentSettings() {
-  for (std::map<int, void*>::iterator
-      it = render_process_hosts_.begin();
-      it != render_process_hosts_.end();
-      ++it) {
-    UpdateContentSettingsForHost(it->first);
-  }
-}
-
 void AtomBrowserClientExtensionsPart::SiteInstanceGotProcess(
     SiteInstance* site_instance) {
   BrowserContext* context = site_instance->GetProcess()->GetBrowserContext();
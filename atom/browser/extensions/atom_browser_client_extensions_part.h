@@ -94,10 +94,6 @@ class AtomBrowserClientExtensionsPart {
   std::string GetApplicationLocale();
 
  private:
-  void UpdateContentSettings();
-  void UpdateContentSettingsForHost(int render_process_id);
-
-
   DISALLOW_COPY_AND_ASSIGN(AtomBrowserClientExtensionsPart);
 };
 
@@ -0,0 +1,159 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/extensions/content_settings_publisher.h"
+
+#include <string.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atom/common/api/api_messages.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/shared_memory.h"
+#include "base/pickle.h"
+#include "base/values.h"
+#include "components/prefs/pref_service.h"
+#include "components/user_prefs/user_prefs.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/render_process_host.h"
+#include "ipc/ipc_message_utils.h"
+
+namespace extensions {
+
+namespace {
+
+const char kContentSettingsPublisherKey[] = "ContentSettingsPublisher";
+
+const char kContentSettingsPref[] = "content_settings";
+
+size_t RuleCount(const base::Value& value) {
+  return value.is_list() ? value.GetList().size() : 1;
+}
+
+}  // namespace
+
+ContentSettingsPublisher::ContentSettingsPublisher(
+    content::BrowserContext* context)
+    : context_(context), version_(0), snapshot_size_(0) {
+}
+
+ContentSettingsPublisher::~ContentSettingsPublisher() {
+}
+
+// static
+ContentSettingsPublisher* ContentSettingsPublisher::FromBrowserContext(
+    content::BrowserContext* context) {
+  auto publisher = static_cast<ContentSettingsPublisher*>(
+      context->GetUserData(kContentSettingsPublisherKey));
+  if (!publisher) {
+    publisher = new ContentSettingsPublisher(context);
+    context->SetUserData(kContentSettingsPublisherKey,
+                         base::WrapUnique(publisher));
+  }
+  return publisher;
+}
+
+void ContentSettingsPublisher::AddRenderProcess(
+    content::RenderProcessHost* host) {
+  if (!settings_)
+    Update();
+
+  render_process_ids_.insert(host->GetID());
+  SendSnapshot(host);
+}
+
+void ContentSettingsPublisher::Update() {
+  const base::DictionaryValue* current =
+      user_prefs::UserPrefs::Get(context_)->GetDictionary(
+          kContentSettingsPref);
+  if (settings_ && current->Equals(settings_.get()))
+    return;
+
+  // Collect the content types that changed since the last version.
+  base::DictionaryValue changed;
+  std::vector<std::string> removed;
+  size_t changed_rules = 0;
+  size_t total_rules = 0;
+  if (settings_) {
+    for (base::DictionaryValue::Iterator it(*current); !it.IsAtEnd();
+         it.Advance()) {
+      total_rules += RuleCount(it.value());
+      const base::Value* previous = settings_->FindKey(it.key());
+      if (!previous || *previous != it.value()) {
+        changed.SetKey(it.key(), it.value().Clone());
+        changed_rules += RuleCount(it.value());
+      }
+    }
+    for (base::DictionaryValue::Iterator it(*settings_); !it.IsAtEnd();
+         it.Advance()) {
+      if (!current->FindKey(it.key()))
+        removed.push_back(it.key());
+    }
+  }
+  bool send_delta = settings_ && changed_rules * 2 <= total_rules;
+
+  settings_ = current->CreateDeepCopy();
+  version_++;
+  snapshot_.reset();
+
+  // The delta is the same for everyone, so it is only serialized once.
+  std::unique_ptr<IPC::Message> delta;
+  if (send_delta) {
+    delta.reset(
+        new AtomMsg_UpdateContentSettingsDelta(version_, changed, removed));
+  }
+
+  for (auto it = render_process_ids_.begin();
+       it != render_process_ids_.end();) {
+    content::RenderProcessHost* host =
+        content::RenderProcessHost::FromID(*it);
+    if (!host) {
+      it = render_process_ids_.erase(it);
+      continue;
+    }
+
+    if (delta)
+      host->Send(new IPC::Message(*delta));
+    else
+      SendSnapshot(host);
+    ++it;
+  }
+}
+
+void ContentSettingsPublisher::SendSnapshot(
+    content::RenderProcessHost* host) {
+  if (!snapshot_ && !CreateSnapshot())
+    return;
+
+  base::SharedMemoryHandle handle = snapshot_->GetReadOnlyHandle();
+  if (!handle.IsValid())
+    return;
+
+  host->Send(
+      new AtomMsg_UpdateContentSettings(handle, snapshot_size_, version_));
+}
+
+bool ContentSettingsPublisher::CreateSnapshot() {
+  base::Pickle pickle;
+  IPC::WriteParam(&pickle, *settings_);
+
+  base::SharedMemoryCreateOptions options;
+  options.size = pickle.size();
+  options.share_read_only = true;
+  std::unique_ptr<base::SharedMemory> snapshot(new base::SharedMemory);
+  if (!snapshot->Create(options) || !snapshot->Map(pickle.size()))
+    return false;
+
+  memcpy(snapshot->memory(), pickle.data(), pickle.size());
+  // Renderers only need the read-only handles.
+  snapshot->Unmap();
+
+  snapshot_ = std::move(snapshot);
+  snapshot_size_ = static_cast<uint32_t>(pickle.size());
+  return true;
+}
+
+}  // namespace extensions
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_EXTENSIONS_CONTENT_SETTINGS_PUBLISHER_H_
+#define ATOM_BROWSER_EXTENSIONS_CONTENT_SETTINGS_PUBLISHER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <set>
+
+#include "base/macros.h"
+#include "base/supports_user_data.h"
+
+namespace base {
+class DictionaryValue;
+class SharedMemory;
+}
+
+namespace content {
+class BrowserContext;
+class RenderProcessHost;
+}
+
+namespace extensions {
+
+// Distributes the "content_settings" pref of a browser context to its render
+// processes.
+//
+// The settings are serialized once into a read-only shared memory snapshot
+// that every render process maps. Each update bumps a version. When only a
+// few content types change, the renderers get just those types on top of
+// the previous version instead of a new snapshot.
+class ContentSettingsPublisher : public base::SupportsUserData::Data {
+ public:
+  ~ContentSettingsPublisher() override;
+
+  static ContentSettingsPublisher* FromBrowserContext(
+      content::BrowserContext* context);
+
+  // Sends the current settings to |host|, which then gets every update.
+  void AddRenderProcess(content::RenderProcessHost* host);
+
+  // Publishes the current value of the pref, called when it changes.
+  void Update();
+
+ private:
+  explicit ContentSettingsPublisher(content::BrowserContext* context);
+
+  void SendSnapshot(content::RenderProcessHost* host);
+  bool CreateSnapshot();
+
+  content::BrowserContext* context_;  // owns us
+
+  // The settings as of |version_|.
+  std::unique_ptr<base::DictionaryValue> settings_;
+  uint32_t version_;
+
+  // Serialized |settings_|, created when a render process needs it.
+  std::unique_ptr<base::SharedMemory> snapshot_;
+  uint32_t snapshot_size_;
+
+  std::set<int> render_process_ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsPublisher);
+};
+
+}  // namespace extensions
+
+#endif  // ATOM_BROWSER_EXTENSIONS_CONTENT_SETTINGS_PUBLISHER_H_
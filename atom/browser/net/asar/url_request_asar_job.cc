@@ -4,6 +4,8 @@
 
 #include "atom/browser/net/asar/url_request_asar_job.h"
 
+#include <string.h>
+
 #include <string>
 #include <utility>
 #include <vector>
@@ -16,6 +18,7 @@
 #include "base/strings/string_util.h"
 #include "base/synchronization/lock.h"
 #include "base/task_runner.h"
+#include "base/task_runner_util.h"
 #include "net/base/file_stream.h"
 #include "net/base/filename_util.h"
 #include "net/base/io_buffer.h"
@@ -40,6 +43,7 @@ void Initialize(
     std::shared_ptr<Archive>& archive,  // NOLINT
     base::FilePath* file_path,
     Archive::FileInfo* file_info,
+    base::span<const uint8_t>* file_data,
     URLRequestAsarJob::JobType* type) {
   // Determine whether it is an asar file.
   base::FilePath asar_path, relative_path;
@@ -62,10 +66,25 @@ void Initialize(
     return;
   }
 
+  if (!archive->GetFileData(*file_info, file_data)) {
+    *type = URLRequestAsarJob::TYPE_ERROR;
+    return;
+  }
+
   *file_path = relative_path;
   *type = URLRequestAsarJob::TYPE_ASAR;
 }
 
+// Copies a chunk of a packed file out of the archive mapping. Touching the
+// mapping may block on disk, so this runs on the file task runner, and
+// |archive| keeps the mapping alive even if the job is killed meanwhile.
+int CopyFromMapping(std::shared_ptr<Archive> archive,
+                    base::span<const uint8_t> data,
+                    scoped_refptr<net::IOBuffer> buf) {
+  memcpy(buf->data(), data.data(), data.size());
+  return static_cast<int>(data.size());
+}
+
 }  // namespace
 
 URLRequestAsarJob::FileMetaInfo::FileMetaInfo()
@@ -91,10 +110,6 @@ URLRequestAsarJob::URLRequestAsarJob(
 
 URLRequestAsarJob::~URLRequestAsarJob() {}
 
-void URLRequestAsarJob::InitializeAsarJob() {
-  stream_.reset(new net::FileStream(file_task_runner_));
-}
-
 void URLRequestAsarJob::InitializeFileJob() {
   stream_.reset(new net::FileStream(file_task_runner_));
 }
@@ -103,22 +118,17 @@ void URLRequestAsarJob::Start() {
   file_task_runner_->PostTaskAndReply(
       FROM_HERE,
       base::Bind(&Initialize,
-          full_path_, std::ref(archive_), &file_path_, &file_info_, &type_),
+          full_path_, std::ref(archive_), &file_path_, &file_info_,
+          &file_data_, &type_),
       base::Bind(&URLRequestAsarJob::DidInitialize,
           weak_ptr_factory_.GetWeakPtr()));
 }
 
 void URLRequestAsarJob::DidInitialize() {
   if (type_ == TYPE_ASAR) {
-    InitializeAsarJob();
-    int flags = base::File::FLAG_OPEN |
-                base::File::FLAG_READ |
-                base::File::FLAG_ASYNC;
-    int rv = stream_->Open(archive_->path(), flags,
-                           base::Bind(&URLRequestAsarJob::DidOpen,
-                                      weak_ptr_factory_.GetWeakPtr()));
-    if (rv != net::ERR_IO_PENDING)
-      DidOpen(rv);
+    // Packed files are served from the archive mapping, there is nothing to
+    // open.
+    DidOpen(net::OK);
   } else if (type_ == TYPE_FILE) {
     InitializeFileJob();
     auto* meta_info = new FileMetaInfo();
@@ -151,6 +161,20 @@ int URLRequestAsarJob::ReadRawData(net::IOBuffer* dest, int dest_size) {
   if (!dest_size)
     return 0;
 
+  if (type_ == TYPE_ASAR) {
+    base::span<const uint8_t> chunk =
+        file_data_.subspan(static_cast<size_t>(seek_offset_), dest_size);
+    seek_offset_ += dest_size;
+    base::PostTaskAndReplyWithResult(
+        file_task_runner_.get(), FROM_HERE,
+        base::Bind(&CopyFromMapping, archive_, chunk,
+                   base::WrapRefCounted(dest)),
+        base::Bind(&URLRequestAsarJob::DidRead,
+                   weak_ptr_factory_.GetWeakPtr(),
+                   base::WrapRefCounted(dest)));
+    return net::ERR_IO_PENDING;
+  }
+
   int rv = stream_->Read(dest,
                          dest_size,
                          base::Bind(&URLRequestAsarJob::DidRead,
@@ -287,14 +311,11 @@ void URLRequestAsarJob::DidOpen(int result) {
     return;
   }
 
-  int64_t file_size, read_offset;
-  if (type_ == TYPE_ASAR) {
-    file_size = file_info_.size;
-    read_offset = file_info_.offset;
-  } else {
+  int64_t file_size;
+  if (type_ == TYPE_ASAR)
+    file_size = file_data_.size();
+  else
     file_size = meta_info_.file_size;
-    read_offset = 0;
-  }
 
   if (!byte_range_.ComputeBounds(file_size)) {
     NotifyStartError(
@@ -305,9 +326,10 @@ void URLRequestAsarJob::DidOpen(int result) {
 
   remaining_bytes_ = byte_range_.last_byte_position() -
                      byte_range_.first_byte_position() + 1;
-  seek_offset_ = byte_range_.first_byte_position() + read_offset;
+  seek_offset_ = byte_range_.first_byte_position();
 
-  if (remaining_bytes_ > 0 && seek_offset_ != 0) {
+  // For packed files |seek_offset_| is the read position in |file_data_|.
+  if (type_ == TYPE_FILE && remaining_bytes_ > 0 && seek_offset_ != 0) {
     int rv = stream_->Seek(seek_offset_,
                            base::Bind(&URLRequestAsarJob::DidSeek,
                                       weak_ptr_factory_.GetWeakPtr()));
@@ -10,6 +10,7 @@
 
 #include "atom/browser/net/js_asker.h"
 #include "atom/common/asar/archive.h"
+#include "base/containers/span.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
@@ -50,7 +51,6 @@ class URLRequestAsarJob : public net::URLRequestJob {
   virtual ~URLRequestAsarJob();
 
   void DidInitialize();
-  void InitializeAsarJob();
   void InitializeFileJob();
 
   // net::URLRequestJob:
@@ -108,6 +108,9 @@ class URLRequestAsarJob : public net::URLRequestJob {
   std::shared_ptr<Archive> archive_;
   base::FilePath file_path_;
   Archive::FileInfo file_info_;
+  // Contents of a packed file, owned by |archive_|'s mapping. Only read on
+  // |file_task_runner_|.
+  base::span<const uint8_t> file_data_;
 
   std::unique_ptr<net::FileStream> stream_;
   FileMetaInfo meta_info_;
@@ -7,22 +7,12 @@
 #include <memory>
 #include <utility>
 
-#include "atom/browser/extensions/tab_helper.h"
-#include "atom/common/native_mate_converters/net_converter.h"
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
-#include "chrome/browser/extensions/api/tabs/tabs_constants.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/render_frame_host.h"
-#include "content/public/browser/websocket_handshake_request_info.h"
-#include "extensions/buildflags/buildflags.h"
 #include "net/url_request/url_request.h"
 #include "services/network/throttling/throttling_network_transaction.h"
 
-#if BUILDFLAG(ENABLE_EXTENSIONS)
-#include "extensions/browser/extension_api_frame_id_map.h"
-#endif
-
 using content::BrowserThread;
 
 namespace atom {
@@ -61,162 +51,59 @@ struct ResponseHeadersContainer {
         : headers(headers), status_line(status_line), new_url(new_url) {}
 };
 
-int GetTabId(int frame_tree_node_id,
-             int render_frame_id,
-             int render_process_id) {
-  auto web_contents =
-      content::WebContents::FromFrameTreeNodeId(frame_tree_node_id);
-
-  if (!web_contents) {
-    content::RenderFrameHost* rfh =
-        content::RenderFrameHost::FromID(render_process_id, render_frame_id);
-    if (rfh)
-      web_contents = content::WebContents::FromRenderFrameHost(rfh);
-  }
-
-  return extensions::TabHelper::IdForTab(web_contents);
-}
-
-void RunSimpleListener(const AtomNetworkDelegate::SimpleListener& listener,
-                       std::unique_ptr<base::DictionaryValue> details,
-                       int frame_tree_node_id,
-                       int render_frame_id,
-                       int render_process_id) {
-  details->SetInteger(extensions::tabs_constants::kTabIdKey,
-      GetTabId(frame_tree_node_id, render_frame_id, render_process_id));
-  return listener.Run(*(details.get()));
-}
-
-void RunResponseListener(
-    const AtomNetworkDelegate::ResponseListener& listener,
-    std::unique_ptr<base::DictionaryValue> details,
-    int frame_tree_node_id, int render_frame_id, int render_process_id,
-    const AtomNetworkDelegate::ResponseCallback& callback) {
-  details->SetInteger(extensions::tabs_constants::kTabIdKey,
-      GetTabId(frame_tree_node_id, render_frame_id, render_process_id));
-  return listener.Run(*(details.get()), callback);
-}
-
 // Test whether the URL of |request| matches |patterns|.
 bool MatchesFilterCondition(net::URLRequest* request,
-                            const URLPatterns& patterns) {
-  if (patterns.empty())
-    return true;
-
-  for (const auto& pattern : patterns) {
-    if (pattern.MatchesURL(request->url()))
-      return true;
-  }
-  return false;
-}
-
-void GetRenderFrameIdAndProcessId(net::URLRequest* request,
-    int* render_frame_id,
-    int* render_process_id) {
-#if BUILDFLAG(ENABLE_EXTENSIONS)
-  *render_frame_id = -1;
-  *render_process_id = -1;
-
-  extensions::ExtensionApiFrameIdMap::FrameData frame_data;
-  if (!content::ResourceRequestInfo::GetRenderFrameForRequest(
-          request, render_process_id, render_frame_id)) {
-    const content::WebSocketHandshakeRequestInfo* websocket_info =
-      content::WebSocketHandshakeRequestInfo::ForRequest(request);
-    if (websocket_info) {
-      *render_frame_id = websocket_info->GetRenderFrameId();
-      *render_process_id = websocket_info->GetChildId();
-    }
-  }
-#endif
-}
-
-void GetFrameTreeNodeId(net::URLRequest* request, int* frame_tree_node_id) {
-  auto request_info = content::ResourceRequestInfo::ForRequest(request);
-  if (request_info)
-    *frame_tree_node_id = request_info->GetFrameTreeNodeId();
-}
-
-// Overloaded by multiple types to fill the |details| object.
-void ToDictionary(base::DictionaryValue* details, net::URLRequest* request) {
-  FillRequestDetails(details, request);
-  details->SetInteger("id", request->identifier());
-  details->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
-  details->SetString("firstPartyUrl", request->site_for_cookies().spec());
-  auto info = content::ResourceRequestInfo::ForRequest(request);
-  details->SetString("resourceType",
-                     info ? ResourceTypeToString(info->GetResourceType())
-                          : "other");
-  net::IPEndPoint request_ip_endpoint;
-  bool was_successful = request->GetRemoteEndpoint(&request_ip_endpoint);
-  if (was_successful) {
-    details->SetString("ip", request_ip_endpoint.ToStringWithoutPort());
-    details->SetInteger("port", request_ip_endpoint.port());
-  }
+                            const URLPatternMatcher& patterns) {
+  return patterns.MatchesURL(request->url());
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HttpRequestHeaders& headers) {
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  net::HttpRequestHeaders::Iterator it(headers);
-  while (it.GetNext())
-    dict->SetKey(it.name(), base::Value(it.value()));
-  details->Set("requestHeaders", std::move(dict));
+// Overloaded by multiple types to fill the |details| snapshot.
+void ToDetails(WebRequestDetails* details,
+               const net::HttpRequestHeaders& headers) {
+  details->request_headers.reset(new net::HttpRequestHeaders(headers));
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HttpResponseHeaders* headers) {
+void ToDetails(WebRequestDetails* details,
+               const net::HttpResponseHeaders* headers) {
   if (!headers)
     return;
 
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  size_t iter = 0;
-  std::string key;
-  std::string value;
-  while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
-    if (dict->HasKey(key)) {
-      base::ListValue* values = nullptr;
-      if (dict->GetList(key, &values))
-        values->AppendString(value);
-    } else {
-      std::unique_ptr<base::ListValue> values(new base::ListValue);
-      values->AppendString(value);
-      dict->Set(key, std::move(values));
-    }
-  }
-  details->Set("responseHeaders", std::move(dict));
-  details->SetString("statusLine", headers->GetStatusLine());
-  details->SetInteger("statusCode", headers->response_code());
+  details->has_response_headers = true;
+  details->raw_response_headers = headers->raw_headers();
 }
 
-void ToDictionary(base::DictionaryValue* details, const GURL& location) {
-  details->SetString("redirectURL", location.spec());
+void ToDetails(WebRequestDetails* details, const GURL& location) {
+  details->has_redirect_url = true;
+  details->redirect_url = location;
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::HostPortPair& host_port) {
-  if (host_port.host().empty())
-    details->SetString("ip", host_port.host());
+void ToDetails(WebRequestDetails* details,
+               const net::HostPortPair& host_port) {
+  if (host_port.host().empty()) {
+    details->has_ip = true;
+    details->ip = host_port.host();
+  }
 }
 
-void ToDictionary(base::DictionaryValue* details, bool from_cache) {
-  details->SetBoolean("fromCache", from_cache);
+void ToDetails(WebRequestDetails* details, bool from_cache) {
+  details->has_from_cache = true;
+  details->from_cache = from_cache;
 }
 
-void ToDictionary(base::DictionaryValue* details,
-                  const net::URLRequestStatus& status) {
-  details->SetString("error", net::ErrorToString(status.error()));
+void ToDetails(WebRequestDetails* details,
+               const net::URLRequestStatus& status) {
+  details->has_error = true;
+  details->net_error = status.error();
 }
 
 // Helper function to fill |details| with arbitrary |args|.
-template<typename Arg>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg) {
-  ToDictionary(details, arg);
+void FillDetails(WebRequestDetails* details) {
 }
 
 template<typename Arg, typename... Args>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg, Args... args) {
-  ToDictionary(details, arg);
-  FillDetailsObject(details, args...);
+void FillDetails(WebRequestDetails* details, Arg arg, Args... args) {
+  ToDetails(details, arg);
+  FillDetails(details, args...);
 }
 
 // Fill the native types with the result from the response object.
@@ -273,6 +160,10 @@ void ReadFromResponseObject(const base::DictionaryValue& response,
 
 }  // namespace
 
+AtomNetworkDelegate::BatchOptions::BatchOptions()
+    : max_size(100), interval(base::TimeDelta::FromMilliseconds(100)) {
+}
+
 AtomNetworkDelegate::AtomNetworkDelegate() : weak_factory_(this) {
 }
 
@@ -283,10 +174,28 @@ void AtomNetworkDelegate::SetSimpleListenerInIO(
     SimpleEvent type,
     const URLPatterns& patterns,
     const SimpleListener& callback) {
+  // Events batched for the previous listener still go to it.
+  FlushBatches();
+
   if (callback.is_null())
     simple_listeners_.erase(type);
   else
-    simple_listeners_[type] = { patterns, callback };
+    simple_listeners_[type] = { URLPatternMatcher(patterns), callback };
+}
+
+void AtomNetworkDelegate::SetBatchListenerInIO(
+    SimpleEvent type,
+    const URLPatterns& patterns,
+    const BatchOptions& options,
+    const BatchListener& callback) {
+  FlushBatches();
+
+  if (callback.is_null()) {
+    simple_listeners_.erase(type);
+  } else {
+    simple_listeners_[type] = {
+        URLPatternMatcher(patterns), SimpleListener(), callback, options };
+  }
 }
 
 void AtomNetworkDelegate::SetResponseListenerInIO(
@@ -296,7 +205,12 @@ void AtomNetworkDelegate::SetResponseListenerInIO(
   if (callback.is_null())
     response_listeners_.erase(type);
   else
-    response_listeners_[type] = { patterns, callback };
+    response_listeners_[type] = { URLPatternMatcher(patterns), callback };
+}
+
+void AtomNetworkDelegate::SetRulesInIO(
+    const std::vector<WebRequestRule>& rules) {
+  rules_.SetRules(rules);
 }
 
 void AtomNetworkDelegate::SetDevToolsNetworkEmulationClientId(
@@ -309,6 +223,14 @@ int AtomNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
+  if (!rules_.empty()) {
+    int result = rules_.OnBeforeURLRequest(request, new_url);
+    // A redirected request comes back here with its new URL, listeners see
+    // it then.
+    if (result != net::OK || !new_url->is_empty())
+      return result;
+  }
+
   if (!base::ContainsKey(response_listeners_, kOnBeforeRequest))
     return brightray::NetworkDelegate::OnBeforeURLRequest(
         request, callback, new_url);
@@ -330,6 +252,8 @@ int AtomNetworkDelegate::OnBeforeStartTransaction(
     headers->SetHeader(network::ThrottlingNetworkTransaction::
                            kDevToolsEmulateNetworkConditionsClientId,
                        client_id);
+  rules_.OnBeforeStartTransaction(request, headers);
+
   if (!base::ContainsKey(response_listeners_, kOnBeforeSendHeaders))
     return brightray::NetworkDelegate::OnBeforeStartTransaction(
         request, callback, headers);
@@ -355,14 +279,19 @@ int AtomNetworkDelegate::OnHeadersReceived(
     const net::HttpResponseHeaders* original,
     scoped_refptr<net::HttpResponseHeaders>* override,
     GURL* new_url) {
+  rules_.OnHeadersReceived(request, original, override);
+
   if (!base::ContainsKey(response_listeners_, kOnHeadersReceived))
     return brightray::NetworkDelegate::OnHeadersReceived(
         request, callback, original, override, new_url);
 
+  // Listeners see the headers as modified by the rules.
+  const net::HttpResponseHeaders* headers =
+      override->get() ? override->get() : original;
   return HandleResponseEvent(
       kOnHeadersReceived, request, callback,
-      ResponseHeadersContainer(override, original->GetStatusLine(), new_url),
-      original);
+      ResponseHeadersContainer(override, headers->GetStatusLine(), new_url),
+      headers);
 }
 
 void AtomNetworkDelegate::OnBeforeRedirect(net::URLRequest* request,
@@ -443,27 +372,20 @@ int AtomNetworkDelegate::HandleResponseEvent(
   if (!MatchesFilterCondition(request, info.url_patterns))
     return net::OK;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
-  FillDetailsObject(details.get(), request, args...);
+  scoped_refptr<WebRequestDetails> details(new WebRequestDetails(request));
+  FillDetails(details.get(), args...);
 
   // The |request| could be destroyed before the |callback| is called.
   callbacks_[request->identifier()] = callback;
 
-  int frame_tree_node_id = -1;
-  GetFrameTreeNodeId(request, &frame_tree_node_id);
-
-  int render_frame_id = -1;
-  int render_process_id = -1;
-  GetRenderFrameIdAndProcessId(request, &render_frame_id, &render_process_id);
+  FlushBatchesOf(request);
 
   ResponseCallback response =
       base::Bind(&AtomNetworkDelegate::OnListenerResultInUI<Out>,
                  weak_factory_.GetWeakPtr(), request->identifier(), out);
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
-      base::Bind(RunResponseListener, info.listener, base::Passed(&details),
-                 frame_tree_node_id, render_frame_id, render_process_id,
-                 response));
+      base::Bind(info.listener, details, response));
   return net::ERR_IO_PENDING;
 }
 
@@ -474,20 +396,88 @@ void AtomNetworkDelegate::HandleSimpleEvent(
   if (!MatchesFilterCondition(request, info.url_patterns))
     return;
 
-  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
-  FillDetailsObject(details.get(), request, args...);
-
-  int frame_tree_node_id = -1;
-  GetFrameTreeNodeId(request, &frame_tree_node_id);
+  scoped_refptr<WebRequestDetails> details(new WebRequestDetails(request));
+  FillDetails(details.get(), args...);
 
-  int render_frame_id = -1;
-  int render_process_id = -1;
-  GetRenderFrameIdAndProcessId(request, &render_frame_id, &render_process_id);
+  if (!info.batch_listener.is_null()) {
+    QueueBatchedEvent(type, std::move(details));
+    return;
+  }
 
+  FlushBatchesOf(request);
   BrowserThread::PostTask(
-      BrowserThread::UI, FROM_HERE,
-      base::Bind(RunSimpleListener, info.listener, base::Passed(&details),
-          frame_tree_node_id, render_frame_id, render_process_id));
+      BrowserThread::UI, FROM_HERE, base::Bind(info.listener, details));
+}
+
+void AtomNetworkDelegate::QueueBatchedEvent(
+    SimpleEvent type, scoped_refptr<WebRequestDetails> details) {
+  const BatchOptions& options = simple_listeners_[type].batch_options;
+  pending_requests_.insert(details->id);
+  pending_events_.push_back({type, std::move(details)});
+
+  if (++pending_counts_[type] >= options.max_size) {
+    FlushBatches();
+    return;
+  }
+  // Listeners get their events at the latest after their own interval.
+  base::TimeTicks deadline = base::TimeTicks::Now() + options.interval;
+  if (!batch_timer_.IsRunning() || batch_timer_.desired_run_time() > deadline) {
+    // The timer is owned by |this|.
+    batch_timer_.Start(FROM_HERE, options.interval,
+                       base::Bind(&AtomNetworkDelegate::FlushBatches,
+                                  base::Unretained(this)));
+  }
+}
+
+void AtomNetworkDelegate::FlushBatches() {
+  batch_timer_.Stop();
+  std::vector<PendingEvent> events;
+  events.swap(pending_events_);
+  pending_counts_.clear();
+  pending_requests_.clear();
+
+  // An event joins the last batch of its type, unless an earlier event of
+  // its request is in a later batch. Batches are delivered in order, so the
+  // events of a request keep the order they happened in.
+  struct Batch {
+    SimpleEvent type;
+    std::vector<scoped_refptr<WebRequestDetails>> details;
+  };
+  std::vector<Batch> batches;
+  std::map<SimpleEvent, size_t> last_batch_of_type;
+  std::map<uint64_t, size_t> last_batch_of_request;
+  for (auto& event : events) {
+    uint64_t id = event.details->id;
+    auto type_batch = last_batch_of_type.find(event.type);
+    auto request_batch = last_batch_of_request.find(id);
+    size_t index;
+    if (type_batch != last_batch_of_type.end() &&
+        (request_batch == last_batch_of_request.end() ||
+         type_batch->second >= request_batch->second)) {
+      index = type_batch->second;
+    } else {
+      index = batches.size();
+      batches.push_back({event.type, {}});
+      last_batch_of_type[event.type] = index;
+    }
+    batches[index].details.push_back(std::move(event.details));
+    last_batch_of_request[id] = index;
+  }
+
+  for (auto& batch : batches) {
+    auto info = simple_listeners_.find(batch.type);
+    if (info == simple_listeners_.end() ||
+        info->second.batch_listener.is_null())
+      continue;
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(info->second.batch_listener, std::move(batch.details)));
+  }
+}
+
+void AtomNetworkDelegate::FlushBatchesOf(net::URLRequest* request) {
+  if (base::ContainsKey(pending_requests_, request->identifier()))
+    FlushBatches();
 }
 
 template<typename T>
@@ -9,30 +9,37 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "atom/browser/net/web_request_details.h"
+#include "atom/browser/net/web_request_rules.h"
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
 #include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
 #include "brightray/browser/network_delegate.h"
 #include "content/public/browser/resource_request_info.h"
-#include "extensions/common/url_pattern.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
 
 namespace atom {
 
-using URLPatterns = std::set<URLPattern>;
-
 const char* ResourceTypeToString(content::ResourceType type);
 
 class AtomNetworkDelegate : public brightray::NetworkDelegate {
  public:
   using ResponseCallback = base::Callback<void(const base::DictionaryValue&)>;
-  using SimpleListener = base::Callback<void(const base::DictionaryValue&)>;
-  using ResponseListener = base::Callback<void(const base::DictionaryValue&,
-                                               const ResponseCallback&)>;
+  using SimpleListener =
+      base::Callback<void(scoped_refptr<WebRequestDetails>)>;
+  using ResponseListener =
+      base::Callback<void(scoped_refptr<WebRequestDetails>,
+                          const ResponseCallback&)>;
+  using BatchListener = base::Callback<void(
+      const std::vector<scoped_refptr<WebRequestDetails>>&)>;
 
   enum SimpleEvent {
     kOnSendHeaders,
@@ -48,13 +55,26 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
     kOnHeadersReceived,
   };
 
+  // Controls how often a batched listener is called.
+  struct BatchOptions {
+    BatchOptions();
+
+    // Deliver as soon as this many events are pending.
+    size_t max_size;
+    // Deliver at the latest this long after the first pending event.
+    base::TimeDelta interval;
+  };
+
   struct SimpleListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_patterns;
     SimpleListener listener;
+    // Used instead of |listener| by batched listeners.
+    BatchListener batch_listener;
+    BatchOptions batch_options;
   };
 
   struct ResponseListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_patterns;
     ResponseListener listener;
   };
 
@@ -67,6 +87,11 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   void SetResponseListenerInIO(ResponseEvent type,
                                const URLPatterns& patterns,
                                const ResponseListener& callback);
+  void SetBatchListenerInIO(SimpleEvent type,
+                            const URLPatterns& patterns,
+                            const BatchOptions& options,
+                            const BatchListener& callback);
+  void SetRulesInIO(const std::vector<WebRequestRule>& rules);
 
   void SetDevToolsNetworkEmulationClientId(const std::string& client_id);
 
@@ -95,8 +120,22 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   void OnURLRequestDestroyed(net::URLRequest* request) override;
 
  private:
+  // An event waiting to be delivered to a batched listener.
+  struct PendingEvent {
+    SimpleEvent type;
+    scoped_refptr<WebRequestDetails> details;
+  };
+
   void OnErrorOccurred(net::URLRequest* request, bool started, int net_error);
 
+  void QueueBatchedEvent(SimpleEvent type,
+                         scoped_refptr<WebRequestDetails> details);
+  // Delivers the pending events of every batched listener, so that no event
+  // of a request overtakes an earlier one.
+  void FlushBatches();
+  // Events of |request| that are not batched must not overtake pending ones.
+  void FlushBatchesOf(net::URLRequest* request);
+
   template<typename...Args>
   void HandleSimpleEvent(SimpleEvent type,
                          net::URLRequest* request,
@@ -119,8 +158,17 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
 
   std::map<SimpleEvent, SimpleListenerInfo> simple_listeners_;
   std::map<ResponseEvent, ResponseListenerInfo> response_listeners_;
+  // Pending events of all batched listeners, in the order they happened.
+  std::vector<PendingEvent> pending_events_;
+  std::map<SimpleEvent, size_t> pending_counts_;
+  std::set<uint64_t> pending_requests_;
+  base::OneShotTimer batch_timer_;
   std::map<uint64_t, net::CompletionCallback> callbacks_;
 
+  // Declarative rules, applied before the listeners without leaving the IO
+  // thread.
+  WebRequestRules rules_;
+
   base::Lock lock_;
 
   base::WeakPtrFactory<AtomNetworkDelegate> weak_factory_;
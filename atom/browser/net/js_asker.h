@@ -8,6 +8,7 @@
 #include <memory>
 #include <utility>
 
+#include "atom/browser/net/protocol_response_cache.h"
 #include "atom/common/native_mate_converters/net_converter.h"
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
@@ -48,22 +49,38 @@ template<typename RequestJob>
 class JsAsker : public RequestJob {
  public:
   JsAsker(net::URLRequest* request, net::NetworkDelegate* network_delegate)
-      : RequestJob(request, network_delegate), weak_factory_(this) {}
+      : RequestJob(request, network_delegate),
+        cache_generation_(0),
+        weak_factory_(this) {}
 
   // Called by |CustomProtocolHandler| to store handler related information.
   void SetHandlerInfo(
       v8::Isolate* isolate,
       net::URLRequestContextGetter* request_context_getter,
-      const JavaScriptHandler& handler) {
+      const JavaScriptHandler& handler,
+      ProtocolResponseCache* response_cache) {
     isolate_ = isolate;
     request_context_getter_ = request_context_getter;
     handler_ = handler;
+    response_cache_ = response_cache;
   }
 
   // Subclass should do initailze work here.
   virtual void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) {}
   virtual void StartAsync(std::unique_ptr<base::Value> options) = 0;
 
+  // Whether the job can start from a copy of the options of an earlier
+  // request, which is the case when they hold the whole response.
+  virtual bool IsCacheable() const { return false; }
+
+  // Cacheable jobs start from the options with their body taken out by
+  // ProtocolResponseCache::TakeData, so that the body can be shared.
+  virtual base::Value::Type GetDataType() const {
+    return base::Value::Type::NONE;
+  }
+  virtual void StartWithData(std::unique_ptr<base::Value> options,
+                             scoped_refptr<base::RefCountedMemory> data) {}
+
   net::URLRequestContextGetter* request_context_getter() const {
     return request_context_getter_;
   }
@@ -71,6 +88,21 @@ class JsAsker : public RequestJob {
  private:
   // RequestJob:
   void Start() override {
+    std::unique_ptr<base::Value> options;
+    scoped_refptr<base::RefCountedMemory> data;
+    if (response_cache_ && IsCacheable() &&
+        response_cache_->Lookup(RequestJob::request(), &options, &data)) {
+      // Cached responses never reach the UI thread.
+      content::BrowserThread::PostTask(
+          content::BrowserThread::IO, FROM_HERE,
+          base::Bind(&JsAsker::StartWithData, weak_factory_.GetWeakPtr(),
+                     base::Passed(&options), data));
+      return;
+    }
+    // The cache may be invalidated while the handler is working on this.
+    if (response_cache_)
+      cache_generation_ = response_cache_->GetGeneration(RequestJob::request());
+
     std::unique_ptr<base::DictionaryValue> request_details(
         new base::DictionaryValue);
     FillRequestDetails(request_details.get(), RequestJob::request());
@@ -94,7 +126,16 @@ class JsAsker : public RequestJob {
   void OnResponse(bool success, std::unique_ptr<base::Value> value) {
     int error = net::ERR_NOT_IMPLEMENTED;
     if (success && value && !internal::IsErrorOptions(value.get(), &error)) {
-      StartAsync(std::move(value));
+      if (IsCacheable()) {
+        scoped_refptr<base::RefCountedMemory> data =
+            ProtocolResponseCache::TakeData(value.get(), GetDataType());
+        if (response_cache_)
+          response_cache_->Store(RequestJob::request(), cache_generation_,
+                                 *value, data);
+        StartWithData(std::move(value), data);
+      } else {
+        StartAsync(std::move(value));
+      }
     } else {
       RequestJob::NotifyStartError(
           net::URLRequestStatus(net::URLRequestStatus::FAILED, error));
@@ -104,6 +145,9 @@ class JsAsker : public RequestJob {
   v8::Isolate* isolate_;
   net::URLRequestContextGetter* request_context_getter_;
   JavaScriptHandler handler_;
+  scoped_refptr<ProtocolResponseCache> response_cache_;
+  // Generation of the response cache when the handler was asked.
+  uint64_t cache_generation_;
 
   base::WeakPtrFactory<JsAsker> weak_factory_;
 
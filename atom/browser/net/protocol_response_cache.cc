@@ -0,0 +1,315 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/protocol_response_cache.h"
+
+#include <utility>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/url_request/url_request.h"
+#include "url/gurl.h"
+
+using content::BrowserThread;
+
+namespace atom {
+
+namespace {
+
+const char kCacheControlKey[] = "cacheControl";
+const char kDataKey[] = "data";
+const char kMaxAgeDirective[] = "max-age=";
+
+// Serves a string or a blob value without copying it.
+class RefCountedValue : public base::RefCountedMemory {
+ public:
+  explicit RefCountedValue(std::unique_ptr<base::Value> value)
+      : value_(std::move(value)) {}
+
+  // base::RefCountedMemory:
+  const unsigned char* front() const override {
+    if (value_->is_blob())
+      return reinterpret_cast<const unsigned char*>(value_->GetBlob().data());
+    return reinterpret_cast<const unsigned char*>(value_->GetString().data());
+  }
+  size_t size() const override {
+    if (value_->is_blob())
+      return value_->GetBlob().size();
+    return value_->GetString().size();
+  }
+
+ private:
+  ~RefCountedValue() override {}
+
+  std::unique_ptr<base::Value> value_;
+
+  DISALLOW_COPY_AND_ASSIGN(RefCountedValue);
+};
+
+// Rough memory use of |value|.
+size_t EstimateSize(const base::Value& value) {
+  size_t size = sizeof(base::Value);
+  if (value.is_string()) {
+    size += value.GetString().size();
+  } else if (value.is_blob()) {
+    size += value.GetBlob().size();
+  } else if (value.is_dict()) {
+    for (const auto& item : value.DictItems())
+      size += item.first.size() + EstimateSize(item.second);
+  } else if (value.is_list()) {
+    for (const auto& item : value.GetList())
+      size += EstimateSize(item);
+  }
+  return size;
+}
+
+// Reads how long |options| stay fresh from their "cacheControl" directives,
+// which follow the Cache-Control header. Returns false if they must not be
+// cached.
+bool GetFreshness(const base::Value& options, base::TimeDelta* max_age) {
+  if (!options.is_dict())
+    return false;
+  const base::Value* cache_control =
+      options.FindKeyOfType(kCacheControlKey, base::Value::Type::STRING);
+  if (!cache_control)
+    return false;
+
+  bool immutable = false;
+  int64_t seconds = 0;
+  for (const base::StringPiece& directive : base::SplitStringPiece(
+           cache_control->GetString(), ",", base::TRIM_WHITESPACE,
+           base::SPLIT_WANT_NONEMPTY)) {
+    if (base::EqualsCaseInsensitiveASCII(directive, "no-store") ||
+        base::EqualsCaseInsensitiveASCII(directive, "no-cache"))
+      return false;
+    if (base::EqualsCaseInsensitiveASCII(directive, "immutable")) {
+      immutable = true;
+    } else if (base::StartsWith(directive, kMaxAgeDirective,
+                                base::CompareCase::INSENSITIVE_ASCII) &&
+               !base::StringToInt64(
+                   directive.substr(arraysize(kMaxAgeDirective) - 1),
+                   &seconds)) {
+      return false;
+    }
+  }
+
+  if (immutable)
+    *max_age = base::TimeDelta::Max();
+  else
+    *max_age = base::TimeDelta::FromSeconds(seconds);
+  return immutable || seconds > 0;
+}
+
+}  // namespace
+
+ProtocolResponseCache::Options::Options() : max_size(0) {
+}
+
+ProtocolResponseCache::Options::Options(const Options& other) = default;
+
+ProtocolResponseCache::Options::~Options() {
+}
+
+struct ProtocolResponseCache::Entry {
+  std::unique_ptr<base::Value> options;
+  scoped_refptr<base::RefCountedMemory> data;
+  size_t size;
+  // Null for entries that never expire.
+  base::TimeTicks expires;
+};
+
+struct ProtocolResponseCache::SchemeCache {
+  using EntryMap = base::MRUCache<std::string, Entry>;
+
+  SchemeCache() : size(0), entries(EntryMap::NO_AUTO_EVICT) {}
+
+  void Erase(EntryMap::iterator it) {
+    size -= it->second.size;
+    entries.Erase(it);
+  }
+
+  void EvictToFit() {
+    while (size > options.max_size && !entries.empty()) {
+      auto oldest = entries.rbegin();
+      size -= oldest->second.size;
+      entries.Erase(oldest);
+    }
+  }
+
+  Options options;
+  size_t size;
+  EntryMap entries;
+};
+
+ProtocolResponseCache::ProtocolResponseCache() {
+}
+
+ProtocolResponseCache::~ProtocolResponseCache() {
+}
+
+void ProtocolResponseCache::Configure(const std::string& scheme,
+                                      const Options& options) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  ++generations_[scheme];
+  if (!options.max_size) {
+    schemes_.erase(scheme);
+    return;
+  }
+
+  std::unique_ptr<SchemeCache>& cache = schemes_[scheme];
+  // Keys depend on the headers the scheme varies on.
+  if (!cache || cache->options.vary != options.vary)
+    cache.reset(new SchemeCache);
+  cache->options = options;
+  cache->EvictToFit();
+}
+
+void ProtocolResponseCache::Invalidate(const std::string& scheme,
+                                       const GURL& url) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  // Responses in flight may predate the change, whatever URL it was for.
+  ++generations_[scheme];
+  auto it = schemes_.find(scheme);
+  if (it == schemes_.end())
+    return;
+
+  SchemeCache* cache = it->second.get();
+  if (url.is_empty()) {
+    cache->entries.Clear();
+    cache->size = 0;
+    return;
+  }
+
+  // Entries of |url| differ only in the values of the vary headers.
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  std::string prefix = url.ReplaceComponents(replacements).spec();
+  for (auto entry = cache->entries.begin(); entry != cache->entries.end();) {
+    if (entry->first == prefix ||
+        (base::StartsWith(entry->first, prefix, base::CompareCase::SENSITIVE) &&
+         entry->first[prefix.size()] == '\n')) {
+      size_t size = entry->second.size;
+      entry = cache->entries.Erase(entry);
+      cache->size -= size;
+    } else {
+      ++entry;
+    }
+  }
+}
+
+uint64_t ProtocolResponseCache::GetGeneration(
+    const net::URLRequest* request) const {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  auto it = generations_.find(request->url().scheme());
+  return it == generations_.end() ? 0 : it->second;
+}
+
+// static
+scoped_refptr<base::RefCountedMemory> ProtocolResponseCache::TakeData(
+    base::Value* options,
+    base::Value::Type type) {
+  std::unique_ptr<base::Value> data;
+  if (options->type() == type) {
+    data.reset(new base::Value(std::move(*options)));
+    *options = base::Value(base::Value::Type::DICTIONARY);
+  } else if (options->is_dict()) {
+    base::DictionaryValue* dict = static_cast<base::DictionaryValue*>(options);
+    const base::Value* value = dict->FindKeyOfType(kDataKey, type);
+    if (value)
+      dict->RemoveWithoutPathExpansion(kDataKey, &data);
+  }
+  if (!data)
+    return nullptr;
+  return base::MakeRefCounted<RefCountedValue>(std::move(data));
+}
+
+bool ProtocolResponseCache::Lookup(
+    const net::URLRequest* request,
+    std::unique_ptr<base::Value>* options,
+    scoped_refptr<base::RefCountedMemory>* data) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  std::string key;
+  SchemeCache* cache = GetSchemeCache(request, &key);
+  if (!cache)
+    return false;
+
+  auto entry = cache->entries.Get(key);
+  if (entry == cache->entries.end())
+    return false;
+  if (!entry->second.expires.is_null() &&
+      entry->second.expires <= base::TimeTicks::Now()) {
+    cache->Erase(entry);
+    return false;
+  }
+  // The options without the body are small.
+  *options = entry->second.options->CreateDeepCopy();
+  *data = entry->second.data;
+  return true;
+}
+
+void ProtocolResponseCache::Store(const net::URLRequest* request,
+                                  uint64_t generation,
+                                  const base::Value& options,
+                                  scoped_refptr<base::RefCountedMemory> data) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (generation != GetGeneration(request))
+    return;
+  base::TimeDelta max_age;
+  if (!GetFreshness(options, &max_age))
+    return;
+  std::string key;
+  SchemeCache* cache = GetSchemeCache(request, &key);
+  if (!cache)
+    return;
+
+  Entry entry;
+  entry.size = key.size() + EstimateSize(options);
+  if (data)
+    entry.size += data->size();
+  if (entry.size > cache->options.max_size)
+    return;
+  entry.options = options.CreateDeepCopy();
+  entry.data = std::move(data);
+  if (!max_age.is_max())
+    entry.expires = base::TimeTicks::Now() + max_age;
+
+  auto existing = cache->entries.Peek(key);
+  if (existing != cache->entries.end())
+    cache->Erase(existing);
+  cache->size += entry.size;
+  cache->entries.Put(key, std::move(entry));
+  cache->EvictToFit();
+}
+
+ProtocolResponseCache::SchemeCache* ProtocolResponseCache::GetSchemeCache(
+    const net::URLRequest* request,
+    std::string* key) {
+  // Handlers see the method and the upload data, only plain GETs are known
+  // to get the same response every time.
+  if (request->method() != "GET" || request->has_upload())
+    return nullptr;
+  auto it = schemes_.find(request->url().scheme());
+  if (it == schemes_.end())
+    return nullptr;
+
+  SchemeCache* cache = it->second.get();
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  *key = request->url().ReplaceComponents(replacements).spec();
+  for (const std::string& header : cache->options.vary) {
+    std::string value;
+    if (base::EqualsCaseInsensitiveASCII(header, "referer"))
+      value = request->referrer();
+    else
+      request->extra_request_headers().GetHeader(header, &value);
+    key->push_back('\n');
+    key->append(value);
+  }
+  return cache;
+}
+
+}  // namespace atom
@@ -0,0 +1,113 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+#define ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/time/time.h"
+#include "base/values.h"
+
+class GURL;
+
+namespace net {
+class URLRequest;
+}
+
+namespace atom {
+
+// Responses of custom protocol handlers, kept on the IO thread so repeated
+// requests are answered without asking JS.
+//
+// Caching is enabled per scheme. What is cached is the options the handler
+// responded with, for as long as the "cacheControl" directives among them
+// allow. The response body is kept apart from the options and shared by
+// every request answered from the entry. Entries are keyed by URL and by the
+// request headers the scheme declares its responses vary on, and the least
+// recently used ones are dropped when a scheme goes over its size limit.
+//
+// Each scheme has a generation that changes whenever its entries are dropped
+// or reconfigured, so a response asked for before that is never stored after.
+class ProtocolResponseCache
+    : public base::RefCountedThreadSafe<ProtocolResponseCache> {
+ public:
+  struct Options {
+    Options();
+    Options(const Options& other);
+    ~Options();
+
+    // Approximate number of bytes the entries of the scheme may take, 0
+    // disables caching.
+    size_t max_size;
+    // Request headers that select different responses, "Referer" stands for
+    // the referrer of the request.
+    std::vector<std::string> vary;
+  };
+
+  ProtocolResponseCache();
+
+  void Configure(const std::string& scheme, const Options& options);
+
+  // Drops the entry of |url|, or every entry of |scheme| if |url| is empty.
+  void Invalidate(const std::string& scheme, const GURL& url);
+
+  // Returns the current generation of |request|'s scheme, which is passed to
+  // Store() once the handler has responded.
+  uint64_t GetGeneration(const net::URLRequest* request) const;
+
+  // Moves the response body out of |options|, which is either their "data"
+  // key or the options themselves, if it is of |type|. Options that were the
+  // body are replaced by an empty dictionary. Returns null if there is no
+  // such body.
+  static scoped_refptr<base::RefCountedMemory> TakeData(
+      base::Value* options,
+      base::Value::Type type);
+
+  // Looks up the response cached for |request|, returns false if there is
+  // none. |options| is a copy of the cached options and |data| the shared
+  // body, which may be null.
+  bool Lookup(const net::URLRequest* request,
+              std::unique_ptr<base::Value>* options,
+              scoped_refptr<base::RefCountedMemory>* data);
+
+  // Caches the handler's |options| and the |data| taken out of them for
+  // |request| if they allow it, and if the scheme is still at |generation|.
+  void Store(const net::URLRequest* request,
+             uint64_t generation,
+             const base::Value& options,
+             scoped_refptr<base::RefCountedMemory> data);
+
+ private:
+  friend class base::RefCountedThreadSafe<ProtocolResponseCache>;
+
+  struct Entry;
+  struct SchemeCache;
+
+  ~ProtocolResponseCache();
+
+  // Returns the cache of |request|'s scheme and its key, or null if the
+  // request can't be cached.
+  SchemeCache* GetSchemeCache(const net::URLRequest* request,
+                              std::string* key);
+
+  std::map<std::string, std::unique_ptr<SchemeCache>> schemes_;
+  // Kept apart from |schemes_|, a scheme's generation outlives its cache.
+  std::map<std::string, uint64_t> generations_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtocolResponseCache);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
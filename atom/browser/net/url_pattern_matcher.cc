@@ -0,0 +1,117 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_pattern_matcher.h"
+
+#include <map>
+#include <utility>
+
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+// Hosts are compared without a trailing dot, candidates are verified with
+// URLPattern::MatchesURL anyway.
+base::StringPiece NormalizeHost(base::StringPiece host) {
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+  return host;
+}
+
+}  // namespace
+
+URLPatternMatcher::URLPatternMatcher() {
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatterns& patterns)
+    : patterns_(patterns.begin(), patterns.end()) {
+  std::map<std::string, PatternList> exact_hosts;
+  std::map<std::string, PatternList> subdomain_hosts;
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    const URLPattern& pattern = patterns_[i];
+    std::string host =
+        base::ToLowerASCII(NormalizeHost(pattern.host()));
+    if (pattern.match_all_urls() ||
+        (pattern.match_subdomains() && host.empty()))
+      any_host_.push_back(i);
+    else if (pattern.match_subdomains())
+      subdomain_hosts[host].push_back(i);
+    else
+      exact_hosts[host].push_back(i);
+  }
+
+  // Built in one go, flat_map insertions one by one are quadratic.
+  exact_hosts_ = HostMap(std::make_move_iterator(exact_hosts.begin()),
+                         std::make_move_iterator(exact_hosts.end()),
+                         base::KEEP_FIRST_OF_DUPES);
+  subdomain_hosts_ = HostMap(std::make_move_iterator(subdomain_hosts.begin()),
+                             std::make_move_iterator(subdomain_hosts.end()),
+                             base::KEEP_FIRST_OF_DUPES);
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatternMatcher& other) = default;
+
+URLPatternMatcher& URLPatternMatcher::operator=(
+    const URLPatternMatcher& other) = default;
+
+URLPatternMatcher::~URLPatternMatcher() {
+}
+
+bool URLPatternMatcher::MatchesURL(const GURL& url) const {
+  if (patterns_.empty())
+    return true;
+
+  if (MatchesAny(any_host_, url))
+    return true;
+
+  // filesystem: URLs are matched by their inner URL, don't try to be clever.
+  if (url.SchemeIsFileSystem()) {
+    for (const auto& pattern : patterns_) {
+      if (pattern.MatchesURL(url))
+        return true;
+    }
+    return false;
+  }
+
+  base::StringPiece host = NormalizeHost(url.host_piece());
+  auto exact = exact_hosts_.find(host);
+  if (exact != exact_hosts_.end() && MatchesAny(exact->second, url))
+    return true;
+
+  return MatchesHost(subdomain_hosts_, host, url);
+}
+
+bool URLPatternMatcher::MatchesAny(const PatternList& candidates,
+                                   const GURL& url) const {
+  for (size_t index : candidates) {
+    if (patterns_[index].MatchesURL(url))
+      return true;
+  }
+  return false;
+}
+
+bool URLPatternMatcher::MatchesHost(const HostMap& hosts,
+                                    base::StringPiece host,
+                                    const GURL& url) const {
+  if (hosts.empty())
+    return false;
+
+  // Try "a.b.c", then "b.c", then "c".
+  while (!host.empty()) {
+    auto it = hosts.find(host);
+    if (it != hosts.end() && MatchesAny(it->second, url))
+      return true;
+
+    size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    host.remove_prefix(dot + 1);
+  }
+  return false;
+}
+
+}  // namespace atom
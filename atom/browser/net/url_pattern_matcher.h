@@ -0,0 +1,59 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+#define ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace atom {
+
+using URLPatterns = std::set<URLPattern>;
+
+// A set of URLPatterns compiled for matching many URLs against.
+//
+// Patterns are bucketed by host: exact hosts, hosts that also match their
+// subdomains, and patterns that match any host. Matching a URL probes the
+// buckets for its host and each of its parent domains, then verifies only
+// those candidates, so the cost depends on the depth of the host rather than
+// on the number of patterns. Probing never allocates.
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  explicit URLPatternMatcher(const URLPatterns& patterns);
+  URLPatternMatcher(const URLPatternMatcher& other);
+  URLPatternMatcher& operator=(const URLPatternMatcher& other);
+  ~URLPatternMatcher();
+
+  // An empty matcher matches every URL.
+  bool empty() const { return patterns_.empty(); }
+
+  bool MatchesURL(const GURL& url) const;
+
+ private:
+  using PatternList = std::vector<size_t>;
+  using HostMap = base::flat_map<std::string, PatternList, std::less<>>;
+
+  bool MatchesAny(const PatternList& candidates, const GURL& url) const;
+  bool MatchesHost(const HostMap& hosts,
+                   base::StringPiece host,
+                   const GURL& url) const;
+
+  std::vector<URLPattern> patterns_;
+  HostMap exact_hosts_;
+  HostMap subdomain_hosts_;
+  PatternList any_host_;
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
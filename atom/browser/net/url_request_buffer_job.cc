@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "atom/common/atom_constants.h"
 #include "base/strings/string_number_conversions.h"
@@ -34,19 +35,27 @@ URLRequestBufferJob::URLRequestBufferJob(
 }
 
 void URLRequestBufferJob::StartAsync(std::unique_ptr<base::Value> options) {
-  const base::Value::BlobStorage* blob = nullptr;
+  scoped_refptr<base::RefCountedMemory> data =
+      ProtocolResponseCache::TakeData(options.get(), GetDataType());
+  StartWithData(std::move(options), data);
+}
+
+bool URLRequestBufferJob::IsCacheable() const {
+  return true;
+}
+
+base::Value::Type URLRequestBufferJob::GetDataType() const {
+  return base::Value::Type::BINARY;
+}
+
+void URLRequestBufferJob::StartWithData(
+    std::unique_ptr<base::Value> options,
+    scoped_refptr<base::RefCountedMemory> data) {
   if (options->is_dict()) {
-    const base::Value* binary = nullptr;
     base::DictionaryValue* dict =
         static_cast<base::DictionaryValue*>(options.get());
     dict->GetString("mimeType", &mime_type_);
     dict->GetString("charset", &charset_);
-    dict->GetBinary("data", &binary);
-    if (binary) {
-      blob = &binary->GetBlob();
-    }
-  } else if (options->is_blob()) {
-    blob = &options->GetBlob();
   }
 
   if (mime_type_.empty()) {
@@ -58,14 +67,13 @@ void URLRequestBufferJob::StartAsync(std::unique_ptr<base::Value> options) {
 #endif
   }
 
-  if (!blob) {
+  if (!data) {
     NotifyStartError(net::URLRequestStatus(
           net::URLRequestStatus::FAILED, net::ERR_NOT_IMPLEMENTED));
     return;
   }
 
-  data_ = new base::RefCountedBytes(
-      reinterpret_cast<const unsigned char*>(blob->data()), blob->size());
+  data_ = std::move(data);
   status_code_ = net::HTTP_OK;
   net::URLRequestSimpleJob::Start();
 }
@@ -21,6 +21,10 @@ class URLRequestBufferJob : public JsAsker<net::URLRequestSimpleJob> {
 
   // JsAsker:
   void StartAsync(std::unique_ptr<base::Value> options) override;
+  bool IsCacheable() const override;
+  base::Value::Type GetDataType() const override;
+  void StartWithData(std::unique_ptr<base::Value> options,
+                     scoped_refptr<base::RefCountedMemory> data) override;
 
   // URLRequestJob:
   void GetResponseInfo(net::HttpResponseInfo* info) override;
@@ -34,7 +38,7 @@ class URLRequestBufferJob : public JsAsker<net::URLRequestSimpleJob> {
  private:
   std::string mime_type_;
   std::string charset_;
-  scoped_refptr<base::RefCountedBytes> data_;
+  scoped_refptr<base::RefCountedMemory> data_;
   net::HttpStatusCode status_code_;
 
   DISALLOW_COPY_AND_ASSIGN(URLRequestBufferJob);
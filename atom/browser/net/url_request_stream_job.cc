@@ -0,0 +1,329 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_request_stream_job.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "atom/common/api/locker.h"
+#include "atom/common/native_mate_converters/callback.h"
+#include "base/strings/string_number_conversions.h"
+#include "native_mate/dictionary.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_status_code.h"
+#include "net/http/http_util.h"
+
+#include "atom/common/node_includes.h"
+
+using content::BrowserThread;
+
+namespace atom {
+
+namespace {
+
+// A read waiting for the JS source, which may call back at most once.
+struct PendingRead : public base::RefCountedThreadSafe<PendingRead> {
+  PendingRead(net::IOBuffer* buffer,
+              int size,
+              const net::CompletionCallback& callback)
+      : buffer(buffer), size(size), callback(callback), done(false) {}
+
+  void Complete(int result) {
+    if (done)
+      return;
+    done = true;
+    BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                            base::Bind(callback, result));
+  }
+
+  scoped_refptr<net::IOBuffer> buffer;
+  int size;
+  net::CompletionCallback callback;
+  bool done;
+
+ private:
+  friend class base::RefCountedThreadSafe<PendingRead>;
+  ~PendingRead() {}
+};
+
+// The callback passed to the source, called with a Buffer, with null at the
+// end of the response or with an Error.
+void OnChunk(scoped_refptr<PendingRead> pending, mate::Arguments* args) {
+  if (pending->done)
+    return;
+
+  v8::Local<v8::Value> chunk;
+  if (!args->GetNext(&chunk) || chunk->IsNullOrUndefined()) {
+    pending->Complete(0);
+  } else if (node::Buffer::HasInstance(chunk)) {
+    // Chunks longer than asked for are cut, sources are expected to keep the
+    // rest for the next read.
+    size_t length = std::min(node::Buffer::Length(chunk),
+                             static_cast<size_t>(pending->size));
+    memcpy(pending->buffer->data(), node::Buffer::Data(chunk), length);
+    pending->Complete(static_cast<int>(length));
+  } else {
+    pending->Complete(net::ERR_FAILED);
+  }
+}
+
+}  // namespace
+
+// The JS function producing the response. Read on the IO thread, released on
+// the UI thread.
+class URLRequestStreamJob::Source
+    : public base::RefCountedThreadSafe<Source,
+                                        BrowserThread::DeleteOnUIThread> {
+ public:
+  Source(v8::Isolate* isolate,
+         v8::Local<v8::Function> read,
+         v8::Local<v8::Function> close)
+      : isolate_(isolate), read_(isolate, read), closed_(false) {
+    if (!close.IsEmpty())
+      close_.Reset(isolate, close);
+  }
+
+  // Asks for up to |size| bytes at |offset| and copies them into |buffer|.
+  // |callback| runs on the IO thread with the number of bytes, 0 at the end
+  // of the response or a net error.
+  void Read(int64_t offset,
+            net::IOBuffer* buffer,
+            int size,
+            const net::CompletionCallback& callback) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&Source::ReadInUI, this, offset,
+                   base::WrapRefCounted(new PendingRead(buffer, size,
+                                                      callback))));
+  }
+
+  // Tells the source that no more reads will come, because the response is
+  // complete or the request was aborted. Only the first call does anything.
+  void Close() {
+    if (closed_)
+      return;
+    closed_ = true;
+    BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
+                            base::Bind(&Source::CloseInUI, this));
+  }
+
+ private:
+  friend struct BrowserThread::DeleteOnThread<BrowserThread::UI>;
+  friend class base::DeleteHelper<Source>;
+
+  ~Source() {}
+
+  void ReadInUI(int64_t offset, scoped_refptr<PendingRead> pending) {
+    mate::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::MicrotasksScope script_scope(isolate_,
+                                     v8::MicrotasksScope::kRunMicrotasks);
+    v8::Local<v8::Function> read = read_.Get(isolate_);
+    v8::Local<v8::Context> context = read->CreationContext();
+    v8::Context::Scope context_scope(context);
+
+    v8::Local<v8::Value> args[] = {
+      v8::Number::New(isolate_, static_cast<double>(offset)),
+      v8::Integer::New(isolate_, pending->size),
+      mate::ConvertToV8(isolate_, base::Bind(&OnChunk, pending)),
+    };
+    v8::TryCatch try_catch(isolate_);
+    if (read->Call(context, v8::Undefined(isolate_), arraysize(args), args)
+            .IsEmpty())
+      pending->Complete(net::ERR_FAILED);
+  }
+
+  void CloseInUI() {
+    if (close_.IsEmpty())
+      return;
+
+    mate::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::MicrotasksScope script_scope(isolate_,
+                                     v8::MicrotasksScope::kRunMicrotasks);
+    v8::Local<v8::Function> close = close_.Get(isolate_);
+    v8::Local<v8::Context> context = close->CreationContext();
+    v8::Context::Scope context_scope(context);
+
+    v8::TryCatch try_catch(isolate_);
+    ignore_result(close->Call(context, v8::Undefined(isolate_), 0, nullptr));
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Function> read_;
+  v8::Global<v8::Function> close_;
+  // Only accessed on the IO thread.
+  bool closed_;
+
+  DISALLOW_COPY_AND_ASSIGN(Source);
+};
+
+URLRequestStreamJob::URLRequestStreamJob(
+    net::URLRequest* request, net::NetworkDelegate* network_delegate)
+    : JsAsker<net::URLRequestJob>(request, network_delegate),
+      offset_(0),
+      remaining_bytes_(-1),
+      weak_factory_(this) {
+}
+
+URLRequestStreamJob::~URLRequestStreamJob() {
+  CloseSource();
+}
+
+void URLRequestStreamJob::BeforeStartInUI(
+    v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  mate::Dictionary options;
+  v8::Local<v8::Function> read;
+  if (mate::ConvertFromV8(isolate, value, &options) &&
+      options.Get("data", &read)) {
+    v8::Local<v8::Function> close;
+    options.Get("close", &close);
+    source_ = new Source(isolate, read, close);
+  }
+}
+
+void URLRequestStreamJob::StartAsync(std::unique_ptr<base::Value> options) {
+  if (!source_ || !options->is_dict()) {
+    NotifyStartError(net::URLRequestStatus(
+          net::URLRequestStatus::FAILED, net::ERR_NOT_IMPLEMENTED));
+    return;
+  }
+
+  base::DictionaryValue* dict =
+      static_cast<base::DictionaryValue*>(options.get());
+  dict->GetString("mimeType", &mime_type_);
+  dict->GetString("charset", &charset_);
+  double length = -1;
+  dict->GetDouble("length", &length);
+  int64_t content_length = length >= 0 ? static_cast<int64_t>(length) : -1;
+
+  // A range can only be served when the length is known, otherwise the whole
+  // response is sent.
+  net::HttpStatusCode status_code = net::HTTP_OK;
+  if (byte_range_.IsValid() && content_length >= 0) {
+    if (!byte_range_.ComputeBounds(content_length)) {
+      NotifyStartError(
+          net::URLRequestStatus(net::URLRequestStatus::FAILED,
+                                net::ERR_REQUEST_RANGE_NOT_SATISFIABLE));
+      return;
+    }
+    status_code = net::HTTP_PARTIAL_CONTENT;
+    offset_ = byte_range_.first_byte_position();
+    remaining_bytes_ = byte_range_.last_byte_position() - offset_ + 1;
+  } else {
+    remaining_bytes_ = content_length;
+  }
+
+  std::string status("HTTP/1.1 ");
+  status.append(base::IntToString(status_code));
+  status.append(" ");
+  status.append(net::GetHttpReasonPhrase(status_code));
+  status.append("\0\0", 2);
+  response_headers_ = new net::HttpResponseHeaders(status);
+
+  if (!mime_type_.empty()) {
+    std::string content_type_header(net::HttpRequestHeaders::kContentType);
+    content_type_header.append(": ");
+    content_type_header.append(mime_type_);
+    response_headers_->AddHeader(content_type_header);
+  }
+  if (content_length >= 0) {
+    response_headers_->AddHeader("Accept-Ranges: bytes");
+    response_headers_->AddHeader(
+        std::string(net::HttpRequestHeaders::kContentLength) + ": " +
+        base::Int64ToString(remaining_bytes_));
+    set_expected_content_size(remaining_bytes_);
+  }
+  if (status_code == net::HTTP_PARTIAL_CONTENT) {
+    response_headers_->AddHeader(
+        "Content-Range: bytes " +
+        base::Int64ToString(byte_range_.first_byte_position()) + "-" +
+        base::Int64ToString(byte_range_.last_byte_position()) + "/" +
+        base::Int64ToString(content_length));
+  }
+
+  const base::DictionaryValue* headers = nullptr;
+  if (dict->GetDictionary("headers", &headers)) {
+    for (base::DictionaryValue::Iterator it(*headers); !it.IsAtEnd();
+         it.Advance()) {
+      std::string value;
+      if (it.value().GetAsString(&value) &&
+          net::HttpUtil::IsValidHeaderName(it.key()) &&
+          net::HttpUtil::IsValidHeaderValue(value))
+        response_headers_->AddHeader(it.key() + ": " + value);
+    }
+  }
+
+  NotifyHeadersComplete();
+}
+
+void URLRequestStreamJob::SetExtraRequestHeaders(
+    const net::HttpRequestHeaders& headers) {
+  // Requests for several ranges get the whole response.
+  std::string range_header;
+  std::vector<net::HttpByteRange> ranges;
+  if (headers.GetHeader(net::HttpRequestHeaders::kRange, &range_header) &&
+      net::HttpUtil::ParseRangeHeader(range_header, &ranges) &&
+      ranges.size() == 1)
+    byte_range_ = ranges[0];
+}
+
+void URLRequestStreamJob::Kill() {
+  weak_factory_.InvalidateWeakPtrs();
+  CloseSource();
+  JsAsker<URLRequestJob>::Kill();
+}
+
+int URLRequestStreamJob::ReadRawData(net::IOBuffer* buf, int buf_size) {
+  if (remaining_bytes_ == 0) {
+    CloseSource();
+    return 0;
+  }
+  if (remaining_bytes_ > 0 && remaining_bytes_ < buf_size)
+    buf_size = static_cast<int>(remaining_bytes_);
+
+  source_->Read(offset_, buf, buf_size,
+                base::Bind(&URLRequestStreamJob::OnReadComplete,
+                           weak_factory_.GetWeakPtr()));
+  return net::ERR_IO_PENDING;
+}
+
+bool URLRequestStreamJob::GetMimeType(std::string* mime_type) const {
+  *mime_type = mime_type_;
+  return !mime_type_.empty();
+}
+
+bool URLRequestStreamJob::GetCharset(std::string* charset) {
+  *charset = charset_;
+  return !charset_.empty();
+}
+
+void URLRequestStreamJob::GetResponseInfo(net::HttpResponseInfo* info) {
+  if (response_headers_)
+    info->headers = response_headers_;
+}
+
+void URLRequestStreamJob::OnReadComplete(int result) {
+  if (result > 0) {
+    offset_ += result;
+    if (remaining_bytes_ > 0)
+      remaining_bytes_ -= result;
+  } else if (result == 0 && remaining_bytes_ > 0) {
+    // The source ended before the length it announced.
+    result = net::ERR_CONTENT_LENGTH_MISMATCH;
+  }
+  if (result <= 0)
+    CloseSource();
+  ReadRawDataComplete(result);
+}
+
+void URLRequestStreamJob::CloseSource() {
+  if (source_)
+    source_->Close();
+}
+
+}  // namespace atom
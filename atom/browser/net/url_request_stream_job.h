@@ -0,0 +1,68 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+#define ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
+
+#include <memory>
+#include <string>
+
+#include "atom/browser/net/js_asker.h"
+#include "base/memory/weak_ptr.h"
+#include "net/http/http_byte_range.h"
+
+namespace atom {
+
+// Serves a response that JS produces chunk by chunk.
+//
+// The handler responds with a function that is called with the offset and the
+// maximum size of the next chunk whenever the consumer wants more data, so at
+// most one chunk is in flight and nothing is buffered beyond it. Single byte
+// ranges are served when the handler tells the length of the response. The
+// handler's optional close function is called once the response is complete
+// or the request is aborted.
+class URLRequestStreamJob : public JsAsker<net::URLRequestJob> {
+ public:
+  URLRequestStreamJob(net::URLRequest*, net::NetworkDelegate*);
+  ~URLRequestStreamJob() override;
+
+  // JsAsker:
+  void BeforeStartInUI(v8::Isolate*, v8::Local<v8::Value>) override;
+  void StartAsync(std::unique_ptr<base::Value> options) override;
+
+  // URLRequestJob:
+  void SetExtraRequestHeaders(const net::HttpRequestHeaders& headers) override;
+  void Kill() override;
+  int ReadRawData(net::IOBuffer* buf, int buf_size) override;
+  bool GetMimeType(std::string* mime_type) const override;
+  bool GetCharset(std::string* charset) override;
+  void GetResponseInfo(net::HttpResponseInfo* info) override;
+
+ private:
+  class Source;
+
+  void OnReadComplete(int result);
+  // Lets the source release its resources once the response is done.
+  void CloseSource();
+
+  scoped_refptr<Source> source_;
+
+  std::string mime_type_;
+  std::string charset_;
+  scoped_refptr<net::HttpResponseHeaders> response_headers_;
+
+  net::HttpByteRange byte_range_;
+  // Offset of the next chunk, and the number of bytes left or -1 when the
+  // length is unknown.
+  int64_t offset_;
+  int64_t remaining_bytes_;
+
+  base::WeakPtrFactory<URLRequestStreamJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestStreamJob);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_REQUEST_STREAM_JOB_H_
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "atom/common/atom_constants.h"
 #include "net/base/net_errors.h"
@@ -18,15 +19,31 @@ URLRequestStringJob::URLRequestStringJob(
 }
 
 void URLRequestStringJob::StartAsync(std::unique_ptr<base::Value> options) {
+  scoped_refptr<base::RefCountedMemory> data =
+      ProtocolResponseCache::TakeData(options.get(), GetDataType());
+  StartWithData(std::move(options), data);
+}
+
+bool URLRequestStringJob::IsCacheable() const {
+  return true;
+}
+
+base::Value::Type URLRequestStringJob::GetDataType() const {
+  return base::Value::Type::STRING;
+}
+
+void URLRequestStringJob::StartWithData(
+    std::unique_ptr<base::Value> options,
+    scoped_refptr<base::RefCountedMemory> data) {
   if (options->is_dict()) {
     base::DictionaryValue* dict =
         static_cast<base::DictionaryValue*>(options.get());
     dict->GetString("mimeType", &mime_type_);
     dict->GetString("charset", &charset_);
-    dict->GetString("data", &data_);
-  } else if (options->is_string()) {
-    options->GetAsString(&data_);
   }
+  data_ = std::move(data);
+  if (!data_)
+    data_ = new base::RefCountedString;
   net::URLRequestSimpleJob::Start();
 }
 
@@ -44,10 +61,10 @@ void URLRequestStringJob::GetResponseInfo(net::HttpResponseInfo* info) {
   info->headers = headers;
 }
 
-int URLRequestStringJob::GetData(
+int URLRequestStringJob::GetRefCountedData(
     std::string* mime_type,
     std::string* charset,
-    std::string* data,
+    scoped_refptr<base::RefCountedMemory>* data,
     const net::CompletionCallback& callback) const {
   *mime_type = mime_type_;
   *charset = charset_;
@@ -0,0 +1,322 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/web_request_details.h"
+
+#include <vector>
+
+#include "atom/browser/extensions/tab_helper.h"
+#include "atom/browser/net/atom_network_delegate.h"
+#include "atom/common/api/object_life_monitor.h"
+#include "atom/common/native_mate_converters/net_converter.h"
+#include "atom/common/native_mate_converters/value_converter.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "chrome/browser/extensions/api/tabs/tabs_constants.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/resource_request_info.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/browser/websocket_handshake_request_info.h"
+#include "extensions/buildflags/buildflags.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "net/url_request/url_request.h"
+
+namespace atom {
+
+namespace {
+
+void GetRenderFrameIdAndProcessId(net::URLRequest* request,
+    int* render_frame_id,
+    int* render_process_id) {
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+  if (!content::ResourceRequestInfo::GetRenderFrameForRequest(
+          request, render_process_id, render_frame_id)) {
+    const content::WebSocketHandshakeRequestInfo* websocket_info =
+      content::WebSocketHandshakeRequestInfo::ForRequest(request);
+    if (websocket_info) {
+      *render_frame_id = websocket_info->GetRenderFrameId();
+      *render_process_id = websocket_info->GetChildId();
+    }
+  }
+#endif
+}
+
+int GetTabId(int frame_tree_node_id,
+             int render_frame_id,
+             int render_process_id) {
+  auto web_contents =
+      content::WebContents::FromFrameTreeNodeId(frame_tree_node_id);
+
+  if (!web_contents) {
+    content::RenderFrameHost* rfh =
+        content::RenderFrameHost::FromID(render_process_id, render_frame_id);
+    if (rfh)
+      web_contents = content::WebContents::FromRenderFrameHost(rfh);
+  }
+
+  return extensions::TabHelper::IdForTab(web_contents);
+}
+
+// Keeps the snapshot alive for as long as its JS object.
+class DetailsHolder : public ObjectLifeMonitor {
+ public:
+  DetailsHolder(v8::Isolate* isolate,
+                v8::Local<v8::Object> target,
+                const scoped_refptr<WebRequestDetails>& details)
+      : ObjectLifeMonitor(isolate, target), details_(details) {}
+
+ protected:
+  void RunDestructor() override {}
+
+ private:
+  scoped_refptr<WebRequestDetails> details_;
+
+  DISALLOW_COPY_AND_ASSIGN(DetailsHolder);
+};
+
+using FieldGetter = v8::Local<v8::Value> (*)(v8::Isolate* isolate,
+                                             const WebRequestDetails& details);
+
+template<FieldGetter getter>
+void GetLazyField(v8::Local<v8::Name> name,
+                  const v8::PropertyCallbackInfo<v8::Value>& info) {
+  auto* details = static_cast<const WebRequestDetails*>(
+      v8::Local<v8::External>::Cast(info.Data())->Value());
+  info.GetReturnValue().Set(getter(info.GetIsolate(), *details));
+}
+
+v8::Local<v8::Value> GetMethod(v8::Isolate* isolate,
+                               const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.method);
+}
+
+v8::Local<v8::Value> GetURL(v8::Isolate* isolate,
+                            const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.url);
+}
+
+v8::Local<v8::Value> GetReferrer(v8::Isolate* isolate,
+                                 const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.referrer);
+}
+
+v8::Local<v8::Value> GetUploadDataField(v8::Isolate* isolate,
+                                        const WebRequestDetails& details) {
+  return mate::ConvertToV8(isolate, *details.upload_data);
+}
+
+v8::Local<v8::Value> GetFirstPartyURL(v8::Isolate* isolate,
+                                      const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.first_party_url);
+}
+
+v8::Local<v8::Value> GetIP(v8::Isolate* isolate,
+                           const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.ip);
+}
+
+v8::Local<v8::Value> GetRequestHeaders(v8::Isolate* isolate,
+                                       const WebRequestDetails& details) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> headers = v8::Object::New(isolate);
+  net::HttpRequestHeaders::Iterator it(*details.request_headers);
+  while (it.GetNext()) {
+    headers->Set(context, mate::StringToV8(isolate, it.name()),
+                 mate::StringToV8(isolate, it.value())).FromJust();
+  }
+  return headers;
+}
+
+v8::Local<v8::Value> GetResponseHeaders(v8::Isolate* isolate,
+                                        const WebRequestDetails& details) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> headers = v8::Object::New(isolate);
+  const net::HttpResponseHeaders* response_headers =
+      details.GetResponseHeaders();
+  size_t iter = 0;
+  std::string key;
+  std::string value;
+  while (response_headers->EnumerateHeaderLines(&iter, &key, &value)) {
+    v8::Local<v8::String> name = mate::StringToV8(isolate, key);
+    v8::Local<v8::Value> values;
+    if (headers->Get(context, name).ToLocal(&values) && values->IsArray()) {
+      v8::Local<v8::Array> list = v8::Local<v8::Array>::Cast(values);
+      list->Set(context, list->Length(),
+                mate::StringToV8(isolate, value)).FromJust();
+    } else {
+      v8::Local<v8::Array> list = v8::Array::New(isolate, 1);
+      list->Set(context, 0, mate::StringToV8(isolate, value)).FromJust();
+      headers->Set(context, name, list).FromJust();
+    }
+  }
+  return headers;
+}
+
+v8::Local<v8::Value> GetStatusLine(v8::Isolate* isolate,
+                                   const WebRequestDetails& details) {
+  return mate::StringToV8(isolate,
+                          details.GetResponseHeaders()->GetStatusLine());
+}
+
+v8::Local<v8::Value> GetStatusCode(v8::Isolate* isolate,
+                                   const WebRequestDetails& details) {
+  return v8::Integer::New(isolate,
+                          details.GetResponseHeaders()->response_code());
+}
+
+v8::Local<v8::Value> GetRedirectURL(v8::Isolate* isolate,
+                                    const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, details.redirect_url.spec());
+}
+
+v8::Local<v8::Value> GetError(v8::Isolate* isolate,
+                              const WebRequestDetails& details) {
+  return mate::StringToV8(isolate, net::ErrorToString(details.net_error));
+}
+
+v8::Local<v8::Value> GetTabIdField(v8::Isolate* isolate,
+                                   const WebRequestDetails& details) {
+  return mate::ConvertToV8(isolate, GetTabId(details.frame_tree_node_id,
+                                             details.render_frame_id,
+                                             details.render_process_id));
+}
+
+void SetLazy(v8::Local<v8::Context> context,
+             v8::Local<v8::Object> object,
+             const char* name,
+             v8::AccessorNameGetterCallback getter,
+             v8::Local<v8::Value> data) {
+  object->SetLazyDataProperty(
+      context, mate::StringToSymbol(context->GetIsolate(), name), getter,
+      data).FromJust();
+}
+
+void Set(v8::Local<v8::Context> context,
+         v8::Local<v8::Object> object,
+         const char* name,
+         v8::Local<v8::Value> value) {
+  object->Set(context, mate::StringToSymbol(context->GetIsolate(), name),
+              value).FromJust();
+}
+
+v8::Local<v8::Object> CreateDetailsObject(
+    v8::Isolate* isolate,
+    const scoped_refptr<WebRequestDetails>& details) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> object = v8::Object::New(isolate);
+  // Deletes itself when |object| is garbage collected.
+  new DetailsHolder(isolate, object, details);
+  v8::Local<v8::External> data = v8::External::New(isolate, details.get());
+
+  // Same order as the properties used to be filled in.
+  SetLazy(context, object, "method", GetLazyField<GetMethod>, data);
+  SetLazy(context, object, "url", GetLazyField<GetURL>, data);
+  SetLazy(context, object, "referrer", GetLazyField<GetReferrer>, data);
+  if (details->upload_data)
+    SetLazy(context, object, "uploadData",
+            GetLazyField<GetUploadDataField>, data);
+  Set(context, object, "id",
+      v8::Number::New(isolate, static_cast<double>(details->id)));
+  Set(context, object, "timestamp",
+      v8::Number::New(isolate, details->timestamp));
+  SetLazy(context, object, "firstPartyUrl",
+          GetLazyField<GetFirstPartyURL>, data);
+  Set(context, object, "resourceType",
+      mate::StringToSymbol(isolate, details->resource_type));
+  if (details->has_ip) {
+    SetLazy(context, object, "ip", GetLazyField<GetIP>, data);
+    if (details->port >= 0)
+      Set(context, object, "port", v8::Integer::New(isolate, details->port));
+  }
+  if (details->request_headers)
+    SetLazy(context, object, "requestHeaders",
+            GetLazyField<GetRequestHeaders>, data);
+  if (details->has_response_headers) {
+    SetLazy(context, object, "responseHeaders",
+            GetLazyField<GetResponseHeaders>, data);
+    SetLazy(context, object, "statusLine", GetLazyField<GetStatusLine>, data);
+    SetLazy(context, object, "statusCode", GetLazyField<GetStatusCode>, data);
+  }
+  if (details->has_redirect_url)
+    SetLazy(context, object, "redirectURL",
+            GetLazyField<GetRedirectURL>, data);
+  if (details->has_from_cache)
+    Set(context, object, "fromCache",
+        v8::Boolean::New(isolate, details->from_cache));
+  if (details->has_error)
+    SetLazy(context, object, "error", GetLazyField<GetError>, data);
+  SetLazy(context, object, extensions::tabs_constants::kTabIdKey,
+          GetLazyField<GetTabIdField>, data);
+  return object;
+}
+
+}  // namespace
+
+WebRequestDetails::WebRequestDetails(net::URLRequest* request)
+    : id(request->identifier()),
+      method(request->method()),
+      referrer(request->referrer()),
+      timestamp(base::Time::Now().ToDoubleT() * 1000),
+      first_party_url(request->site_for_cookies().spec()),
+      resource_type("other"),
+      has_ip(false),
+      port(-1),
+      frame_tree_node_id(-1),
+      render_frame_id(-1),
+      render_process_id(-1),
+      has_response_headers(false),
+      has_redirect_url(false),
+      has_from_cache(false),
+      from_cache(false),
+      has_error(false),
+      net_error(net::OK) {
+  if (!request->url_chain().empty())
+    url = request->url().spec();
+
+  std::unique_ptr<base::ListValue> list(new base::ListValue);
+  GetUploadData(list.get(), request);
+  if (!list->empty())
+    upload_data = std::move(list);
+
+  auto info = content::ResourceRequestInfo::ForRequest(request);
+  if (info) {
+    resource_type = ResourceTypeToString(info->GetResourceType());
+    frame_tree_node_id = info->GetFrameTreeNodeId();
+  }
+
+  net::IPEndPoint endpoint;
+  if (request->GetRemoteEndpoint(&endpoint)) {
+    has_ip = true;
+    ip = endpoint.ToStringWithoutPort();
+    port = endpoint.port();
+  }
+
+  GetRenderFrameIdAndProcessId(request, &render_frame_id, &render_process_id);
+}
+
+WebRequestDetails::~WebRequestDetails() {
+}
+
+const net::HttpResponseHeaders* WebRequestDetails::GetResponseHeaders() const {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (!response_headers_)
+    response_headers_ = new net::HttpResponseHeaders(raw_response_headers);
+  return response_headers_.get();
+}
+
+}  // namespace atom
+
+namespace mate {
+
+// static
+v8::Local<v8::Value> Converter<scoped_refptr<atom::WebRequestDetails>>::ToV8(
+    v8::Isolate* isolate,
+    const scoped_refptr<atom::WebRequestDetails>& details) {
+  return atom::CreateDetailsObject(isolate, details);
+}
+
+}  // namespace mate
@@ -0,0 +1,91 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
+#define ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
+
+#include <memory>
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "native_mate/converter.h"
+#include "net/http/http_request_headers.h"
+#include "url/gurl.h"
+
+namespace base {
+class ListValue;
+}
+
+namespace net {
+class HttpResponseHeaders;
+class URLRequest;
+}
+
+namespace atom {
+
+// Snapshot of a request for the webRequest listeners.
+//
+// It is taken on the IO thread with as few copies as possible and handed to
+// the UI thread, where the details object seen by JS builds each property the
+// first time it is read. Most listeners only look at a couple of fields, so
+// the headers are neither parsed nor converted for them.
+struct WebRequestDetails
+    : public base::RefCountedThreadSafe<WebRequestDetails> {
+  explicit WebRequestDetails(net::URLRequest* request);
+
+  // Returns the parsed response headers, only valid on the UI thread.
+  const net::HttpResponseHeaders* GetResponseHeaders() const;
+
+  uint64_t id;
+  std::string method;
+  std::string url;
+  std::string referrer;
+  std::unique_ptr<base::ListValue> upload_data;
+  double timestamp;
+  std::string first_party_url;
+  const char* resource_type;
+
+  bool has_ip;
+  std::string ip;
+  int port;
+
+  // Used to find the tab of the request on the UI thread.
+  int frame_tree_node_id;
+  int render_frame_id;
+  int render_process_id;
+
+  // Set depending on the event.
+  std::unique_ptr<net::HttpRequestHeaders> request_headers;
+  bool has_response_headers;
+  std::string raw_response_headers;
+  bool has_redirect_url;
+  GURL redirect_url;
+  bool has_from_cache;
+  bool from_cache;
+  bool has_error;
+  int net_error;
+
+ private:
+  friend class base::RefCountedThreadSafe<WebRequestDetails>;
+  ~WebRequestDetails();
+
+  mutable scoped_refptr<net::HttpResponseHeaders> response_headers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestDetails);
+};
+
+}  // namespace atom
+
+namespace mate {
+
+template<>
+struct Converter<scoped_refptr<atom::WebRequestDetails>> {
+  static v8::Local<v8::Value> ToV8(
+      v8::Isolate* isolate,
+      const scoped_refptr<atom::WebRequestDetails>& details);
+};
+
+}  // namespace mate
+
+#endif  // ATOM_BROWSER_NET_WEB_REQUEST_DETAILS_H_
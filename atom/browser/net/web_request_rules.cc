@@ -0,0 +1,172 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/web_request_rules.h"
+
+#include <string.h>
+
+#include "atom/browser/net/atom_network_delegate.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/url_request/url_request.h"
+#include "url/url_constants.h"
+
+namespace atom {
+
+namespace {
+
+// The names returned by ResourceTypeToString.
+const char* const kResourceTypeNames[] = {
+  "mainFrame",
+  "subFrame",
+  "stylesheet",
+  "script",
+  "image",
+  "object",
+  "xhr",
+  "other",
+};
+
+uint32_t ResourceTypeBitForRequest(net::URLRequest* request) {
+  auto* info = content::ResourceRequestInfo::ForRequest(request);
+  const char* name =
+      info ? ResourceTypeToString(info->GetResourceType()) : "other";
+  for (size_t i = 0; i < arraysize(kResourceTypeNames); ++i) {
+    if (strcmp(name, kResourceTypeNames[i]) == 0)
+      return 1u << i;
+  }
+  return 0;
+}
+
+}  // namespace
+
+WebRequestRule::WebRequestRule() : action(MODIFY_HEADERS), resource_types(0) {
+}
+
+WebRequestRule::WebRequestRule(const WebRequestRule& other) = default;
+
+WebRequestRule::~WebRequestRule() {
+}
+
+// static
+uint32_t WebRequestRule::ResourceTypeBit(const std::string& name) {
+  for (size_t i = 0; i < arraysize(kResourceTypeNames); ++i) {
+    if (name == kResourceTypeNames[i])
+      return 1u << i;
+  }
+  return 0;
+}
+
+WebRequestRules::WebRequestRules()
+    : has_request_header_rules_(false),
+      has_response_header_rules_(false) {
+}
+
+WebRequestRules::~WebRequestRules() {
+}
+
+void WebRequestRules::SetRules(const std::vector<WebRequestRule>& rules) {
+  rules_ = rules;
+  has_request_header_rules_ = false;
+  has_response_header_rules_ = false;
+  for (const auto& rule : rules_) {
+    has_request_header_rules_ |= !rule.set_request_headers.empty() ||
+                                 !rule.remove_request_headers.empty();
+    has_response_header_rules_ |= !rule.set_response_headers.empty() ||
+                                  !rule.remove_response_headers.empty();
+  }
+}
+
+bool WebRequestRules::Matches(const WebRequestRule& rule,
+                              net::URLRequest* request) const {
+  if (rule.resource_types &&
+      !(rule.resource_types & ResourceTypeBitForRequest(request)))
+    return false;
+  return rule.urls.MatchesURL(request->url());
+}
+
+int WebRequestRules::OnBeforeURLRequest(net::URLRequest* request,
+                                        GURL* new_url) const {
+  for (const auto& rule : rules_) {
+    if (rule.action == WebRequestRule::MODIFY_HEADERS ||
+        !Matches(rule, request))
+      continue;
+
+    switch (rule.action) {
+      case WebRequestRule::BLOCK:
+        return net::ERR_BLOCKED_BY_CLIENT;
+      case WebRequestRule::REDIRECT:
+        // Don't redirect a request that is already at its target.
+        if (rule.redirect_url == request->url())
+          continue;
+        *new_url = rule.redirect_url;
+        return net::OK;
+      case WebRequestRule::UPGRADE_SCHEME: {
+        const GURL& url = request->url();
+        const char* scheme = nullptr;
+        if (url.SchemeIs(url::kHttpScheme))
+          scheme = url::kHttpsScheme;
+        else if (url.SchemeIs(url::kWsScheme))
+          scheme = url::kWssScheme;
+        else
+          continue;
+        GURL::Replacements replacements;
+        replacements.SetSchemeStr(scheme);
+        *new_url = url.ReplaceComponents(replacements);
+        return net::OK;
+      }
+      case WebRequestRule::MODIFY_HEADERS:
+        break;
+    }
+  }
+  return net::OK;
+}
+
+void WebRequestRules::OnBeforeStartTransaction(
+    net::URLRequest* request,
+    net::HttpRequestHeaders* headers) const {
+  if (!has_request_header_rules_)
+    return;
+
+  for (const auto& rule : rules_) {
+    if ((rule.set_request_headers.empty() &&
+         rule.remove_request_headers.empty()) ||
+        !Matches(rule, request))
+      continue;
+
+    for (const auto& name : rule.remove_request_headers)
+      headers->RemoveHeader(name);
+    for (const auto& header : rule.set_request_headers)
+      headers->SetHeader(header.first, header.second);
+  }
+}
+
+void WebRequestRules::OnHeadersReceived(
+    net::URLRequest* request,
+    const net::HttpResponseHeaders* original,
+    scoped_refptr<net::HttpResponseHeaders>* override) const {
+  if (!has_response_header_rules_ || !original)
+    return;
+
+  for (const auto& rule : rules_) {
+    if ((rule.set_response_headers.empty() &&
+         rule.remove_response_headers.empty()) ||
+        !Matches(rule, request))
+      continue;
+
+    if (!override->get())
+      *override = new net::HttpResponseHeaders(original->raw_headers());
+
+    for (const auto& name : rule.remove_response_headers)
+      (*override)->RemoveHeader(name);
+    for (const auto& header : rule.set_response_headers) {
+      (*override)->RemoveHeader(header.first);
+      (*override)->AddHeader(header.first + ": " + header.second);
+    }
+  }
+}
+
+}  // namespace atom
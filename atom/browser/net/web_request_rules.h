@@ -0,0 +1,95 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
+#define ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "base/memory/ref_counted.h"
+#include "url/gurl.h"
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+class URLRequest;
+}
+
+namespace atom {
+
+// A static webRequest decision that can be made without asking JS.
+struct WebRequestRule {
+  enum Action {
+    // Cancel the request.
+    BLOCK,
+    // Redirect the request to |redirect_url|.
+    REDIRECT,
+    // Redirect http: and ws: requests to https: and wss:.
+    UPGRADE_SCHEME,
+    // Only apply the header modifications.
+    MODIFY_HEADERS,
+  };
+
+  WebRequestRule();
+  WebRequestRule(const WebRequestRule& other);
+  ~WebRequestRule();
+
+  // Parses a resourceType name as reported in webRequest details and returns
+  // its bit in |resource_types|, or 0 if unknown.
+  static uint32_t ResourceTypeBit(const std::string& name);
+
+  Action action;
+  URLPatternMatcher urls;
+  // Bit set of ResourceTypeBit() values, 0 matches every type.
+  uint32_t resource_types;
+  GURL redirect_url;
+
+  std::map<std::string, std::string> set_request_headers;
+  std::vector<std::string> remove_request_headers;
+  std::map<std::string, std::string> set_response_headers;
+  std::vector<std::string> remove_response_headers;
+};
+
+// The declarative rules of a session, evaluated on the IO thread.
+//
+// Block, redirect and upgrade rules are tried in order and the first match
+// wins. Header modifications of every matching rule are applied, in order.
+class WebRequestRules {
+ public:
+  WebRequestRules();
+  ~WebRequestRules();
+
+  void SetRules(const std::vector<WebRequestRule>& rules);
+  bool empty() const { return rules_.empty(); }
+
+  // Returns net::ERR_BLOCKED_BY_CLIENT for blocked requests, otherwise
+  // net::OK with |new_url| set when the request is redirected.
+  int OnBeforeURLRequest(net::URLRequest* request, GURL* new_url) const;
+
+  void OnBeforeStartTransaction(net::URLRequest* request,
+                                net::HttpRequestHeaders* headers) const;
+
+  // Sets |override| to a modified copy of |original| when a rule changes the
+  // response headers.
+  void OnHeadersReceived(
+      net::URLRequest* request,
+      const net::HttpResponseHeaders* original,
+      scoped_refptr<net::HttpResponseHeaders>* override) const;
+
+ private:
+  bool Matches(const WebRequestRule& rule, net::URLRequest* request) const;
+
+  std::vector<WebRequestRule> rules_;
+  bool has_request_header_rules_;
+  bool has_response_header_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestRules);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_WEB_REQUEST_RULES_H_
@@ -4,6 +4,9 @@
 
 // Multiply-included file, no traditional include guard.
 
+#include <string>
+#include <vector>
+
 #include "base/strings/string16.h"
 #include "base/memory/shared_memory.h"
 #include "base/values.h"
@@ -23,12 +26,22 @@ IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message,
 IPC_SYNC_MESSAGE_ROUTED2_1(AtomViewHostMsg_Message_Sync,
                            base::string16 /* channel */,
                            base::ListValue /* arguments */,
-                           base::string16 /* result (in JSON) */)
+                           std::vector<uint8_t> /* result (cloned) */)
 
 IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Shared,
                     base::string16 /* channel */,
                     base::SharedMemoryHandle /* arguments */)
 
+// The renderer is done reading a pooled segment, see shared_memory_pool.h.
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Shared_Ack,
+                    base::string16 /* channel */,
+                    uint32_t /* segment id */)
+
+// Arguments in the v8::ValueSerializer wire format, see structured_clone.h.
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Cloned,
+                    base::string16 /* channel */,
+                    std::vector<uint8_t> /* arguments */)
+
 IPC_MESSAGE_ROUTED2(AtomViewMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
@@ -37,11 +50,30 @@ IPC_MESSAGE_ROUTED2(AtomViewMsg_Message_Shared,
                     base::string16 /* channel */,
                     base::SharedMemoryHandle /* arguments */)
 
+// A value in a pooled segment that must be acknowledged once it is read.
+IPC_MESSAGE_ROUTED3(AtomViewMsg_Message_Shared_Pooled,
+                    base::string16 /* channel */,
+                    base::SharedMemoryHandle /* read-only segment */,
+                    uint32_t /* segment id */)
+
+IPC_MESSAGE_ROUTED2(AtomViewMsg_Message_Cloned,
+                    base::string16 /* channel */,
+                    std::vector<uint8_t> /* arguments */)
+
 // Update renderer process preferences.
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdatePreferences, base::ListValue)
 
-// Update renderer content settings
-IPC_MESSAGE_CONTROL1(AtomMsg_UpdateContentSettings, base::DictionaryValue)
+// Replace renderer content settings with a pickled DictionaryValue
+IPC_MESSAGE_CONTROL3(AtomMsg_UpdateContentSettings,
+                     base::SharedMemoryHandle /* read-only snapshot */,
+                     uint32_t /* snapshot size */,
+                     uint32_t /* version */)
+
+// Update renderer content settings on top of the previous version
+IPC_MESSAGE_CONTROL3(AtomMsg_UpdateContentSettingsDelta,
+                     uint32_t /* version */,
+                     base::DictionaryValue /* changed content types */,
+                     std::vector<std::string> /* removed content types */)
 
 // Update renderer content settings
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdateWebKitPrefs, content::WebPreferences)
@@ -9,6 +9,7 @@
 #include "atom_natives.h"  // NOLINT: This file is generated with coffee2c.
 
 #include "atom/common/asar/archive.h"
+#include "atom/common/asar/asar_util.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/node_includes.h"
@@ -153,11 +154,29 @@ void InitAsarSupport(v8::Isolate* isolate,
   }
 }
 
+// Returns the counters of the native archive cache.
+v8::Local<v8::Value> GetArchiveCacheStats(v8::Isolate* isolate) {
+  asar::ArchiveCacheStats stats = asar::GetAsarArchiveCacheStats();
+  mate::Dictionary dict(isolate, v8::Object::New(isolate));
+  dict.Set("hits", static_cast<double>(stats.hits));
+  dict.Set("misses", static_cast<double>(stats.misses));
+  dict.Set("opens", static_cast<double>(stats.opens));
+  dict.Set("evictions", static_cast<double>(stats.evictions));
+  dict.Set("size", static_cast<double>(stats.size));
+  return dict.GetHandle();
+}
+
+void SetArchiveCacheLimit(uint32_t limit) {
+  asar::SetAsarArchiveCacheLimit(limit);
+}
+
 void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
   dict.SetMethod("createArchive", &Archive::Create);
   dict.SetMethod("initAsarSupport", &InitAsarSupport);
+  dict.SetMethod("getArchiveCacheStats", &GetArchiveCacheStats);
+  dict.SetMethod("setArchiveCacheLimit", &SetArchiveCacheLimit);
 }
 
 }  // namespace
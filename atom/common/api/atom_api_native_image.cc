@@ -2,6 +2,7 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -9,17 +10,21 @@
 
 #include "atom/common/api/atom_api_native_image.h"
 
+#include "atom/common/api/locker.h"
 #include "atom/common/asar/asar_util.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/native_mate_converters/gfx_converter.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
 #include "base/base64.h"
 #include "base/files/file_util.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_util.h"
+#include "base/task_scheduler/post_task.h"
 #include "native_mate/dictionary.h"
 #include "native_mate/object_template_builder.h"
 #include "net/base/data_url.h"
+#include "skia/ext/image_operations.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "ui/base/layout.h"
 #include "ui/gfx/codec/jpeg_codec.h"
@@ -99,6 +104,15 @@ bool AddImageSkiaRep(gfx::ImageSkia* image,
 bool AddImageSkiaRep(gfx::ImageSkia* image,
                      const base::FilePath& path,
                      double scale_factor) {
+  // Images packed in an archive are decoded straight from its mapping.
+  std::shared_ptr<asar::Archive> archive;
+  base::span<const uint8_t> mapped;
+  {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    if (asar::GetAsarFileData(path, &archive, &mapped))
+      return AddImageSkiaRep(image, mapped.data(), mapped.size(), scale_factor);
+  }
+
   std::string file_contents;
   {
     base::ThreadRestrictions::ScopedAllowIO allow_io;
@@ -183,6 +197,144 @@ bool ReadImageSkiaFromICO(gfx::ImageSkia* image, HICON icon) {
 void Noop(char*, void*) {
 }
 
+void DeleteVector(char*, void* hint) {
+  delete static_cast<std::vector<unsigned char>*>(hint);
+}
+
+// Hands |data| to a Buffer without copying it.
+v8::Local<v8::Value> VectorToBuffer(v8::Isolate* isolate,
+                                    std::vector<unsigned char> data) {
+  if (data.empty())
+    return node::Buffer::New(isolate, 0).ToLocalChecked();
+
+  auto* owned = new std::vector<unsigned char>(std::move(data));
+  return node::Buffer::New(isolate,
+                           reinterpret_cast<char*>(owned->data()),
+                           owned->size(),
+                           &DeleteVector,
+                           owned).ToLocalChecked();
+}
+
+const char kDataURLPrefix[] = "data:image/png;base64,";
+
+struct EncodeOptions {
+  EncodeOptions() : jpeg(false), quality(90), data_url(false) {}
+
+  bool jpeg;
+  int quality;
+  bool data_url;
+  // Largest size of the output, empty dimensions are not limited.
+  gfx::Size max_size;
+};
+
+struct EncodeResult {
+  EncodeResult() : success(false) {}
+
+  bool success;
+  std::vector<unsigned char> data;
+  std::string data_url;
+};
+
+// Runs on a worker, |bitmap| shares its pixels with the image.
+std::unique_ptr<EncodeResult> EncodeBitmap(const SkBitmap& bitmap,
+                                           const EncodeOptions& options) {
+  std::unique_ptr<EncodeResult> result(new EncodeResult);
+
+  SkBitmap source = bitmap;
+  int max_width = options.max_size.width() > 0 ?
+      options.max_size.width() : source.width();
+  int max_height = options.max_size.height() > 0 ?
+      options.max_size.height() : source.height();
+  if (source.width() > max_width || source.height() > max_height) {
+    // Keep the aspect ratio, images are never scaled up.
+    double scale = std::min(
+        static_cast<double>(max_width) / source.width(),
+        static_cast<double>(max_height) / source.height());
+    int width = std::max(1, static_cast<int>(source.width() * scale));
+    int height = std::max(1, static_cast<int>(source.height() * scale));
+    source = skia::ImageOperations::Resize(
+        source, skia::ImageOperations::RESIZE_BETTER, width, height);
+  }
+
+  if (options.jpeg && !options.data_url) {
+    result->success =
+        gfx::JPEGCodec::Encode(source, options.quality, &result->data);
+  } else {
+    result->success =
+        gfx::PNGCodec::EncodeBGRASkBitmap(source, false, &result->data);
+  }
+
+  if (result->success && options.data_url) {
+    base::Base64Encode(
+        base::StringPiece(reinterpret_cast<const char*>(result->data.data()),
+                          result->data.size()),
+        &result->data_url);
+    result->data_url.insert(0, kDataURLPrefix);
+    result->data.clear();
+  }
+  return result;
+}
+
+// Keeps the JavaScript side of an encode() call alive until it is done.
+class EncodeRequest {
+ public:
+  EncodeRequest(v8::Isolate* isolate,
+                v8::Local<v8::Function> callback,
+                v8::Local<v8::Value> buffer)
+      : isolate_(isolate), callback_(isolate, callback) {
+    if (node::Buffer::HasInstance(buffer))
+      buffer_.Reset(isolate, buffer.As<v8::Object>());
+  }
+
+  static void OnEncoded(std::unique_ptr<EncodeRequest> request,
+                        std::unique_ptr<EncodeResult> result) {
+    request->Run(result.get());
+  }
+
+ private:
+  void Run(EncodeResult* result) {
+    mate::Locker locker(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::MicrotasksScope script_scope(isolate_,
+                                     v8::MicrotasksScope::kRunMicrotasks);
+    v8::Local<v8::Function> callback = callback_.Get(isolate_);
+    v8::Local<v8::Context> context = callback->CreationContext();
+    v8::Context::Scope context_scope(context);
+
+    v8::Local<v8::Value> args[] = {
+      v8::Null(isolate_), v8::Undefined(isolate_), v8::Undefined(isolate_)
+    };
+    if (!result->success) {
+      args[0] = v8::Exception::Error(
+          mate::StringToV8(isolate_, "Failed to encode image"));
+    } else if (!result->data_url.empty()) {
+      args[1] = mate::StringToV8(isolate_, result->data_url);
+    } else {
+      size_t size = result->data.size();
+      v8::Local<v8::Object> buffer;
+      if (!buffer_.IsEmpty())
+        buffer = buffer_.Get(isolate_);
+      // The output buffer is only reused when the image fits into it.
+      if (!buffer.IsEmpty() && node::Buffer::Length(buffer) >= size) {
+        memcpy(node::Buffer::Data(buffer), result->data.data(), size);
+        args[1] = buffer;
+      } else {
+        args[1] = VectorToBuffer(isolate_, std::move(result->data));
+      }
+      args[2] = v8::Number::New(isolate_, static_cast<double>(size));
+    }
+
+    callback->Call(context, v8::Undefined(isolate_), arraysize(args), args)
+        .IsEmpty();
+  }
+
+  v8::Isolate* isolate_;
+  v8::Global<v8::Function> callback_;
+  v8::Global<v8::Object> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(EncodeRequest);
+};
+
 }  // namespace
 
 NativeImage::NativeImage(v8::Isolate* isolate, const gfx::Image& image)
@@ -224,6 +376,8 @@ HICON NativeImage::GetHICON(int size) {
 #endif
 
 v8::Local<v8::Value> NativeImage::ToPNG(v8::Isolate* isolate) {
+  // The PNG bytes are cached by the image and shared with toDataURL(), so JS
+  // gets a copy it is free to modify.
   scoped_refptr<base::RefCountedMemory> png = image_.As1xPNGBytes();
   return node::Buffer::Copy(isolate,
                             reinterpret_cast<const char*>(png->front()),
@@ -241,21 +395,57 @@ v8::Local<v8::Value> NativeImage::ToBitmap(v8::Isolate* isolate) {
 v8::Local<v8::Value> NativeImage::ToJPEG(v8::Isolate* isolate, int quality) {
   std::vector<unsigned char> output;
   gfx::JPEG1xEncodedDataFromImage(image_, quality, &output);
-  return node::Buffer::Copy(
-      isolate,
-      reinterpret_cast<const char*>(&output.front()),
-      static_cast<size_t>(output.size())).ToLocalChecked();
+  return VectorToBuffer(isolate, std::move(output));
 }
 
 std::string NativeImage::ToDataURL() {
   scoped_refptr<base::RefCountedMemory> png = image_.As1xPNGBytes();
   std::string data_url;
-  data_url.insert(data_url.end(), png->front(), png->front() + png->size());
-  base::Base64Encode(data_url, &data_url);
-  data_url.insert(0, "data:image/png;base64,");
+  base::Base64Encode(
+      base::StringPiece(png->front_as<char>(), png->size()), &data_url);
+  data_url.insert(0, kDataURLPrefix);
   return data_url;
 }
 
+void NativeImage::Encode(mate::Arguments* args) {
+  mate::Dictionary options;
+  v8::Local<v8::Function> callback;
+  if (!args->GetNext(&options) || !args->GetNext(&callback)) {
+    args->ThrowError("Expected options and a callback");
+    return;
+  }
+
+  EncodeOptions encode_options;
+  std::string format;
+  if (options.Get("format", &format)) {
+    if (format == "jpeg") {
+      encode_options.jpeg = true;
+    } else if (format != "png") {
+      args->ThrowError("format must be \"png\" or \"jpeg\"");
+      return;
+    }
+  }
+  options.Get("quality", &encode_options.quality);
+  options.Get("dataURL", &encode_options.data_url);
+  int width = 0, height = 0;
+  options.Get("width", &width);
+  options.Get("height", &height);
+  encode_options.max_size = gfx::Size(std::max(width, 0), std::max(height, 0));
+
+  v8::Local<v8::Value> buffer;
+  options.Get("buffer", &buffer);
+  std::unique_ptr<EncodeRequest> request(
+      new EncodeRequest(args->isolate(), callback, buffer));
+
+  // Copying the bitmap only takes a reference to its pixels.
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE,
+      {base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      base::BindOnce(&EncodeBitmap, image_.AsBitmap(), encode_options),
+      base::BindOnce(&EncodeRequest::OnEncoded, std::move(request)));
+}
+
 v8::Local<v8::Value> NativeImage::GetBitmap(v8::Isolate* isolate) {
   const SkBitmap* bitmap = image_.ToSkBitmap();
   SkPixelRef* ref = bitmap->pixelRef();
@@ -384,6 +574,7 @@ void NativeImage::BuildPrototype(
       .SetMethod("getBitmap", &NativeImage::GetBitmap)
       .SetMethod("getNativeHandle", &NativeImage::GetNativeHandle)
       .SetMethod("toDataURL", &NativeImage::ToDataURL)
+      .SetMethod("encode", &NativeImage::Encode)
       .SetMethod("isEmpty", &NativeImage::IsEmpty)
       .SetMethod("getSize", &NativeImage::GetSize)
       .SetMethod("setTemplateImage", &NativeImage::SetTemplateImage)
@@ -76,6 +76,8 @@ class NativeImage : public mate::Wrappable<NativeImage> {
     v8::Isolate* isolate,
     mate::Arguments* args);
   std::string ToDataURL();
+  // Encodes the image on a worker and passes the result to a callback.
+  void Encode(mate::Arguments* args);
   bool IsEmpty();
   gfx::Size GetSize();
 
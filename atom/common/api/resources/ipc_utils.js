@@ -12,6 +12,12 @@ if (!ipcRenderer) {
     return ipc.send('ipc-message', $Array.slice(args))
   }
 
+  ipcRenderer.sendCloned = function () {
+    var args
+    args = 1 <= arguments.length ? $Array.slice(arguments, 0) : []
+    return ipc.sendCloned('ipc-message', args)
+  }
+
   ipcRenderer.sendShared = function (channel, shared) {
     return ipc.sendShared(channel, shared)
   }
@@ -19,7 +25,7 @@ if (!ipcRenderer) {
   ipcRenderer.sendSync = function () {
     var args
     args = 1 <= arguments.length ? $Array.slice(arguments, 0) : []
-    return $JSON.parse(ipc.sendSync('ipc-message-sync', $Array.slice(args)))
+    return ipc.sendSync('ipc-message-sync', $Array.slice(args))
   }
 
   ipcRenderer.sendToHost = function () {
@@ -55,6 +61,7 @@ exports.$set('on', ipcRenderer.on.bind(ipcRenderer))
 exports.$set('once', ipcRenderer.once.bind(ipcRenderer))
 exports.$set('send', ipcRenderer.send.bind(ipcRenderer))
 exports.$set('sendSync', ipcRenderer.sendSync.bind(ipcRenderer))
+exports.$set('sendCloned', ipcRenderer.sendCloned.bind(ipcRenderer))
 exports.$set('sendShared', ipcRenderer.sendShared.bind(ipcRenderer))
 exports.$set('sendToHost', ipcRenderer.sendToHost.bind(ipcRenderer))
 exports.$set('emit', ipcRenderer.emit.bind(ipcRenderer))
@@ -0,0 +1,40 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/common/api/structured_clone.h"
+
+#include <stdlib.h>
+
+#include <utility>
+
+namespace atom {
+
+bool SerializeV8Value(v8::Isolate* isolate,
+                      v8::Local<v8::Value> value,
+                      std::vector<uint8_t>* out) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::ValueSerializer serializer(isolate);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(context, value).FromMaybe(false))
+    return false;
+
+  std::pair<uint8_t*, size_t> buf = serializer.Release();
+  out->assign(buf.first, buf.first + buf.second);
+  free(buf.first);
+  return true;
+}
+
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        const std::vector<uint8_t>& data) {
+  v8::EscapableHandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::ValueDeserializer deserializer(isolate, data.data(), data.size());
+  v8::Local<v8::Value> value;
+  if (!deserializer.ReadHeader(context).FromMaybe(false) ||
+      !deserializer.ReadValue(context).ToLocal(&value))
+    return v8::Local<v8::Value>();
+  return handle_scope.Escape(value);
+}
+
+}  // namespace atom
@@ -0,0 +1,33 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_API_STRUCTURED_CLONE_H_
+#define ATOM_COMMON_API_STRUCTURED_CLONE_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "v8/include/v8.h"
+
+namespace atom {
+
+// Writes |value| in the v8::ValueSerializer wire format, the same format
+// used by postMessage. Unlike the base::Value conversion this keeps Maps,
+// Sets, Dates, RegExps, typed arrays and cyclic references intact.
+//
+// Returns false if |value| can't be cloned, in which case the serializer's
+// exception is left pending on |isolate|.
+bool SerializeV8Value(v8::Isolate* isolate,
+                      v8::Local<v8::Value> value,
+                      std::vector<uint8_t>* out);
+
+// Reads a value written by SerializeV8Value() in the current context.
+// Returns an empty handle if |data| is malformed.
+v8::Local<v8::Value> DeserializeV8Value(v8::Isolate* isolate,
+                                        const std::vector<uint8_t>& data);
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_API_STRUCTURED_CLONE_H_
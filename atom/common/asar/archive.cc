@@ -4,17 +4,24 @@
 
 #include "atom/common/asar/archive.h"
 
+#include <inttypes.h>
+
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atom/common/asar/archive_index.h"
+#include "atom/common/asar/extraction_cache.h"
 #include "atom/common/asar/scoped_temporary_file.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/pickle.h"
+#include "base/sha1.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "base/task_scheduler/post_task.h"
 #include "base/values.h"
 
@@ -29,90 +36,31 @@ namespace asar {
 namespace {
 
 #if defined(OS_WIN)
-const char kSeparators[] = "\\/";
-#else
-const char kSeparators[] = "/";
-#endif
-
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out);
-
-// Gets the "files" from "dir".
-bool GetFilesNode(const base::DictionaryValue* root,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  // Test for symbol linked directory.
-  std::string link;
-  if (dir->GetStringWithoutPathExpansion("link", &link)) {
-    const base::DictionaryValue* linked_node = nullptr;
-    if (!GetNodeFromPath(link, root, &linked_node))
-      return false;
-    dir = linked_node;
-  }
-
-  return dir->GetDictionaryWithoutPathExpansion("files", out);
-}
-
-// Gets sub-file "name" from "dir".
-bool GetChildNode(const base::DictionaryValue* root,
-                  const std::string& name,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  if (name == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* files = nullptr;
-  return GetFilesNode(root, dir, &files) &&
-         files->GetDictionaryWithoutPathExpansion(name, out);
+std::string ToIndexPath(const base::FilePath& path) {
+  return path.AsUTF8Unsafe();
 }
-
-// Gets the node of "path" from "root".
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out) {
-  if (path == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* dir = root;
-  for (size_t delimiter_position = path.find_first_of(kSeparators);
-       delimiter_position != std::string::npos;
-       delimiter_position = path.find_first_of(kSeparators)) {
-    const base::DictionaryValue* child = nullptr;
-    if (!GetChildNode(root, path.substr(0, delimiter_position), dir, &child))
-      return false;
-
-    dir = child;
-    path.erase(0, delimiter_position + 1);
-  }
-
-  return GetChildNode(root, path, dir, out);
+#else
+// Paths are already UTF-8, so lookups don't need to copy them.
+const std::string& ToIndexPath(const base::FilePath& path) {
+  return path.value();
 }
+#endif
 
 bool FillFileInfoWithNode(Archive::FileInfo* info,
                           uint32_t header_size,
-                          const base::DictionaryValue* node) {
-  int size;
-  if (!node->GetInteger("size", &size))
+                          const ArchiveIndex::Node* node) {
+  if (node->flags & (ArchiveIndex::kDirectory | ArchiveIndex::kLink |
+                     ArchiveIndex::kInvalid))
     return false;
-  info->size = static_cast<uint32_t>(size);
+  info->size = node->size;
 
-  if (node->GetBoolean("unpacked", &info->unpacked) && info->unpacked)
+  if (node->flags & ArchiveIndex::kUnpacked) {
+    info->unpacked = true;
     return true;
+  }
 
-  std::string offset;
-  if (!node->GetString("offset", &offset))
-    return false;
-  if (!base::StringToUint64(offset, &info->offset))
-    return false;
-  info->offset += header_size;
-
-  node->GetBoolean("executable", &info->executable);
-
+  info->offset = node->offset() + header_size;
+  info->executable = (node->flags & ArchiveIndex::kExecutable) != 0;
   return true;
 }
 
@@ -153,86 +101,95 @@ bool Archive::Init() {
     return false;
   }
 
-  std::vector<char> buf;
-  int len;
-
-  buf.resize(8);
+  // The whole archive is mapped once; the header, the index and every packed
+  // file are then read straight out of the mapping.
+  mapping_.reset(new base::MemoryMappedFile);
   {
     base::ThreadRestrictions::ScopedAllowIO allow_io;
-    len = file_.ReadAtCurrentPos(buf.data(), buf.size());
-  }
-  if (len != static_cast<int>(buf.size())) {
-    PLOG(ERROR) << "Failed to read header size from " << path_.value();
-    return false;
+    if (!mapping_->Initialize(file_.Duplicate())) {
+      PLOG(ERROR) << "Failed to map " << path_.value();
+      mapping_.reset();
+      return false;
+    }
   }
 
+  const char* data = reinterpret_cast<const char*>(mapping_->data());
   uint32_t size;
-  if (!base::PickleIterator(base::Pickle(buf.data(), buf.size())).ReadUInt32(
-          &size)) {
+  if (mapping_->length() < 8 ||
+      !base::PickleIterator(base::Pickle(data, 8)).ReadUInt32(&size)) {
     LOG(ERROR) << "Failed to parse header size from " << path_.value();
     return false;
   }
 
-  buf.resize(size);
-  {
-    base::ThreadRestrictions::ScopedAllowIO allow_io;
-    len = file_.ReadAtCurrentPos(buf.data(), buf.size());
-  }
-  if (len != static_cast<int>(buf.size())) {
-    PLOG(ERROR) << "Failed to read header from " << path_.value();
+  if (size > mapping_->length() - 8) {
+    LOG(ERROR) << "Failed to read header from " << path_.value();
     return false;
   }
 
-  std::string header;
-  if (!base::PickleIterator(base::Pickle(buf.data(), buf.size())).ReadString(
-        &header)) {
+  // The pickle wraps the mapping without copying it.
+  base::Pickle pickle(data + 8, size);
+  base::PickleIterator iter(pickle);
+  base::StringPiece header;
+  if (!iter.ReadStringPiece(&header)) {
     LOG(ERROR) << "Failed to parse header from " << path_.value();
     return false;
   }
 
-  std::string error;
-  base::JSONReader reader;
-  std::unique_ptr<base::Value> value(reader.ReadToValue(header));
-  if (!value || !value->is_dict()) {
-    LOG(ERROR) << "Failed to parse header: " << error;
-    return false;
+  // Newer archives carry a precompiled index right after the JSON, which
+  // older readers ignore.
+  const char* index_data;
+  int index_size;
+  if (iter.ReadData(&index_data, &index_size))
+    index_ = ArchiveIndex::CreateFromBytes(index_data, index_size);
+
+  if (!index_) {
+    std::unique_ptr<base::Value> value = base::JSONReader::Read(header);
+    base::DictionaryValue* dict = nullptr;
+    if (!value || !value->GetAsDictionary(&dict)) {
+      LOG(ERROR) << "Failed to parse header from " << path_.value();
+      return false;
+    }
+    index_ = ArchiveIndex::CreateFromJSON(*dict);
+    if (!index_) {
+      LOG(ERROR) << "Invalid header in " << path_.value();
+      return false;
+    }
   }
 
   header_size_ = 8 + size;
-  header_.reset(static_cast<base::DictionaryValue*>(value.release()));
   return true;
 }
 
 bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(ToIndexPath(path));
+  if (!node)
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link))
-    return GetFileInfo(base::FilePath::FromUTF8Unsafe(link), info);
+  node = index_->ResolveLink(node);
+  if (!node)
+    return false;
 
   return FillFileInfoWithNode(info, header_size_, node);
 }
 
 bool Archive::Stat(const base::FilePath& path, Stats* stats) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(ToIndexPath(path));
+  if (!node)
     return false;
 
-  if (node->HasKey("link")) {
+  if (node->is_link()) {
     stats->is_file = false;
     stats->is_link = true;
     return true;
   }
 
-  if (node->HasKey("files")) {
+  if (node->is_directory()) {
     stats->is_file = false;
     stats->is_directory = true;
     return true;
@@ -243,36 +200,36 @@ bool Archive::Stat(const base::FilePath& path, Stats* stats) {
 
 bool Archive::Readdir(const base::FilePath& path,
                       std::vector<base::FilePath>* list) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(ToIndexPath(path));
+  if (!node)
     return false;
 
-  const base::DictionaryValue* files;
-  if (!GetFilesNode(header_.get(), node, &files))
+  const ArchiveIndex::Node* dir = index_->ResolveDirectory(node);
+  if (!dir)
     return false;
 
-  base::DictionaryValue::Iterator iter(*files);
-  while (!iter.IsAtEnd()) {
-    list->push_back(base::FilePath::FromUTF8Unsafe(iter.key()));
-    iter.Advance();
+  const ArchiveIndex::Node* children = index_->children(dir);
+  list->reserve(list->size() + dir->size);
+  for (uint32_t i = 0; i < dir->size; ++i) {
+    list->push_back(
+        base::FilePath::FromUTF8Unsafe(index_->name(&children[i])));
   }
   return true;
 }
 
 bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
-  if (!header_)
+  if (!index_)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  const ArchiveIndex::Node* node = index_->Lookup(ToIndexPath(path));
+  if (!node)
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link)) {
-    *realpath = base::FilePath::FromUTF8Unsafe(link);
+  if (node->is_link()) {
+    *realpath = base::FilePath::FromUTF8Unsafe(index_->link(node));
     return true;
   }
 
@@ -280,10 +237,24 @@ bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
   return true;
 }
 
+bool Archive::GetFileData(const FileInfo& info,
+                          base::span<const uint8_t>* data) const {
+  if (!mapping_ || info.unpacked)
+    return false;
+
+  if (info.offset > mapping_->length() ||
+      info.size > mapping_->length() - info.offset)
+    return false;
+
+  *data = base::make_span(mapping_->data() + info.offset, info.size);
+  return true;
+}
+
 bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
+  base::AutoLock auto_lock(external_files_lock_);
   auto it = external_files_.find(path.value());
   if (it != external_files_.end()) {
-    *out = it->second->path();
+    *out = it->second;
     return true;
   }
 
@@ -296,23 +267,60 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
     return true;
   }
 
-  std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
-  base::FilePath::StringType ext = path.Extension();
-  if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size))
+  base::span<const uint8_t> data;
+  if (!GetFileData(info, &data))
     return false;
 
+  base::FilePath::StringType ext = path.Extension();
+  std::string key = base::StringPrintf(
+      "%s-%" PRIx64 "-%" PRIx32, GetIdentity().c_str(), info.offset,
+      info.size);
+  if (!GetCachedExtraction(key, ext, data, info.executable, out)) {
+    std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
+    if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size))
+      return false;
+
 #if defined(OS_POSIX)
-  if (info.executable) {
-    // chmod a+x temp_file;
-    base::SetPosixFilePermissions(temp_file->path(), 0755);
-  }
+    if (info.executable) {
+      // chmod a+x temp_file;
+      base::SetPosixFilePermissions(temp_file->path(), 0755);
+    }
 #endif
 
-  *out = temp_file->path();
-  external_files_[path.value()] = std::move(temp_file);
+    *out = temp_file->path();
+    temp_files_.push_back(std::move(temp_file));
+  }
+
+  external_files_[path.value()] = *out;
   return true;
 }
 
+const std::string& Archive::GetIdentity() {
+  if (identity_.empty()) {
+    // The header pins the layout of every entry, the size and modification
+    // time catch rebuilds that keep the same layout.
+    unsigned char hash[base::kSHA1Length];
+    base::SHA1HashBytes(mapping_->data(), header_size_, hash);
+
+    base::File::Info file_info;
+    {
+      base::ThreadRestrictions::ScopedAllowIO allow_io;
+      file_.GetInfo(&file_info);
+    }
+    identity_ = base::StringPrintf(
+        "%s-%" PRIx64 "-%" PRIx64, base::HexEncode(hash, 8).c_str(),
+        static_cast<uint64_t>(mapping_->length()),
+        static_cast<uint64_t>(file_info.last_modified.ToInternalValue()));
+  }
+  return identity_;
+}
+
+std::vector<std::unique_ptr<ScopedTemporaryFile>>
+Archive::TakeTemporaryFiles() {
+  base::AutoLock auto_lock(external_files_lock_);
+  return std::move(temp_files_);
+}
+
 int Archive::GetFD() const {
   return fd_;
 }
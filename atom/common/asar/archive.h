@@ -6,18 +6,22 @@
 #define ATOM_COMMON_ASAR_ARCHIVE_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/synchronization/lock.h"
 
 namespace base {
-class DictionaryValue;
+class MemoryMappedFile;
 }
 
 namespace asar {
 
+class ArchiveIndex;
 class ScopedTemporaryFile;
 
 // This class represents an asar package, and provides methods to read
@@ -57,27 +61,51 @@ class Archive {
   // Fs.realpath(path).
   bool Realpath(const base::FilePath& path, base::FilePath* realpath);
 
-  // Copy the file into a temporary file, and return the new path.
+  // Points |data| at the contents of a packed file inside the archive-wide
+  // read-only mapping. The data stays valid for the lifetime of the archive.
+  // Reading it may block on disk like a file read, so it must only be read
+  // on threads that allow blocking IO, never on the IO thread.
+  bool GetFileData(const FileInfo& info,
+                   base::span<const uint8_t>* data) const;
+
+  // Copy the file out of the archive, and return the new path. Copies live in
+  // the shared extraction cache and are reused across processes and launches.
   // For unpacked file, this method will return its real path.
   bool CopyFileOut(const base::FilePath& path, base::FilePath* out);
 
+  // Hands the temporary copies made so far over to the caller, so that the
+  // paths returned for them stay valid after the archive is gone.
+  std::vector<std::unique_ptr<ScopedTemporaryFile>> TakeTemporaryFiles();
+
   // Returns the file's fd.
   int GetFD() const;
 
   base::FilePath path() const { return path_; }
-  base::DictionaryValue* header() const { return header_.get(); }
 
  private:
+  const std::string& GetIdentity();
+
   base::FilePath path_;
   base::File file_;
   int fd_;
   uint32_t header_size_;
-  std::unique_ptr<base::DictionaryValue> header_;
 
-  // Cached external temporary files.
-  std::unordered_map
-    <base::FilePath::StringType, std::unique_ptr<ScopedTemporaryFile>>
+  // Read-only mapping of the whole archive. An embedded index points
+  // into it.
+  std::unique_ptr<base::MemoryMappedFile> mapping_;
+  std::unique_ptr<ArchiveIndex> index_;
+
+  // Identifies this build of the archive in the extraction cache, computed
+  // on first use.
+  std::string identity_;
+
+  // Paths handed out by CopyFileOut, guarded by |external_files_lock_| since
+  // archives are shared between threads.
+  base::Lock external_files_lock_;
+  std::unordered_map<base::FilePath::StringType, base::FilePath>
       external_files_;
+  // Temporary copies used when the extraction cache is unavailable.
+  std::vector<std::unique_ptr<ScopedTemporaryFile>> temp_files_;
 
   DISALLOW_COPY_AND_ASSIGN(Archive);
 };
@@ -0,0 +1,326 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/archive_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+
+namespace asar {
+
+namespace {
+
+#if defined(OS_WIN)
+const char kSeparators[] = "\\/";
+#else
+const char kSeparators[] = "/";
+#endif
+
+// Links may point at other links, but never deeper than this.
+const int kMaxLinkDepth = 32;
+
+struct IndexHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t node_count;
+  uint32_t string_table_size;
+};
+
+static_assert(sizeof(IndexHeader) == 4 * sizeof(uint32_t),
+              "IndexHeader must be tightly packed");
+static_assert(sizeof(ArchiveIndex::Node) == 6 * sizeof(uint32_t),
+              "ArchiveIndex::Node must be tightly packed");
+
+// Builds the flat representation of a JSON header.
+class IndexCompiler {
+ public:
+  IndexCompiler() {}
+
+  bool Compile(const base::DictionaryValue& header,
+               std::vector<uint32_t>* out) {
+    const base::DictionaryValue* files = nullptr;
+    if (!header.GetDictionaryWithoutPathExpansion("files", &files))
+      return false;
+
+    nodes_.emplace_back();
+    nodes_[0].flags = ArchiveIndex::kDirectory;
+    nodes_[0].name_offset = Intern(std::string());
+
+    // Breadth first, so that the children of each directory are adjacent.
+    std::deque<std::pair<const base::DictionaryValue*, uint32_t>> pending;
+    pending.emplace_back(files, 0);
+    while (!pending.empty()) {
+      const base::DictionaryValue* dir = pending.front().first;
+      uint32_t dir_index = pending.front().second;
+      pending.pop_front();
+
+      std::vector<std::pair<std::string, const base::DictionaryValue*>>
+          entries;
+      for (base::DictionaryValue::Iterator it(*dir); !it.IsAtEnd();
+           it.Advance()) {
+        const base::DictionaryValue* entry = nullptr;
+        if (it.value().GetAsDictionary(&entry))
+          entries.emplace_back(it.key(), entry);
+      }
+      std::sort(entries.begin(), entries.end());
+
+      uint32_t first = static_cast<uint32_t>(nodes_.size());
+      nodes_[dir_index].offset_low = first;
+      nodes_[dir_index].size = static_cast<uint32_t>(entries.size());
+      nodes_.resize(nodes_.size() + entries.size());
+
+      for (size_t i = 0; i < entries.size(); ++i) {
+        uint32_t index = first + static_cast<uint32_t>(i);
+        const base::DictionaryValue* child_files =
+            FillNode(entries[i].first, *entries[i].second, &nodes_[index]);
+        if (child_files)
+          pending.emplace_back(child_files, index);
+      }
+    }
+
+    while (strings_.size() % sizeof(uint32_t))
+      strings_.push_back('\0');
+
+    IndexHeader index_header;
+    index_header.magic = ArchiveIndex::kMagic;
+    index_header.version = ArchiveIndex::kVersion;
+    index_header.node_count = static_cast<uint32_t>(nodes_.size());
+    index_header.string_table_size = static_cast<uint32_t>(strings_.size());
+
+    size_t bytes = sizeof(index_header) +
+        nodes_.size() * sizeof(ArchiveIndex::Node) + strings_.size();
+    out->resize(bytes / sizeof(uint32_t));
+    char* dest = reinterpret_cast<char*>(out->data());
+    memcpy(dest, &index_header, sizeof(index_header));
+    dest += sizeof(index_header);
+    memcpy(dest, nodes_.data(), nodes_.size() * sizeof(ArchiveIndex::Node));
+    dest += nodes_.size() * sizeof(ArchiveIndex::Node);
+    memcpy(dest, strings_.data(), strings_.size());
+    return true;
+  }
+
+ private:
+  // Fills |node| from |entry| and returns its "files" when it is a directory.
+  const base::DictionaryValue* FillNode(const std::string& name,
+                                        const base::DictionaryValue& entry,
+                                        ArchiveIndex::Node* node) {
+    node->name_offset = Intern(name);
+    node->name_size = static_cast<uint32_t>(name.size());
+
+    std::string link;
+    if (entry.GetStringWithoutPathExpansion("link", &link)) {
+      node->flags = ArchiveIndex::kLink;
+      node->offset_low = Intern(link);
+      node->size = static_cast<uint32_t>(link.size());
+      return nullptr;
+    }
+
+    const base::DictionaryValue* files = nullptr;
+    if (entry.GetDictionaryWithoutPathExpansion("files", &files)) {
+      node->flags = ArchiveIndex::kDirectory;
+      return files;
+    }
+
+    int size;
+    if (!entry.GetIntegerWithoutPathExpansion("size", &size)) {
+      node->flags = ArchiveIndex::kInvalid;
+      return nullptr;
+    }
+    node->size = static_cast<uint32_t>(size);
+
+    bool unpacked = false;
+    if (entry.GetBooleanWithoutPathExpansion("unpacked", &unpacked) &&
+        unpacked) {
+      node->flags = ArchiveIndex::kUnpacked;
+      return nullptr;
+    }
+
+    std::string offset_string;
+    uint64_t offset;
+    if (!entry.GetStringWithoutPathExpansion("offset", &offset_string) ||
+        !base::StringToUint64(offset_string, &offset)) {
+      node->flags = ArchiveIndex::kInvalid;
+      return nullptr;
+    }
+    node->offset_low = static_cast<uint32_t>(offset);
+    node->offset_high = static_cast<uint32_t>(offset >> 32);
+
+    bool executable = false;
+    if (entry.GetBooleanWithoutPathExpansion("executable", &executable) &&
+        executable)
+      node->flags |= ArchiveIndex::kExecutable;
+    return nullptr;
+  }
+
+  uint32_t Intern(const std::string& str) {
+    auto it = interned_.find(str);
+    if (it != interned_.end())
+      return it->second;
+    uint32_t offset = static_cast<uint32_t>(strings_.size());
+    strings_.append(str);
+    interned_[str] = offset;
+    return offset;
+  }
+
+  std::vector<ArchiveIndex::Node> nodes_;
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> interned_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexCompiler);
+};
+
+}  // namespace
+
+ArchiveIndex::ArchiveIndex()
+    : nodes_(nullptr), node_count_(0), strings_(nullptr), strings_size_(0) {
+}
+
+ArchiveIndex::~ArchiveIndex() {
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::CreateFromJSON(
+    const base::DictionaryValue& header) {
+  std::unique_ptr<ArchiveIndex> index(new ArchiveIndex);
+  IndexCompiler compiler;
+  if (!compiler.Compile(header, &index->storage_))
+    return nullptr;
+  if (!index->Attach(reinterpret_cast<const char*>(index->storage_.data()),
+                     index->storage_.size() * sizeof(uint32_t)))
+    return nullptr;
+  return index;
+}
+
+// static
+std::unique_ptr<ArchiveIndex> ArchiveIndex::CreateFromBytes(const char* data,
+                                                            size_t size) {
+  std::unique_ptr<ArchiveIndex> index(new ArchiveIndex);
+  if (!index->Attach(data, size))
+    return nullptr;
+  return index;
+}
+
+bool ArchiveIndex::Attach(const char* data, size_t size) {
+  if (reinterpret_cast<uintptr_t>(data) % sizeof(uint32_t) ||
+      size < sizeof(IndexHeader))
+    return false;
+
+  const IndexHeader* header = reinterpret_cast<const IndexHeader*>(data);
+  if (header->magic != kMagic || header->version != kVersion ||
+      header->node_count == 0)
+    return false;
+
+  uint64_t expected = sizeof(IndexHeader) +
+      static_cast<uint64_t>(header->node_count) * sizeof(Node) +
+      header->string_table_size;
+  if (expected > size)
+    return false;
+
+  nodes_ = reinterpret_cast<const Node*>(data + sizeof(IndexHeader));
+  node_count_ = header->node_count;
+  strings_ = data + sizeof(IndexHeader) + node_count_ * sizeof(Node);
+  strings_size_ = header->string_table_size;
+
+  // Validate everything once so that lookups can trust the buffer.
+  for (uint32_t i = 0; i < node_count_; ++i) {
+    const Node& node = nodes_[i];
+    if (static_cast<uint64_t>(node.name_offset) + node.name_size >
+        strings_size_)
+      return false;
+    // Directories and links both use |size| and |offset_low|, so a node
+    // can't be both.
+    if (node.is_directory() && node.is_link())
+      return false;
+    if (node.is_directory()) {
+      // Children always come after their parent, which rules out cycles.
+      if (node.size && (node.offset_low <= i ||
+          static_cast<uint64_t>(node.offset_low) + node.size > node_count_))
+        return false;
+    }
+    if (node.is_link()) {
+      if (static_cast<uint64_t>(node.offset_low) + node.size > strings_size_)
+        return false;
+    }
+  }
+  return nodes_[0].is_directory();
+}
+
+const ArchiveIndex::Node* ArchiveIndex::Lookup(base::StringPiece path) const {
+  return Lookup(path, 0);
+}
+
+const ArchiveIndex::Node* ArchiveIndex::ResolveDirectory(
+    const Node* node) const {
+  return ResolveDirectory(node, 0);
+}
+
+const ArchiveIndex::Node* ArchiveIndex::ResolveLink(const Node* node) const {
+  for (int depth = 0; node && node->is_link(); ++depth) {
+    if (depth == kMaxLinkDepth)
+      return nullptr;
+    node = Lookup(link(node), depth + 1);
+  }
+  return node;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::Lookup(base::StringPiece path,
+                                               int depth) const {
+  const Node* node = root();
+  if (path.empty())
+    return node;
+
+  for (size_t pos = path.find_first_of(kSeparators);
+       pos != base::StringPiece::npos;
+       pos = path.find_first_of(kSeparators)) {
+    node = GetChild(node, path.substr(0, pos), depth);
+    if (!node)
+      return nullptr;
+    path.remove_prefix(pos + 1);
+  }
+
+  return GetChild(node, path, depth);
+}
+
+const ArchiveIndex::Node* ArchiveIndex::ResolveDirectory(const Node* node,
+                                                         int depth) const {
+  if (node->is_link()) {
+    if (depth == kMaxLinkDepth)
+      return nullptr;
+    node = Lookup(link(node), depth + 1);
+    if (!node)
+      return nullptr;
+  }
+  return node->is_directory() ? node : nullptr;
+}
+
+const ArchiveIndex::Node* ArchiveIndex::GetChild(const Node* dir,
+                                                 base::StringPiece component,
+                                                 int depth) const {
+  if (component.empty())
+    return root();
+
+  dir = ResolveDirectory(dir, depth);
+  if (!dir || !dir->size)
+    return nullptr;
+
+  const Node* first = children(dir);
+  const Node* last = first + dir->size;
+  const Node* it = std::lower_bound(
+      first, last, component, [this](const Node& node, base::StringPiece key) {
+        return name(&node) < key;
+      });
+  if (it == last || name(it) != component)
+    return nullptr;
+  return it;
+}
+
+}  // namespace asar
@@ -0,0 +1,128 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+#define ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace asar {
+
+// A flat, read-only index of an asar header.
+//
+// The index is a single contiguous buffer of little-endian uint32 fields:
+//
+//   IndexHeader
+//   Node[node_count]
+//   char string_table[string_table_size]
+//
+// Node 0 is the root directory. The children of every directory are stored
+// contiguously and sorted by name, so a lookup is one binary search per path
+// component. Names and link targets are interned in the string table. The
+// buffer is either compiled from the JSON header or embedded after the JSON
+// string in the header pickle (see script/embed-asar-index.py), in which case
+// it is used in place from the mapped archive.
+class ArchiveIndex {
+ public:
+  enum NodeFlags : uint32_t {
+    kDirectory = 1 << 0,
+    kLink = 1 << 1,
+    kUnpacked = 1 << 2,
+    kExecutable = 1 << 3,
+    // The JSON entry had no usable "size" or "offset".
+    kInvalid = 1 << 4,
+  };
+
+  struct Node {
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t flags;
+    // Files: data size. Directories: child count. Links: target size.
+    uint32_t size;
+    // Files: data offset relative to the end of the header. Directories:
+    // index of the first child. Links: string table offset of the target.
+    uint32_t offset_low;
+    uint32_t offset_high;
+
+    uint64_t offset() const {
+      return (static_cast<uint64_t>(offset_high) << 32) | offset_low;
+    }
+    bool is_directory() const { return flags & kDirectory; }
+    bool is_link() const { return flags & kLink; }
+  };
+
+  static const uint32_t kMagic = 0x58495341;  // "ASIX"
+  static const uint32_t kVersion = 1;
+
+  // Compiles |header| into a newly allocated index.
+  static std::unique_ptr<ArchiveIndex> CreateFromJSON(
+      const base::DictionaryValue& header);
+
+  // Wraps an existing buffer without copying it. |data| must be 4-byte
+  // aligned and outlive the returned index. Returns nullptr when the buffer
+  // is not a well-formed index.
+  static std::unique_ptr<ArchiveIndex> CreateFromBytes(const char* data,
+                                                       size_t size);
+
+  ~ArchiveIndex();
+
+  // Finds the node of the '/'-separated |path|, following directory links on
+  // the way. Does not allocate.
+  const Node* Lookup(base::StringPiece path) const;
+
+  // Resolves |node| to the directory whose children should be listed,
+  // following a link if necessary.
+  const Node* ResolveDirectory(const Node* node) const;
+
+  // Follows |node| through links until it reaches a file or directory.
+  const Node* ResolveLink(const Node* node) const;
+
+  const Node* root() const { return nodes_; }
+  const Node* children(const Node* dir) const {
+    return nodes_ + dir->offset_low;
+  }
+  base::StringPiece name(const Node* node) const {
+    return base::StringPiece(strings_ + node->name_offset, node->name_size);
+  }
+  base::StringPiece link(const Node* node) const {
+    return base::StringPiece(strings_ + node->offset_low, node->size);
+  }
+
+ private:
+  ArchiveIndex();
+
+  bool Attach(const char* data, size_t size);
+
+  // |depth| counts the links followed so far, to stop on link cycles.
+  const Node* Lookup(base::StringPiece path, int depth) const;
+  const Node* ResolveDirectory(const Node* node, int depth) const;
+  const Node* GetChild(const Node* dir,
+                       base::StringPiece component,
+                       int depth) const;
+
+  // Owns the buffer when compiled from JSON, empty otherwise.
+  std::vector<uint32_t> storage_;
+
+  const Node* nodes_;
+  uint32_t node_count_;
+  const char* strings_;
+  uint32_t strings_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveIndex);
+};
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_ARCHIVE_INDEX_H_
@@ -4,37 +4,190 @@
 
 #include "atom/common/asar/asar_util.h"
 
-#include <map>
+#include <atomic>
+#include <limits>
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "atom/common/asar/archive.h"
+#include "atom/common/asar/scoped_temporary_file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/lazy_instance.h"
-#include "base/stl_util.h"
+#include "base/synchronization/lock.h"
 
 namespace asar {
 
 namespace {
 
-// The global instance of ArchiveMap, will be destroyed on exit.
-typedef std::map<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
-static base::LazyInstance<ArchiveMap>::DestructorAtExit g_archive_map =
-    LAZY_INSTANCE_INITIALIZER;
-
 const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
 
-}  // namespace
+// Archives opened by GetOrCreateAsarArchive, shared by every thread of the
+// process. Paths are spread over independently locked shards so that workers,
+// the IO thread and the main thread rarely contend, and a hit costs a single
+// hash lookup. When a limit is set the least recently used archives of all
+// shards are evicted until the total fits; callers still holding an evicted
+// archive keep it alive, and its temporary copies outlive it.
+class ArchiveRegistry {
+ public:
+  ArchiveRegistry() : limit_(0), count_(0), clock_(0) {}
 
-std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
-  ArchiveMap& archive_map = *g_archive_map.Pointer();
-  if (!ContainsKey(archive_map, path)) {
+  std::shared_ptr<Archive> GetOrCreate(const base::FilePath& path) {
+    Shard& shard = GetShard(path);
+    {
+      base::AutoLock auto_lock(shard.lock);
+      auto it = shard.archives.find(path.value());
+      if (it != shard.archives.end()) {
+        ++shard.stats.hits;
+        it->second->last_used = ++clock_;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->archive;
+      }
+      ++shard.stats.misses;
+    }
+
+    // Open outside of the lock, Init() reads from disk.
     std::shared_ptr<Archive> archive(new Archive(path));
     if (!archive->Init())
       return nullptr;
-    archive_map[path] = archive;
+
+    {
+      base::AutoLock auto_lock(shard.lock);
+      ++shard.stats.opens;
+      auto inserted = shard.archives.emplace(path.value(), shard.lru.end());
+      if (!inserted.second) {
+        // Another thread opened it in the meantime.
+        return inserted.first->second->archive;
+      }
+      shard.lru.push_front({path.value(), archive, ++clock_});
+      inserted.first->second = shard.lru.begin();
+      ++count_;
+    }
+    Trim();
+    return archive;
   }
-  return archive_map[path];
+
+  void SetLimit(size_t limit) {
+    limit_ = limit;
+    Trim();
+  }
+
+  ArchiveCacheStats GetStats() {
+    ArchiveCacheStats total;
+    for (Shard& shard : shards_) {
+      base::AutoLock auto_lock(shard.lock);
+      total.hits += shard.stats.hits;
+      total.misses += shard.stats.misses;
+      total.opens += shard.stats.opens;
+      total.evictions += shard.stats.evictions;
+      total.size += shard.archives.size();
+    }
+    return total;
+  }
+
+ private:
+  static const size_t kShardCount = 8;
+
+  struct Entry {
+    base::FilePath::StringType path;
+    std::shared_ptr<Archive> archive;
+    // Value of |clock_| at the last lookup.
+    uint64_t last_used;
+  };
+
+  // Most recently used first.
+  typedef std::list<Entry> ArchiveList;
+
+  struct Shard {
+    base::Lock lock;
+    ArchiveList lru;
+    std::unordered_map<base::FilePath::StringType, ArchiveList::iterator>
+        archives;
+    ArchiveCacheStats stats;
+  };
+
+  Shard& GetShard(const base::FilePath& path) {
+    return shards_[std::hash<base::FilePath::StringType>()(path.value()) %
+                   kShardCount];
+  }
+
+  // Evicts the least recently used archive of all shards until at most
+  // |limit_| are cached. Must be called without any shard lock held.
+  void Trim() {
+    while (limit_ && count_ > limit_) {
+      Shard* oldest = nullptr;
+      uint64_t oldest_use = std::numeric_limits<uint64_t>::max();
+      for (Shard& shard : shards_) {
+        base::AutoLock auto_lock(shard.lock);
+        if (!shard.lru.empty() && shard.lru.back().last_used < oldest_use) {
+          oldest = &shard;
+          oldest_use = shard.lru.back().last_used;
+        }
+      }
+      if (!oldest)
+        return;
+
+      std::shared_ptr<Archive> evicted;
+      {
+        base::AutoLock auto_lock(oldest->lock);
+        // Another thread may have emptied it in the meantime.
+        if (oldest->lru.empty())
+          continue;
+        evicted = std::move(oldest->lru.back().archive);
+        oldest->archives.erase(oldest->lru.back().path);
+        oldest->lru.pop_back();
+        ++oldest->stats.evictions;
+        --count_;
+      }
+
+      // Paths copied out of the archive may still be in use.
+      std::vector<std::unique_ptr<ScopedTemporaryFile>> temp_files =
+          evicted->TakeTemporaryFiles();
+      base::AutoLock auto_lock(temp_files_lock_);
+      for (auto& temp_file : temp_files)
+        temp_files_.push_back(std::move(temp_file));
+    }
+  }
+
+  Shard shards_[kShardCount];
+
+  // 0 means unlimited.
+  std::atomic<size_t> limit_;
+  // Archives cached in all shards.
+  std::atomic<size_t> count_;
+  // Orders lookups across shards.
+  std::atomic<uint64_t> clock_;
+
+  // Temporary copies of evicted archives, deleted on exit.
+  base::Lock temp_files_lock_;
+  std::vector<std::unique_ptr<ScopedTemporaryFile>> temp_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveRegistry);
+};
+
+// The global registry, will be destroyed on exit.
+base::LazyInstance<ArchiveRegistry>::DestructorAtExit g_archive_registry =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+ArchiveCacheStats::ArchiveCacheStats()
+    : hits(0), misses(0), opens(0), evictions(0), size(0) {
+}
+
+std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
+  return g_archive_registry.Get().GetOrCreate(path);
+}
+
+void SetAsarArchiveCacheLimit(size_t limit) {
+  g_archive_registry.Get().SetLimit(limit);
+}
+
+ArchiveCacheStats GetAsarArchiveCacheStats() {
+  return g_archive_registry.Get().GetStats();
 }
 
 bool GetAsarArchivePath(const base::FilePath& full_path,
@@ -79,13 +232,32 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
     return base::ReadFileToString(real_path, contents);
   }
 
-  base::File src(asar_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!src.IsValid())
+  base::span<const uint8_t> data;
+  if (!archive->GetFileData(info, &data))
+    return false;
+
+  contents->assign(reinterpret_cast<const char*>(data.data()), data.size());
+  return true;
+}
+
+bool GetAsarFileData(const base::FilePath& path,
+                     std::shared_ptr<Archive>* archive,
+                     base::span<const uint8_t>* data) {
+  base::FilePath asar_path, relative_path;
+  if (!GetAsarArchivePath(path, &asar_path, &relative_path))
+    return false;
+
+  std::shared_ptr<Archive> result = GetOrCreateAsarArchive(asar_path);
+  if (!result)
+    return false;
+
+  Archive::FileInfo info;
+  if (!result->GetFileInfo(relative_path, &info) ||
+      !result->GetFileData(info, data))
     return false;
 
-  contents->resize(info.size);
-  return static_cast<int>(info.size) == src.Read(
-      info.offset, const_cast<char*>(contents->data()), contents->size());
+  *archive = std::move(result);
+  return true;
 }
 
 }  // namespace asar
@@ -5,9 +5,14 @@
 #ifndef ATOM_COMMON_ASAR_ASAR_UTIL_H_
 #define ATOM_COMMON_ASAR_ASAR_UTIL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 
+#include "base/containers/span.h"
+
 namespace base {
 class FilePath;
 }
@@ -16,9 +21,31 @@ namespace asar {
 
 class Archive;
 
-// Gets or creates a new Archive from the path.
+struct ArchiveCacheStats {
+  ArchiveCacheStats();
+
+  // Lookups that found an open archive.
+  uint64_t hits;
+  // Lookups that had to open the archive.
+  uint64_t misses;
+  // Archives successfully opened.
+  uint64_t opens;
+  // Archives dropped to stay under the cache limit.
+  uint64_t evictions;
+  // Archives currently cached.
+  uint64_t size;
+};
+
+// Gets or creates a new Archive from the path. Safe to call from any thread.
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path);
 
+// Caps the total number of archives kept open by GetOrCreateAsarArchive,
+// least recently used ones are closed first. 0, the default, means no limit.
+void SetAsarArchiveCacheLimit(size_t limit);
+
+// Returns the counters of the archive cache.
+ArchiveCacheStats GetAsarArchiveCacheStats();
+
 // Separates the path to Archive out.
 bool GetAsarArchivePath(const base::FilePath& full_path,
                         base::FilePath* asar_path,
@@ -27,6 +54,14 @@ bool GetAsarArchivePath(const base::FilePath& full_path,
 // Same with base::ReadFileToString but supports asar Archive.
 bool ReadFileToString(const base::FilePath& path, std::string* contents);
 
+// Points |data| at the contents of a packed file inside its archive's mapping
+// without copying it. |archive| keeps the data alive. Reading the data blocks
+// on disk like a file read, see Archive::GetFileData. Fails for paths outside
+// of archives and for unpacked files.
+bool GetAsarFileData(const base::FilePath& path,
+                     std::shared_ptr<Archive>* archive,
+                     base::span<const uint8_t>* data);
+
 }  // namespace asar
 
 #endif  // ATOM_COMMON_ASAR_ASAR_UTIL_H_
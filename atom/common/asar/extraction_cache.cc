@@ -0,0 +1,235 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/common/asar/extraction_cache.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "base/base_paths.h"
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/lazy_instance.h"
+#include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+#include "crypto/secure_hash.h"
+#include "crypto/sha2.h"
+
+namespace asar {
+
+namespace {
+
+const base::FilePath::CharType kCacheDirName[] =
+    FILE_PATH_LITERAL("muon-asar-cache");
+
+// Upper bound for the whole cache directory.
+const int64_t kMaxCacheSize = 512 * 1024 * 1024;
+
+// Entries used more recently than this are never trimmed.
+const int kMinUnusedDays = 1;
+
+// Guards g_trimmed and g_verified.
+base::LazyInstance<base::Lock>::Leaky g_lock = LAZY_INSTANCE_INITIALIZER;
+bool g_trimmed = false;
+
+// Entries whose content this process has checked or written itself.
+base::LazyInstance<std::set<base::FilePath>>::Leaky g_verified =
+    LAZY_INSTANCE_INITIALIZER;
+
+bool GetCacheDir(base::FilePath* dir) {
+#if defined(OS_WIN)
+  int key = base::DIR_LOCAL_APP_DATA;
+#else
+  int key = base::DIR_CACHE;
+#endif
+  base::FilePath root;
+  if (!base::PathService::Get(key, &root))
+    return false;
+
+  *dir = root.Append(kCacheDirName);
+  return base::CreateDirectory(*dir);
+}
+
+bool HasSize(const base::FilePath& path, size_t size) {
+  int64_t file_size;
+  return base::GetFileSize(path, &file_size) &&
+         static_cast<uint64_t>(file_size) == size;
+}
+
+// Hashes the entry at |path| and compares it with |hash|. Anyone who can
+// write to the cache directory could have replaced it, and native modules
+// are loaded from it, so the size alone can't be trusted.
+bool HasHash(const base::FilePath& path, const std::string& hash) {
+  base::File file(path, base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if (!file.IsValid())
+    return false;
+
+  std::unique_ptr<crypto::SecureHash> sha256(
+      crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+  std::vector<char> buffer(64 * 1024);
+  int bytes_read;
+  while ((bytes_read = file.ReadAtCurrentPos(
+              buffer.data(), static_cast<int>(buffer.size()))) > 0)
+    sha256->Update(buffer.data(), bytes_read);
+  if (bytes_read < 0)
+    return false;
+
+  std::string actual(crypto::kSHA256Length, '\0');
+  sha256->Finish(&actual[0], actual.size());
+  return actual == hash;
+}
+
+bool IsVerified(const base::FilePath& path) {
+  base::AutoLock auto_lock(g_lock.Get());
+  return g_verified.Get().count(path) > 0;
+}
+
+void SetVerified(const base::FilePath& path) {
+  base::AutoLock auto_lock(g_lock.Get());
+  g_verified.Get().insert(path);
+}
+
+// Checks the content of the entry the first time this process hands it out,
+// later lookups only make sure it is still there.
+bool IsValid(const base::FilePath& path,
+             size_t size,
+             const std::string& hash) {
+  if (!HasSize(path, size))
+    return false;
+  if (IsVerified(path))
+    return true;
+  if (!HasHash(path, hash))
+    return false;
+  SetVerified(path);
+  return true;
+}
+
+// Deletes the least recently used entries until the cache fits in
+// kMaxCacheSize. Entries used recently may still be handed out to a running
+// process, so they are kept even if the cache stays larger.
+void Trim(const base::FilePath& dir) {
+  struct Entry {
+    base::Time last_used;
+    int64_t size;
+    base::FilePath path;
+  };
+
+  std::vector<Entry> entries;
+  int64_t total = 0;
+  base::FileEnumerator enumerator(dir, false, base::FileEnumerator::FILES);
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    base::FileEnumerator::FileInfo info = enumerator.GetInfo();
+    total += info.GetSize();
+    entries.push_back({info.GetLastModifiedTime(), info.GetSize(), path});
+  }
+
+  if (total <= kMaxCacheSize)
+    return;
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_used < b.last_used;
+            });
+  base::Time cutoff =
+      base::Time::Now() - base::TimeDelta::FromDays(kMinUnusedDays);
+  for (const Entry& entry : entries) {
+    if (total <= kMaxCacheSize || entry.last_used > cutoff)
+      break;
+    // Fails for files that are still loaded on Windows, which is fine.
+    if (base::DeleteFile(entry.path, false))
+      total -= entry.size;
+  }
+}
+
+// Trims the cache the first time it is used by this process, before any of
+// its entries are handed out.
+void TrimOnce(const base::FilePath& dir) {
+  base::AutoLock auto_lock(g_lock.Get());
+  if (!g_trimmed) {
+    g_trimmed = true;
+    Trim(dir);
+  }
+}
+
+}  // namespace
+
+bool GetCachedExtraction(const std::string& key,
+                         const base::FilePath::StringType& ext,
+                         base::span<const uint8_t> data,
+                         bool executable,
+                         base::FilePath* out) {
+  if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max()))
+    return false;
+
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+
+  base::FilePath dir;
+  if (!GetCacheDir(&dir))
+    return false;
+
+  // The name also carries the hash of the content, which is checked before
+  // the entry is first used.
+  std::string hash = crypto::SHA256HashString(base::StringPiece(
+      reinterpret_cast<const char*>(data.data()), data.size()));
+  std::string name =
+      key + "-" + base::ToLowerASCII(base::HexEncode(hash.data(), hash.size()));
+  base::FilePath path = dir.Append(base::FilePath::FromUTF8Unsafe(name));
+  if (!ext.empty())
+    path = path.AddExtension(ext);
+
+  TrimOnce(dir);
+
+  if (IsValid(path, data.size(), hash)) {
+    // The modification time doubles as the last use for Trim().
+    base::Time now = base::Time::Now();
+    base::TouchFile(path, now, now);
+    *out = path;
+    return true;
+  }
+
+  // Publish atomically, other processes may be looking up the same entry.
+  base::FilePath temp_path;
+  if (!base::CreateTemporaryFileInDir(dir, &temp_path))
+    return false;
+
+  int size = static_cast<int>(data.size());
+  if (base::WriteFile(temp_path, reinterpret_cast<const char*>(data.data()),
+                      size) != size) {
+    base::DeleteFile(temp_path, false);
+    return false;
+  }
+
+#if defined(OS_POSIX)
+  if (executable) {
+    // chmod a+x temp_path;
+    base::SetPosixFilePermissions(temp_path, 0755);
+  }
+#endif
+
+  // A damaged entry is replaced rather than deleted first, a process that
+  // still has it open keeps reading the old file.
+  if (base::ReplaceFile(temp_path, path, nullptr)) {
+    SetVerified(path);
+  } else {
+    base::DeleteFile(temp_path, false);
+    // Someone else may have published it first.
+    if (!IsValid(path, data.size(), hash))
+      return false;
+  }
+
+  *out = path;
+  return true;
+}
+
+}  // namespace asar
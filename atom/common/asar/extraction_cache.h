@@ -0,0 +1,38 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
+#define ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/span.h"
+#include "base/files/file_path.h"
+
+namespace asar {
+
+// Files copied out of archives are kept in a per-user cache directory so that
+// every process and every launch can reuse them instead of writing a new
+// temporary copy.
+//
+// Entries are named after |key| and the SHA-256 hash of |data|. New entries
+// are written to a temporary name and renamed into place, so concurrent
+// processes never see a partial file. An existing entry is hashed the first
+// time a process hands it out and rewritten if it doesn't match, after that
+// it is handed out without being read. The directory is trimmed, least
+// recently used first, once per process before the first entry is handed out.
+//
+// Returns false if the cache is unavailable, in which case the caller should
+// fall back to a temporary file.
+bool GetCachedExtraction(const std::string& key,
+                         const base::FilePath::StringType& ext,
+                         base::span<const uint8_t> data,
+                         bool executable,
+                         base::FilePath* out);
+
+}  // namespace asar
+
+#endif  // ATOM_COMMON_ASAR_EXTRACTION_CACHE_H_
@@ -8,6 +8,7 @@
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/atom_api_key_weak_map.h"
 #include "atom/common/api/remote_object_freer.h"
+#include "atom/common/api/structured_clone.h"
 #include "atom/common/native_mate_converters/content_converter.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
@@ -141,6 +142,23 @@ void JavascriptBindings::IPCSend(mate::Arguments* args,
     args->ThrowError("Unable to send AtomViewHostMsg_Message");
 }
 
+void JavascriptBindings::IPCSendCloned(mate::Arguments* args,
+                                       const base::string16& channel,
+                                       v8::Local<v8::Value> arguments) {
+  if (!is_valid() || !render_frame())
+    return;
+
+  std::vector<uint8_t> data;
+  if (!SerializeV8Value(args->isolate(), arguments, &data))
+    return;  // the serializer has thrown a DataCloneError
+
+  bool success = Send(new AtomViewHostMsg_Message_Cloned(
+      routing_id(), channel, data));
+
+  if (!success)
+    args->ThrowError("Unable to send AtomViewHostMsg_Message_Cloned");
+}
+
 void JavascriptBindings::IPCSendShared(mate::Arguments* args,
             const base::string16& channel,
             base::SharedMemory* shared_memory) {
@@ -162,23 +180,30 @@ void JavascriptBindings::IPCSendShared(mate::Arguments* args,
     args->ThrowError("Unable to send AtomViewHostMsg_Message_Shared");
 }
 
-base::string16 JavascriptBindings::IPCSendSync(mate::Arguments* args,
-                        const base::string16& channel,
-                        const base::ListValue& arguments) {
-  base::string16 json;
+v8::Local<v8::Value> JavascriptBindings::IPCSendSync(
+    mate::Arguments* args,
+    const base::string16& channel,
+    const base::ListValue& arguments) {
+  v8::Isolate* isolate = args->isolate();
+  std::vector<uint8_t> reply;
 
   if (!is_valid() || !render_frame()) {
-    return json;
+    return v8::Undefined(isolate);
   }
 
   IPC::SyncMessage* message = new AtomViewHostMsg_Message_Sync(
-      routing_id(), channel, arguments, &json);
+      routing_id(), channel, arguments, &reply);
   bool success = Send(message);
 
-  if (!success)
+  if (!success) {
     args->ThrowError("Unable to send AtomViewHostMsg_Message_Sync");
+    return v8::Undefined(isolate);
+  }
 
-  return json;
+  v8::Local<v8::Value> result = DeserializeV8Value(isolate, reply);
+  if (result.IsEmpty())
+    return v8::Undefined(isolate);  // the deserializer has thrown
+  return result;
 }
 
 void JavascriptBindings::GetBinding(
@@ -196,6 +221,8 @@ void JavascriptBindings::GetBinding(
       base::Unretained(this)));
   ipc.SetMethod("sendShared", base::Bind(&JavascriptBindings::IPCSendShared,
       base::Unretained(this)));
+  ipc.SetMethod("sendCloned", base::Bind(&JavascriptBindings::IPCSendCloned,
+      base::Unretained(this)));
   binding.Set("ipc", ipc.GetHandle());
 
   mate::Dictionary v8(isolate, v8::Object::New(isolate));
@@ -239,6 +266,8 @@ bool JavascriptBindings::OnMessageReceived(const IPC::Message& message) {
       context_type == Feature::BLESSED_EXTENSION_CONTEXT) {
     IPC_BEGIN_MESSAGE_MAP(JavascriptBindings, message)
       IPC_MESSAGE_HANDLER(AtomViewMsg_Message_Shared, OnSharedBrowserMessage)
+      IPC_MESSAGE_HANDLER(AtomViewMsg_Message_Shared_Pooled,
+                          OnPooledSharedBrowserMessage)
       IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
   }
@@ -246,6 +275,7 @@ bool JavascriptBindings::OnMessageReceived(const IPC::Message& message) {
 
   IPC_BEGIN_MESSAGE_MAP(JavascriptBindings, message)
     IPC_MESSAGE_HANDLER(AtomViewMsg_Message, OnBrowserMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_Message_Cloned, OnClonedBrowserMessage)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -286,6 +316,47 @@ void JavascriptBindings::OnSharedBrowserMessage(const base::string16& channel,
                                   &concatenated_args.front());
 }
 
+void JavascriptBindings::OnPooledSharedBrowserMessage(
+    const base::string16& channel,
+    const base::SharedMemoryHandle& handle,
+    uint32_t segment_id) {
+  if (!base::SharedMemory::IsHandleValid(handle)) {
+    NOTREACHED() << "Bad handle";
+    return;
+  }
+
+  if (!is_valid()) {
+    base::SharedMemory::CloseHandle(handle);
+    Send(new AtomViewHostMsg_Message_Shared_Ack(
+        routing_id(), channel, segment_id));
+    return;
+  }
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context()->v8_context());
+
+  // The browser reuses the segment once it is acknowledged, so it is read
+  // and unmapped before anything else runs.
+  v8::Local<v8::Value> value;
+  {
+    base::SharedMemory shared_memory(handle, true);
+    value = mate::ConvertToV8(isolate, &shared_memory);
+  }
+  Send(new AtomViewHostMsg_Message_Shared_Ack(
+      routing_id(), channel, segment_id));
+
+  // Insert the Event object, event.sender is ipc
+  mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
+  std::vector<v8::Local<v8::Value>> args = {
+    mate::StringToV8(isolate, channel), event.GetHandle(), value
+  };
+  context()->module_system()->CallModuleMethodSafe("ipc_utils",
+                                                   "emit",
+                                                   args.size(),
+                                                   &args.front());
+}
+
 void JavascriptBindings::OnBrowserMessage(const base::string16& channel,
                                           const base::ListValue& args) {
   if (!context()->is_valid())
@@ -317,4 +388,42 @@ void JavascriptBindings::OnBrowserMessage(const base::string16& channel,
                                   &concatenated_args.front());
 }
 
+void JavascriptBindings::OnClonedBrowserMessage(
+    const base::string16& channel,
+    const std::vector<uint8_t>& data) {
+  if (!context()->is_valid())
+    return;
+
+  auto context_type = context()->effective_context_type();
+  if (context_type == Feature::WEB_PAGE_CONTEXT)
+    return;
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context()->v8_context());
+
+  // The browser always sends the arguments as a single array.
+  v8::Local<v8::Value> array = DeserializeV8Value(isolate, data);
+  std::vector<v8::Local<v8::Value>> args_vector;
+  if (array.IsEmpty() || !mate::ConvertFromV8(isolate, array, &args_vector)) {
+    NOTREACHED() << "Malformed AtomViewMsg_Message_Cloned";
+    return;
+  }
+
+  // Insert the Event object, event.sender is ipc
+  mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
+  args_vector.insert(args_vector.begin(), event.GetHandle());
+
+  std::vector<v8::Local<v8::Value>> concatenated_args =
+        { mate::StringToV8(isolate, channel) };
+      concatenated_args.reserve(1 + args_vector.size());
+      concatenated_args.insert(concatenated_args.end(),
+                                args_vector.begin(), args_vector.end());
+
+  context()->module_system()->CallModuleMethodSafe("ipc_utils",
+                                  "emit",
+                                  concatenated_args.size(),
+                                  &concatenated_args.front());
+}
+
 }  // namespace atom
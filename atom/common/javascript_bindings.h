@@ -5,6 +5,8 @@
 #ifndef ATOM_COMMON_JAVASCRIPT_BINDINGS_H_
 #define ATOM_COMMON_JAVASCRIPT_BINDINGS_H_
 
+#include <vector>
+
 #include "content/public/renderer/render_frame_observer.h"
 #include "extensions/renderer/object_backed_native_handler.h"
 #include "extensions/renderer/script_context.h"
@@ -36,12 +38,15 @@ class JavascriptBindings : public content::RenderFrameObserver,
   void IPCSendShared(mate::Arguments* args,
             const base::string16& channel,
             base::SharedMemory* shared_memory);
-  base::string16 IPCSendSync(mate::Arguments* args,
-                        const base::string16& channel,
-                        const base::ListValue& arguments);
+  v8::Local<v8::Value> IPCSendSync(mate::Arguments* args,
+                                   const base::string16& channel,
+                                   const base::ListValue& arguments);
   void IPCSend(mate::Arguments* args,
                         const base::string16& channel,
                         const base::ListValue& arguments);
+  void IPCSendCloned(mate::Arguments* args,
+                     const base::string16& channel,
+                     v8::Local<v8::Value> arguments);
   v8::Local<v8::Value> GetHiddenValue(v8::Isolate* isolate,
                                     v8::Local<v8::String> key);
   void SetHiddenValue(v8::Isolate* isolate,
@@ -68,6 +73,11 @@ class JavascriptBindings : public content::RenderFrameObserver,
                         const base::ListValue& args);
   void OnSharedBrowserMessage(const base::string16& channel,
                               const base::SharedMemoryHandle& handle);
+  void OnPooledSharedBrowserMessage(const base::string16& channel,
+                                    const base::SharedMemoryHandle& handle,
+                                    uint32_t segment_id);
+  void OnClonedBrowserMessage(const base::string16& channel,
+                              const std::vector<uint8_t>& data);
 
   DISALLOW_COPY_AND_ASSIGN(JavascriptBindings);
 };
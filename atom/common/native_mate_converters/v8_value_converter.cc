@@ -4,14 +4,18 @@
 
 #include "atom/common/native_mate_converters/v8_value_converter.h"
 
-#include <map>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "base/logging.h"
+#include "base/strings/string_piece.h"
 #include "base/values.h"
-#include "native_mate/dictionary.h"
+#include "native_mate/converter.h"
 
 #include "atom/common/node_includes.h"
 
@@ -21,8 +25,107 @@ namespace {
 
 const int kMaxRecursionDepth = 100;
 
+// Converts |number| to an integer Value when a JS number with that value
+// would pass IsInt32(), and to a double Value otherwise.
+base::Value NumberToValue(double number) {
+  if (number >= std::numeric_limits<int32_t>::min() &&
+      number <= std::numeric_limits<int32_t>::max() &&
+      number == static_cast<int32_t>(number) &&
+      !(number == 0 && std::signbit(number)))
+    return base::Value(static_cast<int>(number));
+  return base::Value(number);
+}
+
+// Converts the elements of a typed array in bulk instead of reading them one
+// property at a time.
+template<typename T>
+base::Value TypedArrayToList(v8::Local<v8::TypedArray> array) {
+  std::vector<T> elements(array->Length());
+  array->CopyContents(elements.data(), elements.size() * sizeof(T));
+
+  base::Value::ListStorage list;
+  list.reserve(elements.size());
+  for (T element : elements)
+    list.push_back(NumberToValue(element));
+  return base::Value(std::move(list));
+}
+
+bool FromTypedArray(v8::Local<v8::Value> val, base::Value* out) {
+  v8::Local<v8::TypedArray> array = val.As<v8::TypedArray>();
+  if (val->IsInt8Array())
+    *out = TypedArrayToList<int8_t>(array);
+  else if (val->IsUint8ClampedArray())
+    *out = TypedArrayToList<uint8_t>(array);
+  else if (val->IsInt16Array())
+    *out = TypedArrayToList<int16_t>(array);
+  else if (val->IsUint16Array())
+    *out = TypedArrayToList<uint16_t>(array);
+  else if (val->IsInt32Array())
+    *out = TypedArrayToList<int32_t>(array);
+  else if (val->IsUint32Array())
+    *out = TypedArrayToList<uint32_t>(array);
+  else if (val->IsFloat32Array())
+    *out = TypedArrayToList<float>(array);
+  else if (val->IsFloat64Array())
+    *out = TypedArrayToList<double>(array);
+  else
+    return false;
+  return true;
+}
+
+// Writes |str| as UTF-8 to |out| without an intermediate buffer.
+void V8StringToUTF8(v8::Local<v8::String> str, std::string* out) {
+  int length = str->Utf8Length();
+  out->resize(length);
+  if (length)
+    str->WriteUtf8(&(*out)[0], length, nullptr,
+                   v8::String::NO_NULL_TERMINATION);
+}
+
 }  // namespace
 
+// The state of a call to ToV8Value.
+class V8ValueConverter::ToV8ValueState {
+ public:
+  explicit ToV8ValueState(v8::Isolate* isolate)
+      : isolate_(isolate), context_(isolate->GetCurrentContext()) {}
+
+  v8::Isolate* isolate() const { return isolate_; }
+  v8::Local<v8::Context> context() const { return context_; }
+
+  // The private key that marks converted objects as "simple".
+  v8::Local<v8::Private> simple_key() {
+    if (simple_key_.IsEmpty())
+      simple_key_ = v8::Private::ForApi(
+          isolate_, mate::StringToV8(isolate_, "simple"));
+    return simple_key_;
+  }
+
+  // Returns an internalized string for |key|. Dictionaries in a list usually
+  // share their keys, so each distinct key is only created once. The cache
+  // refers to the keys of the value being converted, which outlives it.
+  v8::Local<v8::String> GetKey(const std::string& key) {
+    auto it = keys_.find(key);
+    if (it != keys_.end())
+      return it->second;
+
+    v8::Local<v8::String> name = v8::String::NewFromUtf8(
+        isolate_, key.data(), v8::NewStringType::kInternalized,
+        static_cast<int>(key.size())).ToLocalChecked();
+    keys_.emplace(key, name);
+    return name;
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Local<v8::Context> context_;
+  v8::Local<v8::Private> simple_key_;
+  std::unordered_map<base::StringPiece, v8::Local<v8::String>,
+                     base::StringPieceHash> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(ToV8ValueState);
+};
+
 // The state of a call to FromV8Value.
 class V8ValueConverter::FromV8ValueState {
  public:
@@ -42,29 +145,44 @@ class V8ValueConverter::FromV8ValueState {
 
   FromV8ValueState() : max_recursion_depth_(kMaxRecursionDepth) {}
 
-  // If |handle| is not in |unique_map_|, then add it to |unique_map_| and
+  // If |handle| is not in |unique_set_|, then add it to |unique_set_| and
   // return true.
   //
   // Otherwise do nothing and return false. Here "A is unique" means that no
-  // other handle B in the map points to the same object as A. Note that A can
+  // other handle B in the set points to the same object as A. Note that A can
   // be unique even if there already is another handle with the same identity
-  // hash (key) in the map, because two objects can have the same hash.
+  // hash in the set, because two objects can have the same hash.
   bool AddToUniquenessCheck(v8::Local<v8::Object> handle) {
-    int hash;
-    auto iter = GetIteratorInMap(handle, &hash);
-    if (iter != unique_map_.end())
+    int hash = handle->GetIdentityHash();
+    size_t index = FindSlot(handle, hash);
+    if (!unique_set_[index].handle.IsEmpty())
       return false;
 
-    unique_map_.insert(std::make_pair(hash, handle));
+    unique_set_[index].hash = hash;
+    unique_set_[index].handle = handle;
     return true;
   }
 
   bool RemoveFromUniquenessCheck(v8::Local<v8::Object> handle) {
-    int unused_hash;
-    auto iter = GetIteratorInMap(handle, &unused_hash);
-    if (iter == unique_map_.end())
+    size_t index = FindSlot(handle, handle->GetIdentityHash());
+    if (unique_set_[index].handle.IsEmpty())
       return false;
-    unique_map_.erase(iter);
+
+    // Shift the following entries of the probe sequence back so that
+    // lookups never stop at the hole.
+    unique_set_[index] = Entry();
+    for (size_t next = (index + 1) & kSlotMask;
+         !unique_set_[next].handle.IsEmpty();
+         next = (next + 1) & kSlotMask) {
+      size_t home = HomeSlot(unique_set_[next].hash);
+      bool in_place = index <= next ? (index < home && home <= next)
+                                    : (index < home || home <= next);
+      if (in_place)
+        continue;
+      unique_set_[index] = unique_set_[next];
+      unique_set_[next] = Entry();
+      index = next;
+    }
     return true;
   }
 
@@ -73,25 +191,36 @@ class V8ValueConverter::FromV8ValueState {
   }
 
  private:
-  using HashToHandleMap = std::multimap<int, v8::Local<v8::Object>>;
-  using Iterator = HashToHandleMap::const_iterator;
-
-  Iterator GetIteratorInMap(v8::Local<v8::Object> handle, int* hash) {
-    *hash = handle->GetIdentityHash();
-    // We only compare using == with handles to objects with the same identity
-    // hash. Different hash obviously means different objects, but two objects
-    // in a couple of thousands could have the same identity hash.
-    std::pair<Iterator, Iterator> range = unique_map_.equal_range(*hash);
-    for (auto it = range.first; it != range.second; ++it) {
-      // Operator == for handles actually compares the underlying objects.
-      if (it->second == handle)
-        return it;
-    }
-    // Not found.
-    return unique_map_.end();
+  // Only the objects between the root and the value being converted are in
+  // the set, so it never holds more than kMaxRecursionDepth + 1 entries and
+  // a fixed open-addressed table that is at most half full is enough.
+  static const size_t kSlotCount = 256;
+  static const size_t kSlotMask = kSlotCount - 1;
+  static_assert(kSlotCount >= 2 * (kMaxRecursionDepth + 1),
+                "The uniqueness set must stay sparse");
+
+  struct Entry {
+    int hash = 0;
+    v8::Local<v8::Object> handle;
+  };
+
+  static size_t HomeSlot(int hash) {
+    return static_cast<uint32_t>(hash) & kSlotMask;
   }
 
-  HashToHandleMap unique_map_;
+  // Returns the slot of |handle|, or the empty slot where it would go.
+  size_t FindSlot(v8::Local<v8::Object> handle, int hash) const {
+    size_t index = HomeSlot(hash);
+    // Operator == for handles actually compares the underlying objects, only
+    // do it for handles with the same identity hash.
+    while (!unique_set_[index].handle.IsEmpty() &&
+           !(unique_set_[index].hash == hash &&
+             unique_set_[index].handle == handle))
+      index = (index + 1) & kSlotMask;
+    return index;
+  }
+
+  Entry unique_set_[kSlotCount];
 
   int max_recursion_depth_;
 };
@@ -118,7 +247,6 @@ class V8ValueConverter::ScopedUniquenessGuard {
   bool is_valid() const { return is_valid_; }
 
  private:
-  typedef std::multimap<int, v8::Local<v8::Object> > HashToHandleMap;
   V8ValueConverter::FromV8ValueState* state_;
   v8::Local<v8::Object> value_;
   bool is_valid_;
@@ -147,7 +275,8 @@ v8::Local<v8::Value> V8ValueConverter::ToV8Value(
     const base::Value* value, v8::Local<v8::Context> context) const {
   v8::Context::Scope context_scope(context);
   v8::EscapableHandleScope handle_scope(context->GetIsolate());
-  return handle_scope.Escape(ToV8ValueImpl(context->GetIsolate(), value));
+  ToV8ValueState state(context->GetIsolate());
+  return handle_scope.Escape(ToV8ValueImpl(&state, value));
 }
 
 base::Value* V8ValueConverter::FromV8Value(
@@ -156,45 +285,39 @@ base::Value* V8ValueConverter::FromV8Value(
   v8::Context::Scope context_scope(context);
   v8::HandleScope handle_scope(context->GetIsolate());
   FromV8ValueState state;
-  return FromV8ValueImpl(&state, val, context->GetIsolate());
+  base::Value result;
+  if (!FromV8ValueImpl(&state, val, context->GetIsolate(), &result))
+    return nullptr;
+  return new base::Value(std::move(result));
 }
 
 v8::Local<v8::Value> V8ValueConverter::ToV8ValueImpl(
-     v8::Isolate* isolate, const base::Value* value) const {
+     ToV8ValueState* state, const base::Value* value) const {
+  v8::Isolate* isolate = state->isolate();
   switch (value->type()) {
     case base::Value::Type::NONE:
       return v8::Null(isolate);
 
-    case base::Value::Type::BOOLEAN: {
-      bool val = false;
-      value->GetAsBoolean(&val);
-      return v8::Boolean::New(isolate, val);
-    }
+    case base::Value::Type::BOOLEAN:
+      return v8::Boolean::New(isolate, value->GetBool());
 
-    case base::Value::Type::INTEGER: {
-      int val = 0;
-      value->GetAsInteger(&val);
-      return v8::Integer::New(isolate, val);
-    }
+    case base::Value::Type::INTEGER:
+      return v8::Integer::New(isolate, value->GetInt());
 
-    case base::Value::Type::DOUBLE: {
-      double val = 0.0;
-      value->GetAsDouble(&val);
-      return v8::Number::New(isolate, val);
-    }
+    case base::Value::Type::DOUBLE:
+      return v8::Number::New(isolate, value->GetDouble());
 
     case base::Value::Type::STRING: {
-      std::string val;
-      value->GetAsString(&val);
+      const std::string& val = value->GetString();
       return v8::String::NewFromUtf8(
           isolate, val.c_str(), v8::String::kNormalString, val.length());
     }
 
     case base::Value::Type::LIST:
-      return ToV8Array(isolate, static_cast<const base::ListValue*>(value));
+      return ToV8Array(state, static_cast<const base::ListValue*>(value));
 
     case base::Value::Type::DICTIONARY:
-      return ToV8Object(isolate,
+      return ToV8Object(state,
                         static_cast<const base::DictionaryValue*>(value));
 
     case base::Value::Type::BINARY:
@@ -208,43 +331,41 @@ v8::Local<v8::Value> V8ValueConverter::ToV8ValueImpl(
 }
 
 v8::Local<v8::Value> V8ValueConverter::ToV8Array(
-    v8::Isolate* isolate, const base::ListValue* val) const {
-  v8::Local<v8::Array> result(v8::Array::New(isolate, val->GetSize()));
-
-  for (size_t i = 0; i < val->GetSize(); ++i) {
-    const base::Value* child = nullptr;
-    val->Get(i, &child);
-
-    v8::Local<v8::Value> child_v8 = ToV8ValueImpl(isolate, child);
-
-    v8::TryCatch try_catch(isolate);
-    result->Set(static_cast<uint32_t>(i), child_v8);
-    if (try_catch.HasCaught())
-      LOG(ERROR) << "Setter for index " << i << " threw an exception.";
+    ToV8ValueState* state, const base::ListValue* val) const {
+  const base::Value::ListStorage& list = val->GetList();
+  v8::Local<v8::Array> result(
+      v8::Array::New(state->isolate(), static_cast<int>(list.size())));
+
+  for (size_t i = 0; i < list.size(); ++i) {
+    v8::Local<v8::Value> child_v8 = ToV8ValueImpl(state, &list[i]);
+
+    // Unlike Set(), defining the property never runs setters of the
+    // prototype chain.
+    if (result->CreateDataProperty(state->context(), static_cast<uint32_t>(i),
+                                   child_v8).IsNothing())
+      LOG(ERROR) << "Failed to set index " << i << ".";
   }
 
   return result;
 }
 
 v8::Local<v8::Value> V8ValueConverter::ToV8Object(
-    v8::Isolate* isolate, const base::DictionaryValue* val) const {
-  mate::Dictionary result = mate::Dictionary::CreateEmpty(isolate);
-  result.SetHidden("simple", true);
+    ToV8ValueState* state, const base::DictionaryValue* val) const {
+  v8::Local<v8::Object> result = v8::Object::New(state->isolate());
+  result->SetPrivate(state->context(), state->simple_key(),
+                     v8::True(state->isolate()));
 
   for (base::DictionaryValue::Iterator iter(*val);
        !iter.IsAtEnd(); iter.Advance()) {
     const std::string& key = iter.key();
-    v8::Local<v8::Value> child_v8 = ToV8ValueImpl(isolate, &iter.value());
+    v8::Local<v8::Value> child_v8 = ToV8ValueImpl(state, &iter.value());
 
-    v8::TryCatch try_catch(isolate);
-    result.Set(key, child_v8);
-    if (try_catch.HasCaught()) {
-      LOG(ERROR) << "Setter for property " << key.c_str() << " threw an "
-                 << "exception.";
-    }
+    if (result->CreateDataProperty(state->context(), state->GetKey(key),
+                                   child_v8).IsNothing())
+      LOG(ERROR) << "Failed to set property " << key.c_str() << ".";
   }
 
-  return result.GetHandle();
+  return result;
 }
 
 v8::Local<v8::Value> V8ValueConverter::ToArrayBuffer(
@@ -254,50 +375,47 @@ v8::Local<v8::Value> V8ValueConverter::ToArrayBuffer(
       .ToLocalChecked();
 }
 
-base::Value* V8ValueConverter::FromV8ValueImpl(
+bool V8ValueConverter::FromV8ValueImpl(
     FromV8ValueState* state,
     v8::Local<v8::Value> val,
-    v8::Isolate* isolate) const {
+    v8::Isolate* isolate,
+    base::Value* out) const {
   FromV8ValueState::Level state_level(state);
   if (state->HasReachedMaxRecursionDepth())
-    return nullptr;
-
-  // std::unique_ptr<v8::Context::Scope> scope;
-  v8::Local<v8::Context> context;
-  // // If val was created in a different context than our current one,
-  // // change to
-  // // that context, but change back after val is converted.
-  // if (!val->CreationContext().IsEmpty() &&
-  //     val->CreationContext() != isolate->GetCurrentContext()) {
-  //   context = val->CreationContext();
-  //   scope.reset(new v8::Context::Scope(context));
-  // } else {
-    context = isolate->GetCurrentContext();
-  // }
+    return false;
 
-  if (val->IsExternal())
-    return new base::Value();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-  if (val->IsNull())
-    return new base::Value();
+  if (val->IsExternal() || val->IsNull()) {
+    *out = base::Value();
+    return true;
+  }
 
-  if (val->IsBoolean())
-    return new base::Value(val->ToBoolean(context).ToLocalChecked()->Value());
+  if (val->IsBoolean()) {
+    *out = base::Value(val->ToBoolean(context).ToLocalChecked()->Value());
+    return true;
+  }
 
-  if (val->IsInt32())
-    return new base::Value(val->ToInt32(context).ToLocalChecked()->Value());
+  if (val->IsInt32()) {
+    *out = base::Value(val.As<v8::Int32>()->Value());
+    return true;
+  }
 
-  if (val->IsNumber())
-    return new base::Value(val->ToNumber(context).ToLocalChecked()->Value());
+  if (val->IsNumber()) {
+    *out = base::Value(val.As<v8::Number>()->Value());
+    return true;
+  }
 
   if (val->IsString()) {
-    v8::String::Utf8Value utf8(val->ToString(context).ToLocalChecked());
-    return new base::Value(std::string(*utf8, utf8.length()));
+    std::string utf8;
+    V8StringToUTF8(val.As<v8::String>(), &utf8);
+    *out = base::Value(std::move(utf8));
+    return true;
   }
 
   if (val->IsUndefined())
     // JSON.stringify ignores undefined.
-    return nullptr;
+    return false;
 
   if (val->IsDate()) {
     v8::Date* date = v8::Date::Cast(*val);
@@ -307,8 +425,10 @@ base::Value* V8ValueConverter::FromV8ValueImpl(
       v8::Local<v8::Value> result =
           toISOString.As<v8::Function>()->Call(val, 0, nullptr);
       if (!result.IsEmpty()) {
-        v8::String::Utf8Value utf8(result->ToString(context).ToLocalChecked());
-        return new base::Value(std::string(*utf8, utf8.length()));
+        std::string utf8;
+        V8StringToUTF8(result->ToString(context).ToLocalChecked(), &utf8);
+        *out = base::Value(std::move(utf8));
+        return true;
       }
     }
   }
@@ -317,43 +437,55 @@ base::Value* V8ValueConverter::FromV8ValueImpl(
     if (!reg_exp_allowed_)
       // JSON.stringify converts to an object.
       return FromV8Object(val->ToObject(context).ToLocalChecked(), state,
-                          isolate);
-    return new base::Value(
-        *v8::String::Utf8Value(val->ToString(context).ToLocalChecked()));
+                          isolate, out);
+    std::string utf8;
+    V8StringToUTF8(val->ToString(context).ToLocalChecked(), &utf8);
+    *out = base::Value(std::move(utf8));
+    return true;
   }
 
   // v8::Value doesn't have a ToArray() method for some reason.
   if (val->IsArray())
-    return FromV8Array(val.As<v8::Array>(), state, isolate);
+    return FromV8Array(val.As<v8::Array>(), state, isolate, out);
 
   if (val->IsFunction()) {
     if (!function_allowed_)
       // JSON.stringify refuses to convert function(){}.
-      return nullptr;
+      return false;
     return FromV8Object(val->ToObject(context).ToLocalChecked(), state,
-                        isolate);
+                        isolate, out);
   }
 
   if (node::Buffer::HasInstance(val)) {
-    return FromNodeBuffer(val, state, isolate);
+    return FromNodeBuffer(val, state, isolate, out);
   }
 
+  // Typed arrays other than Uint8Array become lists of numbers.
+  if (val->IsTypedArray() && FromTypedArray(val, out))
+    return true;
+
+  if (val->IsArrayBuffer() || val->IsArrayBufferView())
+    return FromArrayBuffer(val, isolate, out);
+
   if (val->IsObject()) {
     return FromV8Object(val->ToObject(context).ToLocalChecked(), state,
-                        isolate);
+                        isolate, out);
   }
 
   LOG(ERROR) << "Unexpected v8 value type encountered.";
-  return nullptr;
+  return false;
 }
 
-base::Value* V8ValueConverter::FromV8Array(
+bool V8ValueConverter::FromV8Array(
     v8::Local<v8::Array> val,
     FromV8ValueState* state,
-    v8::Isolate* isolate) const {
+    v8::Isolate* isolate,
+    base::Value* out) const {
   ScopedUniquenessGuard uniqueness_guard(state, val);
-  if (!uniqueness_guard.is_valid())
-    return new base::Value();
+  if (!uniqueness_guard.is_valid()) {
+    *out = base::Value();
+    return true;
+  }
 
   std::unique_ptr<v8::Context::Scope> scope;
   v8::Local<v8::Context> context;
@@ -367,46 +499,76 @@ base::Value* V8ValueConverter::FromV8Array(
     context = isolate->GetCurrentContext();
   }
 
-  auto* result = new base::ListValue();
+  // Elements are stored in place, not as separately allocated Values.
+  uint32_t length = val->Length();
+  base::Value::ListStorage list;
+  list.reserve(length);
+
+  // Only fields with integer keys are carried over to the list.
+  for (uint32_t i = 0; i < length; ++i) {
+    if (!val->HasRealIndexedProperty(i))
+      continue;
 
-  // Only fields with integer keys are carried over to the ListValue.
-  for (uint32_t i = 0; i < val->Length(); ++i) {
     v8::TryCatch try_catch(isolate);
-    v8::Local<v8::Value> child_v8 = val->Get(i);
-    if (try_catch.HasCaught()) {
+    v8::Local<v8::Value> child_v8;
+    if (!val->Get(context, i).ToLocal(&child_v8) || try_catch.HasCaught()) {
       LOG(ERROR) << "Getter for index " << i << " threw an exception.";
       child_v8 = v8::Null(isolate);
     }
 
-    if (!val->HasRealIndexedProperty(i))
-      continue;
-
-    base::Value* child = FromV8ValueImpl(state, child_v8, isolate);
-    if (child)
-      result->Append(std::unique_ptr<base::Value>(child));
-    else
+    list.emplace_back();
+    if (!FromV8ValueImpl(state, child_v8, isolate, &list.back())) {
       // JSON.stringify puts null in places where values don't serialize, for
       // example undefined and functions. Emulate that behavior.
-      result->Append(std::make_unique<base::Value>());
+      list.back() = base::Value();
+    }
   }
-  return result;
+
+  *out = base::Value(std::move(list));
+  return true;
 }
 
-base::Value* V8ValueConverter::FromNodeBuffer(
+bool V8ValueConverter::FromNodeBuffer(
     v8::Local<v8::Value> value,
     FromV8ValueState* state,
-    v8::Isolate* isolate) const {
-  return base::Value::CreateWithCopiedBuffer(
-      node::Buffer::Data(value), node::Buffer::Length(value)).release();
+    v8::Isolate* isolate,
+    base::Value* out) const {
+  const char* data = node::Buffer::Data(value);
+  *out = base::Value(base::Value::BlobStorage(
+      data, data + node::Buffer::Length(value)));
+  return true;
 }
 
-base::Value* V8ValueConverter::FromV8Object(
+bool V8ValueConverter::FromArrayBuffer(
+    v8::Local<v8::Value> value,
+    v8::Isolate* isolate,
+    base::Value* out) const {
+  base::Value::BlobStorage blob;
+  if (value->IsArrayBuffer()) {
+    v8::ArrayBuffer::Contents contents =
+        value.As<v8::ArrayBuffer>()->GetContents();
+    const char* data = static_cast<const char*>(contents.Data());
+    blob.assign(data, data + contents.ByteLength());
+  } else {
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    blob.resize(view->ByteLength());
+    if (!blob.empty())
+      view->CopyContents(blob.data(), blob.size());
+  }
+  *out = base::Value(std::move(blob));
+  return true;
+}
+
+bool V8ValueConverter::FromV8Object(
     v8::Local<v8::Object> val,
     FromV8ValueState* state,
-    v8::Isolate* isolate) const {
+    v8::Isolate* isolate,
+    base::Value* out) const {
   ScopedUniquenessGuard uniqueness_guard(state, val);
-  if (!uniqueness_guard.is_valid())
-    return new base::Value();
+  if (!uniqueness_guard.is_valid()) {
+    *out = base::Value();
+    return true;
+  }
 
   std::unique_ptr<v8::Context::Scope> scope;
   v8::Local<v8::Context> context;
@@ -420,11 +582,22 @@ base::Value* V8ValueConverter::FromV8Object(
     context = isolate->GetCurrentContext();
   }
 
-  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
-  v8::Local<v8::Array> property_names(val->GetOwnPropertyNames());
+  v8::Local<v8::Array> property_names;
+  if (!val->GetOwnPropertyNames(context).ToLocal(&property_names)) {
+    *out = base::DictionaryValue();
+    return true;
+  }
+
+  // The properties are collected first and sorted into the dictionary once,
+  // instead of being inserted one by one.
+  uint32_t length = property_names->Length();
+  std::vector<std::pair<std::string, std::unique_ptr<base::Value>>> entries;
+  entries.reserve(length);
 
-  for (uint32_t i = 0; i < property_names->Length(); ++i) {
-    v8::Local<v8::Value> key(property_names->Get(i));
+  for (uint32_t i = 0; i < length; ++i) {
+    v8::Local<v8::Value> key;
+    if (!property_names->Get(context, i).ToLocal(&key))
+      continue;
 
     // Extend this test to cover more types as necessary and if sensible.
     if (!key->IsString() &&
@@ -434,21 +607,21 @@ base::Value* V8ValueConverter::FromV8Object(
       continue;
     }
 
-    v8::String::Utf8Value name_utf8(
-        key->ToString(context).ToLocalChecked());
+    std::string name;
+    V8StringToUTF8(key->IsString() ? key.As<v8::String>()
+                                   : key->ToString(context).ToLocalChecked(),
+                   &name);
 
     v8::TryCatch try_catch(isolate);
-    v8::Local<v8::Value> child_v8 = val->Get(key);
-
-    if (try_catch.HasCaught()) {
-      LOG(ERROR) << "Getter for property " << *name_utf8
+    v8::Local<v8::Value> child_v8;
+    if (!val->Get(context, key).ToLocal(&child_v8) || try_catch.HasCaught()) {
+      LOG(ERROR) << "Getter for property " << name
                  << " threw an exception.";
       child_v8 = v8::Null(isolate);
     }
 
-    std::unique_ptr<base::Value> child(
-        FromV8ValueImpl(state, child_v8, isolate));
-    if (!child.get())
+    std::unique_ptr<base::Value> child(new base::Value);
+    if (!FromV8ValueImpl(state, child_v8, isolate, child.get()))
       // JSON.stringify skips properties whose values don't serialize, for
       // example undefined and functions. Emulate that behavior.
       continue;
@@ -476,11 +649,12 @@ base::Value* V8ValueConverter::FromV8Object(
     if (strip_null_from_objects_ && child->is_none())
       continue;
 
-    result->SetWithoutPathExpansion(std::string(*name_utf8, name_utf8.length()),
-                                    std::move(child));
+    entries.emplace_back(std::move(name), std::move(child));
   }
 
-  return result.release();
+  *out = base::DictionaryValue(base::DictionaryValue::DictStorage(
+      std::move(entries), base::KEEP_LAST_OF_DUPES));
+  return true;
 }
 
 }  // namespace atom
@@ -32,30 +32,40 @@ class V8ValueConverter {
  private:
   class FromV8ValueState;
   class ScopedUniquenessGuard;
+  class ToV8ValueState;
 
-  v8::Local<v8::Value> ToV8ValueImpl(v8::Isolate* isolate,
+  v8::Local<v8::Value> ToV8ValueImpl(ToV8ValueState* state,
                                      const base::Value* value) const;
-  v8::Local<v8::Value> ToV8Array(v8::Isolate* isolate,
+  v8::Local<v8::Value> ToV8Array(ToV8ValueState* state,
                                  const base::ListValue* list) const;
   v8::Local<v8::Value> ToV8Object(
-      v8::Isolate* isolate,
+      ToV8ValueState* state,
       const base::DictionaryValue* dictionary) const;
   v8::Local<v8::Value> ToArrayBuffer(
       v8::Isolate* isolate,
       const base::Value* value) const;
 
-  base::Value* FromV8ValueImpl(FromV8ValueState* state,
-                               v8::Local<v8::Value> value,
-                               v8::Isolate* isolate) const;
-  base::Value* FromV8Array(v8::Local<v8::Array> array,
-                           FromV8ValueState* state,
-                           v8::Isolate* isolate) const;
-  base::Value* FromNodeBuffer(v8::Local<v8::Value> value,
-                              FromV8ValueState* state,
-                              v8::Isolate* isolate) const;
-  base::Value* FromV8Object(v8::Local<v8::Object> object,
-                            FromV8ValueState* state,
-                            v8::Isolate* isolate) const;
+  // The FromV8 functions return false when |value| has no base::Value
+  // equivalent, like undefined, and set |out| otherwise.
+  bool FromV8ValueImpl(FromV8ValueState* state,
+                       v8::Local<v8::Value> value,
+                       v8::Isolate* isolate,
+                       base::Value* out) const;
+  bool FromV8Array(v8::Local<v8::Array> array,
+                   FromV8ValueState* state,
+                   v8::Isolate* isolate,
+                   base::Value* out) const;
+  bool FromNodeBuffer(v8::Local<v8::Value> value,
+                      FromV8ValueState* state,
+                      v8::Isolate* isolate,
+                      base::Value* out) const;
+  bool FromArrayBuffer(v8::Local<v8::Value> value,
+                       v8::Isolate* isolate,
+                       base::Value* out) const;
+  bool FromV8Object(v8::Local<v8::Object> object,
+                    FromV8ValueState* state,
+                    v8::Isolate* isolate,
+                    base::Value* out) const;
 
   // If true, we will convert RegExp JavaScript objects to string.
   bool reg_exp_allowed_;
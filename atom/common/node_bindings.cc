@@ -128,6 +128,7 @@ NodeBindings::NodeBindings()
     : message_loop_(nullptr),
       uv_loop_(uv_default_loop()),
       embed_closed_(false),
+      use_embed_thread_(false),
       uv_env_(nullptr),
       weak_factory_(this) {
 }
@@ -136,7 +137,7 @@ NodeBindings::~NodeBindings() {
   // Quit the embed thread.
   embed_closed_ = true;
   // node never started
-  if (!uv_env_)
+  if (!uv_env_ || !use_embed_thread_)
     return;
   uv_sem_post(&embed_sem_);
   WakeupEmbedThread();
@@ -227,7 +228,11 @@ void NodeBindings::PrepareMessageLoop() {
   // nothing to do.
   uv_async_init(uv_loop_, &dummy_uv_handle_, nullptr);
 
+  if (WatchBackendFd())
+    return;
+
   // Start worker that will interrupt main loop when having uv events.
+  use_embed_thread_ = true;
   uv_sem_init(&embed_sem_, 0);
   uv_thread_create(&embed_thread_, EmbedThreadRunner, this);
 }
@@ -259,12 +264,21 @@ void NodeBindings::UvRunOnce() {
                                    v8::MicrotasksScope::kRunMicrotasks);
 
   // Deal with uv events.
-  int r = uv_run(uv_loop_, UV_RUN_NOWAIT);
+  int r = RunUvLoop();
   if (r == 0)
     base::RunLoop::QuitCurrentWhenIdleDeprecated();  // Quit from uv.
 
   // Tell the worker thread to continue polling.
-  uv_sem_post(&embed_sem_);
+  if (use_embed_thread_)
+    uv_sem_post(&embed_sem_);
+}
+
+bool NodeBindings::WatchBackendFd() {
+  return false;
+}
+
+int NodeBindings::RunUvLoop() {
+  return uv_run(uv_loop_, UV_RUN_NOWAIT);
 }
 
 void NodeBindings::WakeupMainThread() {
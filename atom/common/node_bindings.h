@@ -51,9 +51,18 @@ class NodeBindings {
   // Called to poll events in new thread.
   virtual void PollEvents() = 0;
 
+  // Called to let the main thread's message pump watch uv's backend fd
+  // instead of polling it in the embed thread. Returns false if the platform
+  // doesn't support it.
+  virtual bool WatchBackendFd();
+
   // Run the libuv loop for once.
   void UvRunOnce();
 
+  // Called by UvRunOnce() to deal with uv events, returns the result of the
+  // last uv_run.
+  virtual int RunUvLoop();
+
   // Make the main thread run libuv loop.
   void WakeupMainThread();
 
@@ -73,6 +82,9 @@ class NodeBindings {
   // Whether the libuv loop has ended.
   bool embed_closed_;
 
+  // Whether uv events are polled in |embed_thread_|.
+  bool use_embed_thread_;
+
   // Dummy handle to make uv's loop not quit.
   uv_async_t dummy_uv_handle_;
 
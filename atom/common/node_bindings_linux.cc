@@ -4,13 +4,65 @@
 
 #include "atom/common/node_bindings_linux.h"
 
+#include <glib.h>
+#include <poll.h>
 #include <sys/epoll.h>
 
+#include "atom/common/options_switches.h"
+#include "base/command_line.h"
+#include "base/time/time.h"
+#include "base/trace_event/trace_event.h"
+
 namespace atom {
 
+namespace {
+
+// Longest time spent draining uv events on one wakeup of the main loop, so
+// that a busy uv loop can't starve input and painting.
+const int kUvRunBudgetMs = 8;
+
+// Same priority as the work source of base::MessagePumpGlib, so that uv
+// events and tasks can't starve each other.
+const int kPriorityUv = G_PRIORITY_DEFAULT + 1;
+
+struct UvSource : public GSource {
+  NodeBindingsLinux* bindings;
+  GPollFD poll_fd;
+};
+
+gboolean UvSourcePrepare(GSource* source, gint* timeout) {
+  *timeout = static_cast<UvSource*>(source)->bindings->HandlePrepare();
+  return *timeout == 0;
+}
+
+gboolean UvSourceCheck(GSource* source) {
+  UvSource* uv_source = static_cast<UvSource*>(source);
+  return (uv_source->poll_fd.revents & G_IO_IN) ||
+         uv_source->bindings->HandleCheck();
+}
+
+gboolean UvSourceDispatch(GSource* source,
+                          GSourceFunc unused_func,
+                          gpointer unused_data) {
+  static_cast<UvSource*>(source)->bindings->HandleDispatch();
+  return TRUE;
+}
+
+GSourceFuncs g_uv_source_funcs = {
+  UvSourcePrepare,
+  UvSourceCheck,
+  UvSourceDispatch,
+  nullptr
+};
+
+}  // namespace
+
 NodeBindingsLinux::NodeBindingsLinux()
     : NodeBindings(),
-      epoll_(epoll_create(1)) {
+      epoll_(epoll_create(1)),
+      uv_source_(nullptr),
+      uv_run_pending_(false),
+      wakeups_(0) {
   int backend_fd = uv_backend_fd(uv_loop_);
   struct epoll_event ev = { 0 };
   ev.events = EPOLLIN;
@@ -19,6 +71,10 @@ NodeBindingsLinux::NodeBindingsLinux()
 }
 
 NodeBindingsLinux::~NodeBindingsLinux() {
+  if (uv_source_) {
+    g_source_destroy(uv_source_);
+    g_source_unref(uv_source_);
+  }
 }
 
 void NodeBindingsLinux::RunMessageLoop() {
@@ -29,10 +85,37 @@ void NodeBindingsLinux::RunMessageLoop() {
   NodeBindings::RunMessageLoop();
 }
 
+int NodeBindingsLinux::HandlePrepare() {
+  if (uv_run_pending_)
+    return 0;
+  uv_update_time(uv_loop_);
+  return uv_backend_timeout(uv_loop_);
+}
+
+bool NodeBindingsLinux::HandleCheck() {
+  if (uv_run_pending_)
+    return true;
+  // The loop time is only updated by uv_run, refresh it for due timers.
+  uv_update_time(uv_loop_);
+  return uv_backend_timeout(uv_loop_) == 0;
+}
+
+void NodeBindingsLinux::HandleDispatch() {
+  uv_run_pending_ = false;
+  TRACE_COUNTER1("node", "NodeBindingsLinux::Wakeups", ++wakeups_);
+  UvRunOnce();
+}
+
 // static
 void NodeBindingsLinux::OnWatcherQueueChanged(uv_loop_t* loop) {
   NodeBindingsLinux* self = static_cast<NodeBindingsLinux*>(loop->data);
 
+  // New watchers only reach epoll in uv_run, so make sure it runs soon.
+  if (self->uv_source_) {
+    self->uv_run_pending_ = true;
+    return;
+  }
+
   // We need to break the io polling in the epoll thread when loop's watcher
   // queue changes, otherwise new events cannot be notified.
   self->WakeupEmbedThread();
@@ -49,6 +132,49 @@ void NodeBindingsLinux::PollEvents() {
   } while (r == -1 && errno == EINTR);
 }
 
+bool NodeBindingsLinux::WatchBackendFd() {
+  if (!base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUvMessagePump))
+    return false;
+
+  uv_source_ = g_source_new(&g_uv_source_funcs, sizeof(UvSource));
+  UvSource* source = static_cast<UvSource*>(uv_source_);
+  source->bindings = this;
+  source->poll_fd.fd = uv_backend_fd(uv_loop_);
+  source->poll_fd.events = G_IO_IN;
+  source->poll_fd.revents = 0;
+  g_source_add_poll(uv_source_, &source->poll_fd);
+  g_source_set_priority(uv_source_, kPriorityUv);
+  // The main loop runs in the default context on the UI thread.
+  g_source_attach(uv_source_, g_main_context_default());
+  return true;
+}
+
+int NodeBindingsLinux::RunUvLoop() {
+  if (!uv_source_)
+    return NodeBindings::RunUvLoop();
+
+  TRACE_EVENT0("node", "NodeBindingsLinux::RunUvLoop");
+
+  // Locking and entering the context is paid once per wakeup, so deal with
+  // everything that is ready until the budget runs out.
+  base::TimeTicks deadline = base::TimeTicks::Now() +
+      base::TimeDelta::FromMilliseconds(kUvRunBudgetMs);
+  int r;
+  do {
+    r = uv_run(uv_loop_, UV_RUN_NOWAIT);
+  } while (r != 0 && HasPendingEvents() && base::TimeTicks::Now() < deadline);
+  return r;
+}
+
+bool NodeBindingsLinux::HasPendingEvents() {
+  if (uv_backend_timeout(uv_loop_) == 0)
+    return true;
+
+  struct pollfd fd = { uv_backend_fd(uv_loop_), POLLIN, 0 };
+  return poll(&fd, 1, 0) > 0;
+}
+
 // static
 NodeBindings* NodeBindings::Create() {
   return new NodeBindingsLinux();
@@ -8,6 +8,8 @@
 #include "atom/common/node_bindings.h"
 #include "base/compiler_specific.h"
 
+typedef struct _GSource GSource;
+
 namespace atom {
 
 class NodeBindingsLinux : public NodeBindings {
@@ -17,15 +19,37 @@ class NodeBindingsLinux : public NodeBindings {
 
   void RunMessageLoop() override;
 
+  // Internal methods used for processing the uv source callbacks. They are
+  // public for simplicity but should not be used directly.
+  int HandlePrepare();
+  bool HandleCheck();
+  void HandleDispatch();
+
  private:
   // Called when uv's watcher queue changes.
   static void OnWatcherQueueChanged(uv_loop_t* loop);
 
   void PollEvents() override;
+  bool WatchBackendFd() override;
+  int RunUvLoop() override;
+
+  // Whether uv has events that can be dealt with right away.
+  bool HasPendingEvents();
 
   // Epoll to poll for uv's backend fd.
   int epoll_;
 
+  // Watches uv's backend fd from the main loop, null when the embed thread
+  // is used instead.
+  GSource* uv_source_;
+
+  // Set when uv_run must be called before the backend fd can be trusted,
+  // because a watcher has been added that epoll doesn't know of yet.
+  bool uv_run_pending_;
+
+  // Number of times the main loop woke up for uv events.
+  int wakeups_;
+
   DISALLOW_COPY_AND_ASSIGN(NodeBindingsLinux);
 };
 
@@ -128,6 +128,10 @@ const char kCipherSuiteBlacklist[] = "cipher-suite-blacklist";
 // The browser process app model ID
 const char kAppUserModelId[] = "app-user-model-id";
 
+// Deal with libuv events in the main message loop instead of polling for them
+// in a separate thread, only supported on Linux.
+const char kUvMessagePump[] = "uv-message-pump";
+
 // The command line switch versions of the options.
 const char kBackgroundColor[] = "background-color";
 const char kZoomFactor[]      = "zoom-factor";
@@ -0,0 +1,118 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "atom/renderer/content_setting_rules.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "base/values.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+const char kFirstParty[] = "[firstParty]";
+
+}  // namespace
+
+ContentSettingRules::ContentSettingRules(const base::ListValue& rules) {
+  rules_.reserve(rules.GetSize());
+  for (const base::Value& value : rules.GetList()) {
+    const base::DictionaryValue* dict = nullptr;
+    std::string primary_string;
+    std::string setting_string;
+    if (!value.GetAsDictionary(&dict) ||
+        !dict->GetString("primaryPattern", &primary_string) ||
+        !dict->GetString("setting", &setting_string))
+      continue;
+
+    Rule rule;
+    rule.primary = ContentSettingsPattern::FromString(primary_string);
+    // An invalid pattern never matches, so the rule can't have any effect.
+    if (!rule.primary.IsValid())
+      continue;
+
+    std::string secondary_string;
+    dict->GetString("secondaryPattern", &secondary_string);
+    if (secondary_string.empty()) {
+      rule.secondary_type = SECONDARY_ANY;
+    } else if (secondary_string == kFirstParty) {
+      rule.secondary_type = SECONDARY_FIRST_PARTY;
+    } else {
+      rule.secondary_type = SECONDARY_PATTERN;
+      rule.secondary = ContentSettingsPattern::FromString(secondary_string);
+      if (!rule.secondary.IsValid())
+        continue;
+    }
+
+    rule.setting = (setting_string == "block" || setting_string == "deny")
+        ? CONTENT_SETTING_BLOCK
+        : CONTENT_SETTING_ALLOW;
+
+    size_t index = rules_.size();
+    const std::string& host = rule.primary.GetHost();
+    if (host.empty() || host.find(':') != std::string::npos)
+      any_host_rules_.push_back(index);
+    else
+      rules_by_host_[host].push_back(index);
+    rules_.push_back(rule);
+  }
+}
+
+ContentSettingRules::~ContentSettingRules() {
+}
+
+void ContentSettingRules::AddCandidates(
+    const std::string& host, std::vector<size_t>* candidates) const {
+  // Domain wildcards are indexed by their domain, so every parent domain of
+  // |host| has to be probed as well.
+  for (size_t pos = 0; pos != std::string::npos;) {
+    auto it = rules_by_host_.find(host.substr(pos));
+    if (it != rules_by_host_.end())
+      candidates->insert(candidates->end(), it->second.begin(),
+                         it->second.end());
+    pos = host.find('.', pos);
+    if (pos != std::string::npos)
+      ++pos;
+  }
+}
+
+ContentSetting ContentSettingRules::GetSetting(
+    const GURL& primary_url,
+    const GURL& secondary_url,
+    ContentSetting default_setting) const {
+  std::vector<size_t> candidates(any_host_rules_);
+  if (!primary_url.host().empty())
+    AddCandidates(primary_url.host(), &candidates);
+
+  // The last matching rule wins, so check candidates from the end.
+  std::sort(candidates.begin(), candidates.end(), std::greater<size_t>());
+
+  ContentSettingsPattern first_party;
+  bool first_party_parsed = false;
+  for (size_t index : candidates) {
+    const Rule& rule = rules_[index];
+    if (!rule.primary.Matches(primary_url))
+      continue;
+
+    if (rule.secondary_type == SECONDARY_PATTERN) {
+      if (!rule.secondary.Matches(secondary_url))
+        continue;
+    } else if (rule.secondary_type == SECONDARY_FIRST_PARTY) {
+      if (!first_party_parsed) {
+        first_party = ContentSettingsPattern::FromString(
+            "[*.]" + primary_url.HostNoBrackets());
+        first_party_parsed = true;
+      }
+      if (!first_party.Matches(secondary_url))
+        continue;
+    }
+    return rule.setting;
+  }
+  return default_setting;
+}
+
+}  // namespace atom
@@ -0,0 +1,69 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_RENDERER_CONTENT_SETTING_RULES_H_
+#define ATOM_RENDERER_CONTENT_SETTING_RULES_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
+
+class GURL;
+
+namespace base {
+class ListValue;
+}
+
+namespace atom {
+
+// The rules of one content type, compiled from the list sent by the browser.
+// Patterns are parsed once and indexed by the host of their primary pattern,
+// so a lookup only evaluates the rules that can possibly match.
+class ContentSettingRules {
+ public:
+  // |rules| holds {primaryPattern, secondaryPattern, setting} dictionaries.
+  // Invalid entries are dropped.
+  explicit ContentSettingRules(const base::ListValue& rules);
+  ~ContentSettingRules();
+
+  // Rules are evaluated in order and the last matching one wins, returns
+  // |default_setting| when none matches.
+  ContentSetting GetSetting(const GURL& primary_url,
+                            const GURL& secondary_url,
+                            ContentSetting default_setting) const;
+
+ private:
+  enum SecondaryType {
+    SECONDARY_ANY,
+    SECONDARY_PATTERN,
+    // "[firstParty]", resolved against the primary url at lookup time.
+    SECONDARY_FIRST_PARTY,
+  };
+
+  struct Rule {
+    ContentSettingsPattern primary;
+    ContentSettingsPattern secondary;
+    SecondaryType secondary_type;
+    ContentSetting setting;
+  };
+
+  // Appends the indices of the rules whose primary host could match |host|.
+  void AddCandidates(const std::string& host,
+                     std::vector<size_t>* candidates) const;
+
+  std::vector<Rule> rules_;
+  std::unordered_map<std::string, std::vector<size_t>> rules_by_host_;
+  // Rules with a wildcard or unusual primary host, they are always checked.
+  std::vector<size_t> any_host_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingRules);
+};
+
+}  // namespace atom
+
+#endif  // ATOM_RENDERER_CONTENT_SETTING_RULES_H_
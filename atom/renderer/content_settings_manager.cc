@@ -4,13 +4,17 @@
 
 #include "atom/renderer/content_settings_manager.h"
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "atom/common/api/api_messages.h"
+#include "base/memory/shared_memory.h"
+#include "base/pickle.h"
 #include "base/values.h"
-#include "components/content_settings/core/common/content_settings_pattern.h"
 #include "content/public/common/url_constants.h"
 #include "content/public/renderer/render_thread.h"
+#include "ipc/ipc_message_utils.h"
 #include "third_party/blink/public/web/web_document.h"
 #include "third_party/blink/public/web/web_local_frame.h"
 #include "url/gurl.h"
@@ -18,7 +22,8 @@
 
 namespace atom {
 
-ContentSettingsManager::ContentSettingsManager() {
+ContentSettingsManager::ContentSettingsManager()
+    : content_settings_version_(0) {
   content::RenderThread::Get()->AddObserver(this);
 }
 
@@ -52,6 +57,8 @@ bool ContentSettingsManager::OnControlMessageReceived(
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(ContentSettingsManager, message)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettings, OnUpdateContentSettings)
+    IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettingsDelta,
+                        OnUpdateContentSettingsDelta)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateWebKitPrefs, OnUpdateWebKitPrefs)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
@@ -64,8 +71,63 @@ void ContentSettingsManager::OnUpdateWebKitPrefs(
 }
 
 void ContentSettingsManager::OnUpdateContentSettings(
-    const base::DictionaryValue& content_settings) {
-  content_settings_ = content_settings.CreateDeepCopy();
+    const base::SharedMemoryHandle& snapshot,
+    uint32_t size,
+    uint32_t version) {
+  base::SharedMemory memory(snapshot, true);
+  if (!memory.Map(size)) {
+    NOTREACHED() << "Could not map the content settings";
+    return;
+  }
+
+  base::Pickle pickle(static_cast<const char*>(memory.memory()), size);
+  base::PickleIterator iter(pickle);
+  std::unique_ptr<base::DictionaryValue> content_settings(
+      new base::DictionaryValue);
+  if (!IPC::ReadParam(&pickle, &iter, content_settings.get())) {
+    NOTREACHED() << "Invalid content settings snapshot";
+    return;
+  }
+
+  content_settings_ = std::move(content_settings);
+  content_settings_version_ = version;
+
+  rules_.clear();
+  for (base::DictionaryValue::Iterator it(*content_settings_); !it.IsAtEnd();
+       it.Advance()) {
+    CompileRules(it.key(), it.value());
+  }
+}
+
+void ContentSettingsManager::OnUpdateContentSettingsDelta(
+    uint32_t version,
+    const base::DictionaryValue& changed,
+    const std::vector<std::string>& removed) {
+  // The browser sends every version to a renderer after its first snapshot.
+  if (!content_settings_ || version != content_settings_version_ + 1) {
+    NOTREACHED() << "Content settings delta out of order";
+    return;
+  }
+
+  for (base::DictionaryValue::Iterator it(changed); !it.IsAtEnd();
+       it.Advance()) {
+    content_settings_->SetKey(it.key(), it.value().Clone());
+    CompileRules(it.key(), it.value());
+  }
+  for (const std::string& content_type : removed) {
+    content_settings_->RemoveKey(content_type);
+    rules_.erase(content_type);
+  }
+  content_settings_version_ = version;
+}
+
+void ContentSettingsManager::CompileRules(const std::string& content_type,
+                                          const base::Value& rules) {
+  const base::ListValue* list = nullptr;
+  if (rules.GetAsList(&list))
+    rules_[content_type] = std::make_unique<ContentSettingRules>(*list);
+  else
+    rules_.erase(content_type);
 }
 
 ContentSetting ContentSettingsManager::GetSetting(
@@ -110,47 +172,11 @@ ContentSetting ContentSettingsManager::GetContentSettingFromRules(
     ? ContentSetting::CONTENT_SETTING_ALLOW
     : ContentSetting::CONTENT_SETTING_BLOCK;
 
-  base::ListValue* rules = nullptr;
-  if (!content_settings_->GetList(content_type, &rules))
+  auto it = rules_.find(content_type);
+  if (it == rules_.end())
     return result;
 
-  // all rules are evaluated in order and the
-  // most specific matching rule will apply
-  for (base::ListValue::iterator it = rules->begin();
-       it != rules->end(); ++it) {
-    base::DictionaryValue* rule;
-    std::string pattern_string;
-    std::string setting_string;
-    if (!it->GetAsDictionary(&rule) ||
-        !rule->GetString("primaryPattern", &pattern_string) ||
-        !rule->GetString("setting", &setting_string)) {
-      // skip invalid entries
-      // TODO(bridiver) should also send an ipc error message
-      ++it;
-    } else {
-      std::string secondary_pattern_string;
-      rule->GetString("secondaryPattern", &secondary_pattern_string);
-
-      ContentSetting setting = result;
-      if (setting_string != "block" && setting_string != "deny") {
-        setting = ContentSetting::CONTENT_SETTING_ALLOW;
-      } else {
-        setting = ContentSetting::CONTENT_SETTING_BLOCK;
-      }
-
-      if (secondary_pattern_string == "[firstParty]") {
-        secondary_pattern_string = "[*.]" + primary_url.HostNoBrackets();
-      }
-
-      if (ContentSettingsPattern::FromString(
-            pattern_string).Matches(primary_url) &&
-          // if there is a secondary resource pattern it has to match as well
-          (secondary_pattern_string.empty() ||
-            ContentSettingsPattern::FromString(
-              secondary_pattern_string).Matches(secondary_url)))
-        result = setting;
-    }
-  }
-  return result;
+  return it->second->GetSetting(primary_url, secondary_url, result);
 }
+
 }  // namespace atom
@@ -5,9 +5,11 @@
 #ifndef ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 #define ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "atom/renderer/content_setting_rules.h"
 #include "base/lazy_instance.h"
 #include "base/values.h"
 #include "components/content_settings/core/common/content_settings.h"
@@ -19,6 +21,7 @@ class GURL;
 
 namespace base {
 class DictionaryValue;
+class SharedMemoryHandle;
 }
 
 namespace blink {
@@ -58,12 +61,20 @@ class ContentSettingsManager : public content::RenderThreadObserver {
 
   void OnUpdateWebKitPrefs(
       const content::WebPreferences& web_preferences);
-  void OnUpdateContentSettings(
-      const base::DictionaryValue& content_settings);
-
+  void OnUpdateContentSettings(const base::SharedMemoryHandle& snapshot,
+                               uint32_t size,
+                               uint32_t version);
+  void OnUpdateContentSettingsDelta(uint32_t version,
+                                    const base::DictionaryValue& changed,
+                                    const std::vector<std::string>& removed);
+  void CompileRules(const std::string& content_type,
+                    const base::Value& rules);
 
   content::WebPreferences web_preferences_;
   std::unique_ptr<base::DictionaryValue> content_settings_;
+  uint32_t content_settings_version_;
+  // |content_settings_| compiled by content type.
+  std::map<std::string, std::unique_ptr<ContentSettingRules>> rules_;
 
   DISALLOW_COPY_AND_ASSIGN(ContentSettingsManager);
 };
@@ -0,0 +1,368 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/browser/app_state_store.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+
+namespace brave {
+
+namespace {
+
+const base::FilePath::CharType kJournalFileName[] =
+    FILE_PATH_LITERAL("journal");
+const base::FilePath::CharType kSectionExtension[] = FILE_PATH_LITERAL(".json");
+
+// The journal is folded into the section files once it grows past this.
+const int64_t kMaxJournalSize = 1024 * 1024;
+
+const size_t kMaxSectionNameLength = 128;
+
+// Keys of a journal record. A record without a key replaces the whole
+// section, and a record without a value removes what it refers to.
+const char kSectionKey[] = "s";
+const char kKeyKey[] = "k";
+const char kValueKey[] = "v";
+
+// Applies |record| to |section|, which is null while the section is unset.
+void ApplyRecord(const base::DictionaryValue& record,
+                 std::unique_ptr<base::Value>* section) {
+  const base::Value* value = nullptr;
+  record.GetWithoutPathExpansion(kValueKey, &value);
+
+  std::string key;
+  if (!record.GetStringWithoutPathExpansion(kKeyKey, &key)) {
+    *section = value ? value->CreateDeepCopy() : nullptr;
+    return;
+  }
+
+  if (!*section || !(*section)->is_dict())
+    section->reset(new base::DictionaryValue);
+  base::DictionaryValue* dict =
+      static_cast<base::DictionaryValue*>(section->get());
+  if (value)
+    dict->SetWithoutPathExpansion(key, value->CreateDeepCopy());
+  else
+    dict->RemoveWithoutPathExpansion(key, nullptr);
+}
+
+}  // namespace
+
+class AppStateStore::Backend {
+ public:
+  explicit Backend(const base::FilePath& path)
+      : path_(path), initialized_(false), has_data_(false), journal_size_(0) {
+  }
+
+  ~Backend() {
+    if (!dirty_.empty())
+      Compact();
+  }
+
+  std::unique_ptr<base::Value> Get(const std::string& section) {
+    EnsureInitialized();
+    const base::Value* value = LoadSection(section);
+    return value ? value->CreateDeepCopy() : nullptr;
+  }
+
+  void Write(std::unique_ptr<base::DictionaryValue> record) {
+    EnsureInitialized();
+
+    std::string data;
+    if (!base::JSONWriter::Write(*record, &data)) {
+      LOG(ERROR) << "Unable to serialize app state";
+      return;
+    }
+    data.push_back('\n');
+
+    std::string section;
+    record->GetStringWithoutPathExpansion(kSectionKey, &section);
+    Apply(section, std::move(record));
+    dirty_.insert(section);
+    has_data_ = true;
+
+    // A record that can't be journaled is written to its section right away.
+    if (journal_.IsValid() &&
+        journal_.WriteAtCurrentPos(data.data(), data.size()) ==
+            static_cast<int>(data.size()))
+      journal_size_ += data.size();
+    else
+      journal_size_ = kMaxJournalSize + 1;
+
+    if (journal_size_ > kMaxJournalSize)
+      Compact();
+  }
+
+  bool Migrate(std::unique_ptr<base::DictionaryValue> app_state) {
+    EnsureInitialized();
+    if (has_data_)
+      return false;
+
+    for (base::DictionaryValue::Iterator it(*app_state); !it.IsAtEnd();
+         it.Advance()) {
+      if (!IsValidSectionName(it.key())) {
+        LOG(WARNING) << "Dropping app state section " << it.key();
+        continue;
+      }
+      sections_[it.key()] = it.value().CreateDeepCopy();
+      dirty_.insert(it.key());
+    }
+    if (Compact()) {
+      has_data_ = true;
+      return true;
+    }
+
+    // Leave the store empty so the migration can be tried again.
+    for (const std::string& section : dirty_)
+      base::DeleteFile(GetSectionPath(section), false);
+    sections_.clear();
+    dirty_.clear();
+    return false;
+  }
+
+ private:
+  void EnsureInitialized() {
+    if (initialized_)
+      return;
+    initialized_ = true;
+
+    if (!base::CreateDirectory(path_)) {
+      LOG(ERROR) << "Unable to create " << path_.value();
+      return;
+    }
+
+    // Only the journal is read up front, sections are read on first use.
+    base::FilePath journal_path = path_.Append(kJournalFileName);
+    std::string journal;
+    bool truncated = true;
+    if (base::ReadFileToString(journal_path, &journal)) {
+      // The last record may be cut short by a crash. It is dropped, or the
+      // next record would be appended to it and be lost as well.
+      size_t end = journal.rfind('\n');
+      end = end == std::string::npos ? 0 : end + 1;
+      if (end < journal.size()) {
+        journal.resize(end);
+        base::File file(journal_path,
+                        base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+        truncated = file.IsValid() && file.SetLength(end);
+      }
+
+      for (const base::StringPiece& line : base::SplitStringPiece(
+               journal, "\n", base::KEEP_WHITESPACE,
+               base::SPLIT_WANT_NONEMPTY)) {
+        std::unique_ptr<base::DictionaryValue> record =
+            base::DictionaryValue::From(base::JSONReader::Read(line));
+        std::string section;
+        if (!record ||
+            !record->GetStringWithoutPathExpansion(kSectionKey, &section) ||
+            !IsValidSectionName(section))
+          continue;
+        Apply(section, std::move(record));
+        dirty_.insert(section);
+      }
+      journal_size_ = journal.size();
+    }
+    has_data_ = !journal.empty() ||
+                !base::FileEnumerator(path_, false,
+                                      base::FileEnumerator::FILES,
+                                      FILE_PATH_LITERAL("*.json"))
+                     .Next()
+                     .empty();
+
+    journal_ = base::File(journal_path,
+                          base::File::FLAG_OPEN_ALWAYS |
+                          base::File::FLAG_APPEND);
+    if (!journal_.IsValid())
+      LOG(ERROR) << "Unable to open " << journal_path.value();
+    // Folding the journal rewrites it without the torn record. Until that
+    // works, records are written straight to their sections.
+    if (!truncated && !Compact())
+      journal_.Close();
+  }
+
+  base::FilePath GetSectionPath(const std::string& section) const {
+    return path_.AppendASCII(section).AddExtension(kSectionExtension);
+  }
+
+  // Returns the current value of |section|, reading it if necessary.
+  const base::Value* LoadSection(const std::string& section) {
+    auto it = sections_.find(section);
+    if (it != sections_.end())
+      return it->second.get();
+
+    std::unique_ptr<base::Value> value;
+    std::string data;
+    if (base::ReadFileToString(GetSectionPath(section), &data)) {
+      value = base::JSONReader::Read(data);
+      if (!value)
+        LOG(ERROR) << "Unable to parse app state section " << section;
+    }
+
+    auto pending = pending_.find(section);
+    if (pending != pending_.end()) {
+      for (const auto& record : pending->second)
+        ApplyRecord(*record, &value);
+      pending_.erase(pending);
+    }
+
+    const base::Value* result = value.get();
+    sections_[section] = std::move(value);
+    return result;
+  }
+
+  // Applies |record| to |section| if it has been read, otherwise keeps it
+  // until it is.
+  void Apply(const std::string& section,
+             std::unique_ptr<base::DictionaryValue> record) {
+    auto it = sections_.find(section);
+    if (it != sections_.end())
+      ApplyRecord(*record, &it->second);
+    else
+      pending_[section].push_back(std::move(record));
+  }
+
+  // Writes every section changed by the journal and empties it.
+  bool Compact() {
+    bool success = true;
+    for (const std::string& section : dirty_) {
+      const base::Value* value = LoadSection(section);
+      base::FilePath path = GetSectionPath(section);
+      std::string data;
+      if (!value) {
+        success &= base::DeleteFile(path, false);
+      } else if (base::JSONWriter::Write(*value, &data)) {
+        success &= base::ImportantFileWriter::WriteFileAtomically(path, data);
+      } else {
+        success = false;
+      }
+    }
+
+    // Keep the journal until every section it touched is safely written.
+    if (!success) {
+      LOG(ERROR) << "Unable to compact app state journal";
+      return false;
+    }
+
+    dirty_.clear();
+    journal_.Close();
+    base::FilePath journal_path = path_.Append(kJournalFileName);
+    if (base::WriteFile(journal_path, "", 0) != 0) {
+      LOG(ERROR) << "Unable to truncate " << journal_path.value();
+      return false;
+    }
+    journal_ = base::File(journal_path,
+                          base::File::FLAG_OPEN_ALWAYS |
+                          base::File::FLAG_APPEND);
+    journal_size_ = 0;
+    return true;
+  }
+
+  const base::FilePath path_;
+  bool initialized_;
+  // Whether anything has ever been written to the store.
+  bool has_data_;
+
+  // Sections that have been read, with the journal applied. Unset sections
+  // are kept as null.
+  std::map<std::string, std::unique_ptr<base::Value>> sections_;
+  // Journal records of sections that have not been read yet.
+  std::map<std::string,
+           std::vector<std::unique_ptr<base::DictionaryValue>>> pending_;
+  // Sections whose file is behind the journal.
+  std::set<std::string> dirty_;
+
+  base::File journal_;
+  int64_t journal_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(Backend);
+};
+
+AppStateStore::AppStateStore(
+    const base::FilePath& path,
+    scoped_refptr<base::SequencedTaskRunner> task_runner)
+    : task_runner_(task_runner),
+      backend_(new Backend(path)) {
+}
+
+AppStateStore::~AppStateStore() {
+  task_runner_->DeleteSoon(FROM_HERE, backend_.release());
+}
+
+// static
+bool AppStateStore::IsValidSectionName(const std::string& section) {
+  if (section.empty() || section.size() > kMaxSectionNameLength)
+    return false;
+  for (char c : section) {
+    if (!base::IsAsciiAlpha(c) && !base::IsAsciiDigit(c) && c != '-' &&
+        c != '_')
+      return false;
+  }
+  return true;
+}
+
+void AppStateStore::Get(const std::string& section,
+                        const GetCallback& callback) {
+  DCHECK(IsValidSectionName(section));
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::Bind(&Backend::Get, base::Unretained(backend_.get()), section),
+      callback);
+}
+
+void AppStateStore::Set(const std::string& section,
+                        std::unique_ptr<base::Value> value) {
+  DCHECK(IsValidSectionName(section));
+  std::unique_ptr<base::DictionaryValue> record(new base::DictionaryValue);
+  record->SetString(kSectionKey, section);
+  if (value)
+    record->SetWithoutPathExpansion(kValueKey, std::move(value));
+  Write(std::move(record));
+}
+
+void AppStateStore::SetKey(const std::string& section,
+                           const std::string& key,
+                           std::unique_ptr<base::Value> value) {
+  DCHECK(IsValidSectionName(section));
+  std::unique_ptr<base::DictionaryValue> record(new base::DictionaryValue);
+  record->SetString(kSectionKey, section);
+  record->SetString(kKeyKey, key);
+  if (value)
+    record->SetWithoutPathExpansion(kValueKey, std::move(value));
+  Write(std::move(record));
+}
+
+void AppStateStore::MigrateFrom(const base::DictionaryValue& app_state,
+                                const base::Callback<void(bool)>& callback) {
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::Bind(&Backend::Migrate, base::Unretained(backend_.get()),
+                 base::Passed(app_state.CreateDeepCopy())),
+      callback);
+}
+
+void AppStateStore::Write(std::unique_ptr<base::DictionaryValue> record) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&Backend::Write, base::Unretained(backend_.get()),
+                 base::Passed(&record)));
+}
+
+}  // namespace brave
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_BROWSER_APP_STATE_STORE_H_
+#define BRAVE_BROWSER_APP_STATE_STORE_H_
+
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+
+namespace base {
+class DictionaryValue;
+class SequencedTaskRunner;
+class Value;
+}
+
+namespace brave {
+
+// Persists the application state of a profile.
+//
+// The state is split into top level sections that are stored in their own
+// files and only read when they are first requested. Changes are appended to
+// a journal instead of rewriting the whole state, and the journal is folded
+// back into the section files once it grows large enough and when the store
+// is destroyed.
+//
+// All methods must be called on the UI thread, file access happens on
+// |task_runner|.
+class AppStateStore {
+ public:
+  typedef base::Callback<void(std::unique_ptr<base::Value>)> GetCallback;
+
+  AppStateStore(const base::FilePath& path,
+                scoped_refptr<base::SequencedTaskRunner> task_runner);
+  ~AppStateStore();
+
+  // Section names are limited to ASCII letters, digits, '-' and '_'.
+  static bool IsValidSectionName(const std::string& section);
+
+  // Calls |callback| with the value of |section|, or null if it is not set.
+  void Get(const std::string& section, const GetCallback& callback);
+
+  // Replaces |section| with |value|, a null |value| removes the section.
+  void Set(const std::string& section, std::unique_ptr<base::Value> value);
+
+  // Replaces |key| of |section| with |value|, a null |value| removes the key.
+  // A section that is not a dictionary is replaced by one.
+  void SetKey(const std::string& section,
+              const std::string& key,
+              std::unique_ptr<base::Value> value);
+
+  // Imports the sections of |app_state| if the store has never been written
+  // to, and calls |callback| with whether it did. A failed import leaves the
+  // store empty, so it can be tried again.
+  void MigrateFrom(const base::DictionaryValue& app_state,
+                   const base::Callback<void(bool)>& callback);
+
+ private:
+  class Backend;
+
+  void Write(std::unique_ptr<base::DictionaryValue> record);
+
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  // Deleted on |task_runner_|.
+  std::unique_ptr<Backend> backend_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppStateStore);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_APP_STATE_STORE_H_
@@ -13,6 +13,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/trace_event/trace_event.h"
+#include "brave/browser/app_state_store.h"
 #include "brave/browser/brave_permission_manager.h"
 #include "brave/browser/net/tor_proxy_network_delegate.h"
 #include "chrome/browser/background_fetch/background_fetch_delegate_factory.h"
@@ -47,11 +48,11 @@
 #include "components/zoom/zoom_event_manager.h"
 #include "components/webdata_services/web_data_service_wrapper.h"
 #include "components/webdata/common/webdata_constants.h"
-#include "content/browser/storage_partition_impl_map.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/notification_source.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/dom_storage_context.h"
+#include "content/public/browser/resource_hints.h"
 #include "content/public/browser/site_instance.h"
 #include "content/public/browser/storage_partition.h"
 #include "content/public/common/service_manager_connection.h"
@@ -60,7 +61,7 @@
 #include "extensions/buildflags/buildflags.h"
 #include "net/base/escape.h"
 #include "net/cookies/cookie_store.h"
-#include "net/proxy_resolution/proxy_resolution_service.h"
+#include "net/http/http_request_info.h"
 #include "net/url_request/url_request_context.h"
 #include "net/url_request/url_request_context_getter.h"
 #include "net/url_request/url_request_job_factory_impl.h"
@@ -151,6 +152,22 @@ std::string ExitTypeToSessionTypePrefValue(Profile::ExitType type) {
   return std::string();
 }
 
+// Opens a connection to |url| through the tor proxy of |getter|, which builds
+// the circuit the site's requests will use.
+void PrewarmTorOnIOThread(
+    scoped_refptr<net::URLRequestContextGetter> getter,
+    const GURL& url) {
+  net::URLRequestContext* context = getter->GetURLRequestContext();
+  if (!context)
+    return;
+  // Isolated storage partitions always get a TorProxyNetworkDelegate, see
+  // BraveBrowserContext::CreateNetworkDelegate.
+  static_cast<TorProxyNetworkDelegate*>(context->network_delegate())
+      ->ConfigureProxyService(context->proxy_resolution_service());
+  content::PreconnectUrl(getter.get(), url, url, 1, true,
+                         net::HttpRequestInfo::PRECONNECT_MOTIVATED);
+}
+
 }  // namespace
 
 const char kPersistPrefix[] = "persist:";
@@ -182,8 +199,10 @@ BraveBrowserContext::BraveBrowserContext(
           base::WaitableEvent::InitialState::NOT_SIGNALED)),
       isolated_storage_(false),
       in_memory_(in_memory),
+      tor_proxy_delegate_(this, &tor_proxy_map_),
       io_task_runner_(std::move(io_task_runner)),
-      delegate_(g_browser_process->profile_manager()) {
+      delegate_(g_browser_process->profile_manager()),
+      weak_ptr_factory_(this) {
   std::string parent_partition;
   if (options.GetString("parent_partition", &parent_partition)) {
     has_parent_ = true;
@@ -212,9 +231,14 @@ BraveBrowserContext::BraveBrowserContext(
         atom::AtomBrowserContext::From(partition, false));
     original_context_->otr_context_ = this;
   }
-  CreateProfilePrefs(io_task_runner_);
-  if (original_context_) {
-    TrackZoomLevelsFromParent();
+  // Off the record and child prefs are layered on top of the original prefs,
+  // which may still be loading in the background.
+  if (original_context_ && !original_context_->IsReady()) {
+    original_context_->RunWhenReady(base::Bind(
+        &BraveBrowserContext::OnOriginalContextReady,
+        weak_ptr_factory_.GetWeakPtr()));
+  } else {
+    OnOriginalContextReady();
   }
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   if (IsOffTheRecord()) {
@@ -245,9 +269,9 @@ BraveBrowserContext::~BraveBrowserContext() {
   #endif
 
   if (IsOffTheRecord()) {
-    auto user_prefs = user_prefs::UserPrefs::Get(this);
-    if (user_prefs)
-      user_prefs->ClearMutableValues();
+    // The prefs are not created yet if the original context never loaded.
+    if (user_prefs_)
+      user_prefs_->ClearMutableValues();
 #if BUILDFLAG(ENABLE_EXTENSIONS)
     ExtensionPrefValueMapFactory::GetForBrowserContext(
         original_context_)->ClearAllIncognitoSessionOnlyPreferences();
@@ -255,7 +279,8 @@ BraveBrowserContext::~BraveBrowserContext() {
   }
 
   if (!IsOffTheRecord() && !HasParentContext()) {
-    web_database_wrapper_->Shutdown();
+    if (web_database_wrapper_)
+      web_database_wrapper_->Shutdown();
 
     bool prefs_loaded = user_prefs_->GetInitializationStatus() !=
         PrefService::INITIALIZATION_STATUS_WAITING;
@@ -523,7 +548,14 @@ void BraveBrowserContext::CreateProfilePrefs(
 #endif
   user_prefs_registrar_.reset(new PrefChangeRegistrar());
 
-  bool async = false;
+  // Only the default profile is read in the background, it is created during
+  // startup and usually has the largest prefs. Other partitions are created
+  // on demand by sync calls that need their prefs right away. There is no
+  // startup-critical subset, the profile is ready once all of UserPrefs is
+  // loaded, see Browser::DidFinishLaunching.
+  bool async = partition_.empty() && !IsOffTheRecord() && !HasParentContext();
+
+  DCHECK(!original_context_ || original_context_->IsReady());
 
   if (IsOffTheRecord()) {
     overlay_pref_names_.push_back("app_state");
@@ -581,6 +613,9 @@ void BraveBrowserContext::CreateProfilePrefs(
     scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
         filepath, io_task_runner, std::unique_ptr<PrefFilter>());
 
+    app_state_store_.reset(new AppStateStore(
+        GetPath().Append(FILE_PATH_LITERAL("AppState")), io_task_runner));
+
     // prepare factory
     sync_preferences::PrefServiceSyncableFactory factory;
     factory.set_async(async);
@@ -599,7 +634,10 @@ void BraveBrowserContext::CreateProfilePrefs(
 }
 
 void BraveBrowserContext::OnPrefsLoaded(bool success) {
-  CHECK(success);
+  // Unreadable prefs fall back to the defaults, like they do when they are
+  // read synchronously.
+  if (!success)
+    LOG(ERROR) << "Unable to load the prefs of " << GetPath().value();
 
   BrowserContextDependencyManager::GetInstance()->
       CreateBrowserContextServices(this);
@@ -653,6 +691,36 @@ void BraveBrowserContext::OnPrefsLoaded(bool success) {
       chrome::NOTIFICATION_PROFILE_CREATED,
       content::Source<BraveBrowserContext>(this),
       content::NotificationService::NoDetails());
+
+  std::vector<base::Closure> callbacks;
+  callbacks.swap(ready_callbacks_);
+  for (const auto& callback : callbacks)
+    callback.Run();
+}
+
+void BraveBrowserContext::RunWhenReady(const base::Closure& callback) {
+  if (IsReady())
+    callback.Run();
+  else
+    ready_callbacks_.push_back(callback);
+}
+
+void BraveBrowserContext::OnOriginalContextReady() {
+  CreateProfilePrefs(io_task_runner_);
+  if (original_context_)
+    TrackZoomLevelsFromParent();
+}
+
+void BraveBrowserContext::MigrateAppStateFromPrefs(
+    const base::Callback<void(bool)>& callback) {
+  BraveBrowserContext* original = original_context();
+  const base::DictionaryValue* app_state =
+      original->user_prefs_->GetDictionary("app_state");
+  if (app_state->empty()) {
+    callback.Run(false);
+    return;
+  }
+  original->app_state_store_->MigrateFrom(*app_state, callback);
 }
 
 content::ResourceContext* BraveBrowserContext::GetResourceContext() {
@@ -730,28 +798,13 @@ void BraveBrowserContext::SetExitType(ExitType exit_type) {
 void BraveBrowserContext::SetTorNewIdentity(const GURL& url,
                                             const base::Closure& callback) {
   GURL site_url(content::SiteInstance::GetSiteForURL(this, url));
-  const std::string host = site_url.host();
-  base::FilePath partition_path = this->GetPath().Append(
-    content::StoragePartitionImplMap::GetStoragePartitionPath(host, host));
-  scoped_refptr<brightray::URLRequestContextGetter> url_request_context_getter;
-  StoragePartitionDescriptor descriptor(partition_path, true);
-    URLRequestContextGetterMap::iterator iter =
-      url_request_context_getter_map_.find(descriptor);
-  if (iter != url_request_context_getter_map_.end())
-    url_request_context_getter = (iter->second);
-  else
-    return;
-  auto proxy_resolution_service =
-    url_request_context_getter->GetURLRequestContext()->
-    proxy_resolution_service();
+  // The next request for the site picks a new password, and so a new
+  // circuit, without touching the proxy config.
   BrowserThread::PostTaskAndReply(
     BrowserThread::IO, FROM_HERE,
-    base::Bind(&net::ProxyConfigServiceTor::TorSetProxy,
-               proxy_resolution_service,
-               tor_proxy_,
-               host,
-               &tor_proxy_map_,
-               true),
+    base::Bind(&net::ProxyConfigServiceTor::TorProxyMap::Erase,
+               base::Unretained(&tor_proxy_map_),
+               site_url.host()),
     callback);
 }
 
@@ -773,6 +826,37 @@ int64_t BraveBrowserContext::GetTorPid() const {
     return -1;
 }
 
+void BraveBrowserContext::SetTorBootstrapCallback(
+    const TorLauncherFactory::TorBootstrapCallback& callback) {
+  if (tor_launcher_factory_.get())
+    tor_launcher_factory_->SetBootstrapCallback(callback);
+}
+
+int BraveBrowserContext::GetTorBootstrapProgress() const {
+  if (tor_launcher_factory_.get())
+    return tor_launcher_factory_->GetBootstrapProgress();
+  else
+    return 0;
+}
+
+bool BraveBrowserContext::IsTorReady() const {
+  return tor_launcher_factory_.get() && tor_launcher_factory_->IsReady();
+}
+
+void BraveBrowserContext::PrewarmTor(const GURL& url) {
+  if (!IsTorBrowserContext() || !isolated_storage_ ||
+      !url.SchemeIsHTTPOrHTTPS())
+    return;
+  GURL site_url(content::SiteInstance::GetSiteForURL(this, url));
+  content::StoragePartition* partition =
+      content::BrowserContext::GetStoragePartitionForSite(this, site_url);
+  BrowserThread::PostTask(
+    BrowserThread::IO, FROM_HERE,
+    base::Bind(&PrewarmTorOnIOThread,
+               base::WrapRefCounted(partition->GetURLRequestContext()),
+               url));
+}
+
 scoped_refptr<base::SequencedTaskRunner>
 BraveBrowserContext::GetIOTaskRunner() {
   return io_task_runner_;
@@ -11,8 +11,10 @@
 #include <vector>
 
 #include "atom/browser/atom_browser_context.h"
+#include "base/memory/weak_ptr.h"
 #include "brave/browser/tor/tor_launcher_factory.h"
 #include "brave/browser/net/proxy_resolution/proxy_config_service_tor.h"
+#include "brave/browser/net/proxy_resolution/proxy_delegate_tor.h"
 #include "content/public/browser/host_zoom_map.h"
 #include "chrome/browser/custom_handlers/protocol_handler_registry.h"
 #include "chrome/browser/profiles/storage_partition_descriptor.h"
@@ -41,6 +43,7 @@ class PrefRegistrySyncable;
 
 namespace brave {
 
+class AppStateStore;
 class BravePermissionManager;
 
 class BraveBrowserContext : public Profile {
@@ -124,9 +127,21 @@ class BraveBrowserContext : public Profile {
   PrefChangeRegistrar* user_prefs_change_registrar() const override {
     return user_prefs_registrar_.get(); }
 
+  // Shared with the off the record and child contexts.
+  AppStateStore* app_state_store() {
+    return original_context()->app_state_store_.get(); }
+  // Imports the "app_state" pref into the app state store if the store has
+  // never been written to. The pref is left for its other readers.
+  void MigrateAppStateFromPrefs(const base::Callback<void(bool)>& callback);
+
   const std::string& partition() const { return partition_; }
   std::string partition_with_prefix();
-  base::WaitableEvent* ready() { return ready_.get(); }
+
+  // Whether the profile prefs have been loaded.
+  bool IsReady() const { return ready_->IsSignaled(); }
+  // Runs |callback| once the profile prefs have been loaded, or right away if
+  // they already are.
+  void RunWhenReady(const base::Closure& callback);
 
   void AddOverlayPref(const std::string name) override {
     overlay_pref_names_.push_back(name.c_str()); }
@@ -156,6 +171,9 @@ class BraveBrowserContext : public Profile {
   net::ProxyConfigServiceTor::TorProxyMap* tor_proxy_map() {
     return &tor_proxy_map_; }
 
+  net::ProxyDelegateTor* tor_proxy_delegate() {
+    return &tor_proxy_delegate_; }
+
   void RelaunchTor() const;
 
   void SetTorLauncherCallback(
@@ -163,12 +181,24 @@ class BraveBrowserContext : public Profile {
 
   int64_t GetTorPid() const;
 
+  void SetTorBootstrapCallback(
+      const TorLauncherFactory::TorBootstrapCallback& callback);
+
+  int GetTorBootstrapProgress() const;
+
+  bool IsTorReady() const;
+
+  // Builds the circuit for |url|'s site ahead of the first request.
+  void PrewarmTor(const GURL& url);
+
  private:
     typedef std::map<StoragePartitionDescriptor,
                      scoped_refptr<brightray::URLRequestContextGetter>,
                      StoragePartitionDescriptorLess>
       URLRequestContextGetterMap;
   void OnPrefsLoaded(bool success);
+  // Creates the prefs once those of the original context can be layered on.
+  void OnOriginalContextReady();
   void TrackZoomLevelsFromParent();
   void OnParentZoomLevelChanged(
       const content::HostZoomMap::ZoomLevelChange& change);
@@ -178,6 +208,7 @@ class BraveBrowserContext : public Profile {
   std::unique_ptr<sync_preferences::PrefServiceSyncable> user_prefs_;
   std::unique_ptr<PrefChangeRegistrar> user_prefs_registrar_;
   std::vector<const char*> overlay_pref_names_;
+  std::unique_ptr<AppStateStore> app_state_store_;
 
   std::unique_ptr<content::HostZoomMap::Subscription> track_zoom_subscription_;
     std::unique_ptr<ChromeZoomLevelPrefs::DefaultZoomLevelSubscription>
@@ -190,11 +221,14 @@ class BraveBrowserContext : public Profile {
   BraveBrowserContext* otr_context_;
   const std::string partition_;
   std::unique_ptr<base::WaitableEvent> ready_;
+  std::vector<base::Closure> ready_callbacks_;
   bool isolated_storage_;
   bool in_memory_;
   std::string tor_proxy_;
 
   net::ProxyConfigServiceTor::TorProxyMap tor_proxy_map_;
+  // Shared by the request contexts of every storage partition.
+  net::ProxyDelegateTor tor_proxy_delegate_;
 
   URLRequestContextGetterMap url_request_context_getter_map_;
 
@@ -209,6 +243,8 @@ class BraveBrowserContext : public Profile {
   extensions::InfoMap* info_map_;  // not owned
   Profile::Delegate* delegate_;
 
+  base::WeakPtrFactory<BraveBrowserContext> weak_ptr_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(BraveBrowserContext);
 };
 
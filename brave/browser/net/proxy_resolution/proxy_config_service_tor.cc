@@ -29,9 +29,7 @@ const int kTorPasswordLength = 16;
 // Default tor circuit life time is 10 minutes
 constexpr base::TimeDelta kTenMins = base::TimeDelta::FromMinutes(10);
 
-ProxyConfigServiceTor::ProxyConfigServiceTor(
-  const std::string& tor_proxy, const std::string& username,
-  TorProxyMap* tor_proxy_map) {
+ProxyConfigServiceTor::ProxyConfigServiceTor(const std::string& tor_proxy) {
     if (tor_proxy.length()) {
       url::Parsed url;
       url::ParseStandardURL(
@@ -54,33 +52,24 @@ ProxyConfigServiceTor::ProxyConfigServiceTor(
           std::string(tor_proxy.begin() + url.port.begin,
                       tor_proxy.begin() + url.port.begin + url.port.len);
       }
-      std::string proxy_url;
-      if (tor_proxy_map && !username.empty()) {
-        std::string password = tor_proxy_map->Get(username);
-        proxy_url = std::string(scheme_ + "://" + username + ":" + password +
-                                "@" + host_ + ":" + port_);
-      } else {
-        proxy_url = std::string(scheme_ + "://" + host_ + ":" + port_);
-      }
-      config_.proxy_rules().ParseFromString(proxy_url);
+      config_.proxy_rules().ParseFromString(
+          std::string(scheme_ + "://" + host_ + ":" + port_));
     }
 }
 
 ProxyConfigServiceTor::~ProxyConfigServiceTor() {}
 
+// static
 void ProxyConfigServiceTor::TorSetProxy(
     net::ProxyResolutionService* service,
     const std::string& tor_proxy,
-    const std::string& site_url,
-    TorProxyMap* tor_proxy_map,
-    bool new_password) {
+    ProxyDelegate* delegate) {
   if (!service)
     return;
-  if (new_password && tor_proxy_map)
-    tor_proxy_map->Erase(site_url);
   std::unique_ptr<net::ProxyConfigServiceTor>
-    config(new ProxyConfigServiceTor(tor_proxy, site_url, tor_proxy_map));
+    config(new ProxyConfigServiceTor(tor_proxy));
   service->ResetConfigService(std::move(config));
+  service->SetProxyDelegate(delegate);
 }
 
 ProxyConfigServiceTor::ConfigAvailability
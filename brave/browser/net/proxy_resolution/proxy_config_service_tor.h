@@ -24,6 +24,9 @@ class Time;
 
 namespace net {
 
+class ProxyDelegate;
+class ProxyResolutionService;
+
 const char kSocksProxy[] = "socks5";
 
 // Implementation of ProxyConfigService that returns a tor specific result.
@@ -47,17 +50,15 @@ class NET_EXPORT ProxyConfigServiceTor : public ProxyConfigService {
     DISALLOW_COPY_AND_ASSIGN(TorProxyMap);
   };
 
-  explicit ProxyConfigServiceTor(const std::string& tor_proxy,
-                                 const std::string& username,
-                                 TorProxyMap* map);
+  explicit ProxyConfigServiceTor(const std::string& tor_proxy);
   ~ProxyConfigServiceTor() override;
 
+  // Points |service| at |tor_proxy| for good, |delegate| adds the per-site
+  // credentials to every request.
   static void TorSetProxy(
     net::ProxyResolutionService* service,
     const std::string& tor_proxy,
-    const std::string& site_url,
-    TorProxyMap* tor_proxy_map,
-    bool new_password);
+    ProxyDelegate* delegate);
 
   // ProxyConfigService methods:
   void AddObserver(Observer* observer) override {}
@@ -0,0 +1,52 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/browser/net/proxy_resolution/proxy_delegate_tor.h"
+
+#include "content/public/browser/site_instance.h"
+#include "extensions/common/constants.h"
+#include "net/base/proxy_server.h"
+#include "net/base/url_util.h"
+#include "net/proxy_resolution/proxy_info.h"
+#include "url/gurl.h"
+
+namespace net {
+
+ProxyDelegateTor::ProxyDelegateTor(
+    content::BrowserContext* browser_context,
+    ProxyConfigServiceTor::TorProxyMap* tor_proxy_map)
+    : browser_context_(browser_context),
+      tor_proxy_map_(tor_proxy_map) {
+}
+
+ProxyDelegateTor::~ProxyDelegateTor() {
+}
+
+void ProxyDelegateTor::OnResolveProxy(
+    const GURL& url,
+    const std::string& method,
+    const ProxyRetryInfoMap& proxy_retry_info,
+    ProxyInfo* result) {
+  if (result->is_empty() || !result->proxy_server().is_socks())
+    return;
+
+  GURL site_url(content::SiteInstance::GetSiteForURL(browser_context_, url));
+  if (site_url.SchemeIs(extensions::kExtensionScheme) ||
+      net::IsLocalhost(site_url) || site_url.host().empty())
+    return;
+
+  // The credentials become part of the proxy's host, so every site also gets
+  // its own group of sockets.
+  const std::string& username = site_url.host();
+  result->UseNamedProxy(
+      std::string(kSocksProxy) + "://" + username + ":" +
+      tor_proxy_map_->Get(username) + "@" +
+      result->proxy_server().host_port_pair().ToString());
+}
+
+void ProxyDelegateTor::OnFallback(const ProxyServer& bad_proxy,
+                                  int net_error) {
+}
+
+}  // namespace net
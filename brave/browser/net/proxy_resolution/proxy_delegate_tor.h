@@ -0,0 +1,47 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_BROWSER_NET_PROXY_RESOLUTION_PROXY_DELEGATE_TOR_H_
+#define BRAVE_BROWSER_NET_PROXY_RESOLUTION_PROXY_DELEGATE_TOR_H_
+
+#include <string>
+
+#include "base/macros.h"
+#include "brave/browser/net/proxy_resolution/proxy_config_service_tor.h"
+#include "net/base/proxy_delegate.h"
+
+namespace content {
+class BrowserContext;
+}
+
+namespace net {
+
+// Isolates the tor circuits of different sites.
+//
+// Every request context of a tor browser context resolves to the same tor
+// proxy, and this adds per-site SOCKS credentials to each resolved request so
+// tor uses a separate circuit for every site. Must be used on the IO thread.
+class ProxyDelegateTor : public ProxyDelegate {
+ public:
+  ProxyDelegateTor(content::BrowserContext* browser_context,
+                   ProxyConfigServiceTor::TorProxyMap* tor_proxy_map);
+  ~ProxyDelegateTor() override;
+
+  // ProxyDelegate:
+  void OnResolveProxy(const GURL& url,
+                      const std::string& method,
+                      const ProxyRetryInfoMap& proxy_retry_info,
+                      ProxyInfo* result) override;
+  void OnFallback(const ProxyServer& bad_proxy, int net_error) override;
+
+ private:
+  content::BrowserContext* browser_context_;  // not owned
+  ProxyConfigServiceTor::TorProxyMap* tor_proxy_map_;  // not owned
+
+  DISALLOW_COPY_AND_ASSIGN(ProxyDelegateTor);
+};
+
+}  // namespace net
+
+#endif  // BRAVE_BROWSER_NET_PROXY_RESOLUTION_PROXY_DELEGATE_TOR_H_
@@ -6,9 +6,6 @@
 
 #include "brave/browser/net/proxy_resolution/proxy_config_service_tor.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/site_instance.h"
-#include "extensions/common/constants.h"
-#include "net/base/url_util.h"
 #include "net/url_request/url_request.h"
 #include "net/url_request/url_request_context.h"
 
@@ -36,40 +33,26 @@ int TorProxyNetworkDelegate::OnBeforeURLRequest(
                                                                        new_url);
 }
 
-int TorProxyNetworkDelegate::OnBeforeStartTransaction(
-    net::URLRequest* request,
-    const net::CompletionCallback& callback,
-    net::HttpRequestHeaders* headers) {
-  ConfigTorProxyInteral(request);
-  return extensions::AtomExtensionsNetworkDelegate::
-    OnBeforeStartTransaction(request,
-                             callback,
-                             headers);
-}
-
-void TorProxyNetworkDelegate::OnBeforeRedirect(
-    net::URLRequest* request,
-    const GURL& new_location) {
-  ConfigTorProxyInteral(request);
-  extensions::AtomExtensionsNetworkDelegate::OnBeforeRedirect(request,
-                                                              new_location);
-}
-
 void TorProxyNetworkDelegate::ConfigTorProxyInteral(net::URLRequest* request) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
   if (!request)
     return;
-  auto proxy_service = request->context()->proxy_resolution_service();
-  GURL url(content::SiteInstance::GetSiteForURL(browser_context_,
-                                                     request->url()));
-  if (!url.SchemeIs(extensions::kExtensionScheme) && !net::IsLocalhost(url) &&
-      !url.host().empty())
-    BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
-                            base::Bind(&net::ProxyConfigServiceTor::TorSetProxy,
-                                       proxy_service,
-                                       browser_context_->tor_proxy(),
-                                       url.host(),
-                                       browser_context_->tor_proxy_map(),
-                                       false));
+  ConfigureProxyService(request->context()->proxy_resolution_service());
+}
+
+void TorProxyNetworkDelegate::ConfigureProxyService(
+    net::ProxyResolutionService* proxy_service) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!proxy_service || !configured_services_.insert(proxy_service).second)
+    return;
+
+  // Proxies are resolved after OnBeforeURLRequest, so this is in time for
+  // the first request. The config never changes afterwards, the circuit of
+  // each request is picked by the proxy delegate.
+  net::ProxyConfigServiceTor::TorSetProxy(
+      proxy_service,
+      browser_context_->tor_proxy(),
+      browser_context_->tor_proxy_delegate());
 }
 
 }  // namespace brave
@@ -5,6 +5,8 @@
 #ifndef BRAVE_BROWSER_NET_TOR_PROXY_NETWORK_DELEGATE_H_
 #define BRAVE_BROWSER_NET_TOR_PROXY_NETWORK_DELEGATE_H_
 
+#include <set>
+
 #include "atom/browser/extensions/atom_extensions_network_delegate.h"
 #include "brave/browser/brave_browser_context.h"
 
@@ -13,6 +15,10 @@ class EventRouterForwarder;
 class InfoMap;
 }
 
+namespace net {
+class ProxyResolutionService;
+}
+
 namespace brave {
 
 class TorProxyNetworkDelegate :
@@ -24,21 +30,24 @@ class TorProxyNetworkDelegate :
       extensions::EventRouterForwarder* event_router);
   ~TorProxyNetworkDelegate() override;
 
+  // Routes |proxy_service| through tor, unless it already is. Connections
+  // that skip OnBeforeURLRequest, like preconnects, need this beforehand.
+  void ConfigureProxyService(net::ProxyResolutionService* proxy_service);
+
  private:
   // NetworkDelegate implementation.
   int OnBeforeURLRequest(net::URLRequest* request,
                          const net::CompletionCallback& callback,
                          GURL* new_url) override;
-  int OnBeforeStartTransaction(net::URLRequest* request,
-                               const net::CompletionCallback& callback,
-                               net::HttpRequestHeaders* headers) override;
-  void OnBeforeRedirect(net::URLRequest* request,
-                        const GURL& new_location) override;
 
+  // Sets up the proxy of the request's context the first time it is seen.
   void ConfigTorProxyInteral(net::URLRequest* request);
 
   BraveBrowserContext* browser_context_;
 
+  // Proxy services of the storage partitions that have been set up.
+  std::set<net::ProxyResolutionService*> configured_services_;
+
   DISALLOW_COPY_AND_ASSIGN(TorProxyNetworkDelegate);
 };
 
@@ -0,0 +1,254 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/browser/shared_memory_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "base/memory/shared_memory.h"
+#include "base/pickle.h"
+
+namespace brave {
+
+namespace {
+
+// Segments hold a base::Pickle with the length of the serialized value
+// followed by the value itself, see Converter<base::SharedMemory*>.
+const size_t kHeaderSize = sizeof(base::Pickle::Header) + sizeof(int);
+
+const size_t kMinSegmentSize = 64 * 1024;
+// Larger values are sent in one-off segments, so that a single large value
+// doesn't pin its memory for the lifetime of the channel.
+const size_t kMaxSegmentSize = 1024 * 1024;
+const size_t kMaxSegmentsPerChannel = 4;
+const size_t kMaxChannels = 8;
+
+size_t AlignToPickle(size_t size) {
+  return (size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+}
+
+// Space left for the value in a segment of |size| bytes.
+size_t GetCapacity(size_t size) {
+  return (size - kHeaderSize) & ~(sizeof(uint32_t) - 1);
+}
+
+std::unique_ptr<base::SharedMemory> CreateMemory(size_t size) {
+  std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory);
+  base::SharedMemoryCreateOptions options;
+  options.size = size;
+  options.share_read_only = true;
+  if (!memory->Create(options) || !memory->Map(size))
+    return nullptr;
+  return memory;
+}
+
+// Lets the serializer write straight into a segment, moving to the heap only
+// when the value doesn't fit.
+class SegmentSerializerDelegate : public v8::ValueSerializer::Delegate {
+ public:
+  SegmentSerializerDelegate(v8::Isolate* isolate,
+                            uint8_t* segment,
+                            size_t capacity)
+      : isolate_(isolate), segment_(segment), capacity_(capacity) {}
+
+  // v8::ValueSerializer::Delegate:
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+  void* ReallocateBufferMemory(void* old_buffer,
+                               size_t size,
+                               size_t* actual_size) override {
+    void* buffer = nullptr;
+    if (old_buffer && old_buffer != segment_) {
+      buffer = realloc(old_buffer, size);
+    } else if (size <= capacity_) {
+      *actual_size = capacity_;
+      return segment_;
+    } else {
+      buffer = malloc(size);
+      if (buffer && old_buffer)
+        memcpy(buffer, segment_, capacity_);
+    }
+    if (buffer)
+      *actual_size = size;
+    return buffer;
+  }
+
+  void FreeBufferMemory(void* buffer) override {
+    if (buffer != segment_)
+      free(buffer);
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  uint8_t* segment_;
+  size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentSerializerDelegate);
+};
+
+}  // namespace
+
+struct SharedMemoryPool::Segment {
+  uint32_t id;
+  // Whether the receiver may still be reading the segment.
+  bool busy;
+  std::unique_ptr<base::SharedMemory> memory;
+};
+
+SharedMemoryPool::Ring::Ring() : last_used(0) {
+}
+
+SharedMemoryPool::Ring::Ring(Ring&& other) = default;
+
+SharedMemoryPool::Ring::~Ring() {
+}
+
+SharedMemoryPool::SharedMemoryPool() : next_segment_id_(1), clock_(0) {
+}
+
+SharedMemoryPool::~SharedMemoryPool() {
+}
+
+bool SharedMemoryPool::Write(v8::Isolate* isolate,
+                             const base::string16& channel,
+                             v8::Local<v8::Value> value,
+                             uint32_t* segment_id,
+                             base::SharedMemoryHandle* handle) {
+  Segment* segment = AcquireSegment(channel);
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+  if (segment) {
+    data = static_cast<uint8_t*>(segment->memory->memory()) + kHeaderSize;
+    capacity = GetCapacity(segment->memory->mapped_size());
+  }
+
+  SegmentSerializerDelegate delegate(isolate, data, capacity);
+  v8::ValueSerializer serializer(isolate, &delegate);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(isolate->GetCurrentContext(), value)
+           .FromMaybe(false))
+    return false;
+
+  std::pair<uint8_t*, size_t> buf = serializer.Release();
+  if (buf.second > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    delegate.FreeBufferMemory(buf.first);
+    return false;
+  }
+
+  std::unique_ptr<base::SharedMemory> one_off;
+  base::SharedMemory* memory = segment ? segment->memory.get() : nullptr;
+  if (buf.first != data) {
+    // The value outgrew the segment, replace it with one that fits so the
+    // next value of this size is written in place.
+    size_t size = kMinSegmentSize;
+    while (GetCapacity(size) < buf.second)
+      size *= 2;
+    std::unique_ptr<base::SharedMemory> larger = CreateMemory(size);
+    if (!larger) {
+      delegate.FreeBufferMemory(buf.first);
+      return false;
+    }
+    memcpy(static_cast<uint8_t*>(larger->memory()) + kHeaderSize, buf.first,
+           buf.second);
+    delegate.FreeBufferMemory(buf.first);
+
+    memory = larger.get();
+    if (size > kMaxSegmentSize)
+      segment = nullptr;
+    if (segment)
+      segment->memory = std::move(larger);
+    else
+      one_off = std::move(larger);
+  }
+
+  base::Pickle::Header* header =
+      static_cast<base::Pickle::Header*>(memory->memory());
+  header->payload_size = sizeof(int) + AlignToPickle(buf.second);
+  *reinterpret_cast<int*>(header + 1) = static_cast<int>(buf.second);
+
+  *handle = memory->GetReadOnlyHandle();
+  if (!handle->IsValid())
+    return false;
+
+  if (segment) {
+    segment->busy = true;
+    *segment_id = segment->id;
+  } else {
+    *segment_id = kUnpooledSegmentId;
+  }
+  return true;
+}
+
+void SharedMemoryPool::Release(const base::string16& channel,
+                               uint32_t segment_id) {
+  auto ring = rings_.find(channel);
+  if (ring == rings_.end())
+    return;
+
+  for (const auto& segment : ring->second.segments) {
+    if (segment->id == segment_id) {
+      segment->busy = false;
+      return;
+    }
+  }
+}
+
+SharedMemoryPool::Segment* SharedMemoryPool::AcquireSegment(
+    const base::string16& channel) {
+  Ring* ring = GetRing(channel);
+  if (!ring)
+    return nullptr;
+
+  ring->last_used = ++clock_;
+  for (const auto& segment : ring->segments) {
+    if (!segment->busy)
+      return segment.get();
+  }
+  if (ring->segments.size() >= kMaxSegmentsPerChannel)
+    return nullptr;
+
+  std::unique_ptr<base::SharedMemory> memory = CreateMemory(kMinSegmentSize);
+  if (!memory)
+    return nullptr;
+
+  if (next_segment_id_ == kUnpooledSegmentId)
+    ++next_segment_id_;
+  ring->segments.push_back(std::unique_ptr<Segment>(
+      new Segment{next_segment_id_++, false, std::move(memory)}));
+  return ring->segments.back().get();
+}
+
+SharedMemoryPool::Ring* SharedMemoryPool::GetRing(
+    const base::string16& channel) {
+  auto it = rings_.find(channel);
+  if (it != rings_.end())
+    return &it->second;
+
+  if (rings_.size() >= kMaxChannels) {
+    auto oldest = rings_.end();
+    for (auto ring = rings_.begin(); ring != rings_.end(); ++ring) {
+      bool idle = std::none_of(
+          ring->second.segments.begin(), ring->second.segments.end(),
+          [](const std::unique_ptr<Segment>& segment) {
+            return segment->busy;
+          });
+      if (idle && (oldest == rings_.end() ||
+                   ring->second.last_used < oldest->second.last_used))
+        oldest = ring;
+    }
+    if (oldest == rings_.end())
+      return nullptr;
+    rings_.erase(oldest);
+  }
+  return &rings_[channel];
+}
+
+}  // namespace brave
@@ -0,0 +1,78 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_BROWSER_SHARED_MEMORY_POOL_H_
+#define BRAVE_BROWSER_SHARED_MEMORY_POOL_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/shared_memory_handle.h"
+#include "base/strings/string16.h"
+#include "v8/include/v8.h"
+
+namespace brave {
+
+// Reusable shared memory segments for values sent with sendShared.
+//
+// Recently used channels have a small ring of segments. A value is serialized
+// straight into a free segment in the layout SharedMemoryWrapper reads, and
+// the segment stays busy until the receiver acknowledges it with Release().
+// When every segment of a channel is busy, or the value is too large to be
+// worth keeping around, a one-off segment is used instead.
+class SharedMemoryPool {
+ public:
+  // The id of one-off segments, which don't need to be released.
+  static const uint32_t kUnpooledSegmentId = 0;
+
+  SharedMemoryPool();
+  ~SharedMemoryPool();
+
+  // Writes |value| to a segment of |channel| and returns the segment's id
+  // and a read-only handle for the receiver. Returns false if |value| can't
+  // be serialized, in which case the serializer's exception is left pending
+  // on |isolate|, or if no memory is available.
+  bool Write(v8::Isolate* isolate,
+             const base::string16& channel,
+             v8::Local<v8::Value> value,
+             uint32_t* segment_id,
+             base::SharedMemoryHandle* handle);
+
+  // Makes a segment written by Write() available again.
+  void Release(const base::string16& channel, uint32_t segment_id);
+
+ private:
+  struct Segment;
+
+  struct Ring {
+    Ring();
+    Ring(Ring&& other);
+    ~Ring();
+
+    std::vector<std::unique_ptr<Segment>> segments;
+    // Value of |clock_| when the ring was last written to.
+    uint64_t last_used;
+  };
+
+  // Returns a free segment of |channel|, or null if there is none.
+  Segment* AcquireSegment(const base::string16& channel);
+
+  // Returns the ring of |channel|, making room for it by dropping the least
+  // recently used idle ring if needed. Returns null if every ring is busy.
+  Ring* GetRing(const base::string16& channel);
+
+  std::map<base::string16, Ring> rings_;
+  uint32_t next_segment_id_;
+  uint64_t clock_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryPool);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_SHARED_MEMORY_POOL_H_
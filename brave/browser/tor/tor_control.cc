@@ -0,0 +1,292 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/browser/tor/tor_control.h"
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/task_scheduler/post_task.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/address_list.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_address.h"
+#include "net/base/net_errors.h"
+#include "net/log/net_log_source.h"
+#include "net/socket/tcp_client_socket.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+
+using content::BrowserThread;
+
+namespace brave {
+
+namespace {
+
+const base::FilePath::CharType kControlPortFile[] =
+    FILE_PATH_LITERAL("controlport");
+const base::FilePath::CharType kControlCookieFile[] =
+    FILE_PATH_LITERAL("control_auth_cookie");
+
+// Tor needs a moment after launching to write its files, and files left
+// behind by a previous process fail to connect until they are replaced.
+const int kRetryDelayMs = 250;
+const int kMaxAttempts = 240;
+
+const size_t kCookieLength = 32;
+const int kReadBufferSize = 4096;
+// Control connections never need long lines, so anything longer is garbage.
+const size_t kMaxLineLength = 64 * 1024;
+
+// Parses "PORT=<ip>:<port>" as written by --controlportwritetofile.
+bool ParseControlPort(const std::string& contents, net::IPEndPoint* out) {
+  std::string value;
+  base::TrimWhitespaceASCII(contents, base::TRIM_ALL, &value);
+  if (!base::StartsWith(value, "PORT=", base::CompareCase::SENSITIVE))
+    return false;
+  value = value.substr(5);
+
+  size_t colon = value.rfind(':');
+  net::IPAddress address;
+  int port;
+  if (colon == std::string::npos ||
+      !address.AssignFromIPLiteral(value.substr(0, colon)) ||
+      !base::StringToInt(value.substr(colon + 1), &port) || port <= 0 ||
+      port > 65535)
+    return false;
+
+  *out = net::IPEndPoint(address, static_cast<uint16_t>(port));
+  return true;
+}
+
+// Extracts the progress and summary of a BOOTSTRAP status, which looks like
+// "... BOOTSTRAP PROGRESS=80 TAG=conn_or SUMMARY="Connecting to the network"".
+bool ParseBootstrapStatus(const std::string& line,
+                          int* progress,
+                          std::string* summary) {
+  size_t start = line.find(" BOOTSTRAP ");
+  if (start == std::string::npos)
+    return false;
+
+  const char kProgress[] = "PROGRESS=";
+  size_t begin = line.find(kProgress, start);
+  if (begin == std::string::npos)
+    return false;
+  begin += arraysize(kProgress) - 1;
+  size_t end = line.find(' ', begin);
+  if (!base::StringToInt(line.substr(begin, end - begin), progress))
+    return false;
+
+  summary->clear();
+  const char kSummary[] = "SUMMARY=\"";
+  begin = line.find(kSummary, start);
+  if (begin != std::string::npos) {
+    begin += arraysize(kSummary) - 1;
+    end = line.find('"', begin);
+    if (end != std::string::npos)
+      *summary = line.substr(begin, end - begin);
+  }
+  return true;
+}
+
+}  // namespace
+
+struct TorControl::ControlInfo {
+  net::IPEndPoint endpoint;
+  std::string cookie;
+};
+
+// static
+std::unique_ptr<TorControl::ControlInfo> TorControl::ReadControlInfoFiles(
+    const base::FilePath& watch_dir) {
+  std::string port;
+  std::string cookie;
+  std::unique_ptr<ControlInfo> info(new ControlInfo);
+  if (!base::ReadFileToString(watch_dir.Append(kControlPortFile), &port) ||
+      !ParseControlPort(port, &info->endpoint) ||
+      !base::ReadFileToString(watch_dir.Append(kControlCookieFile), &cookie) ||
+      cookie.size() != kCookieLength)
+    return nullptr;
+
+  info->cookie = base::HexEncode(cookie.data(), cookie.size());
+  return info;
+}
+
+TorControl::TorControl(const ProgressCallback& callback)
+    : callback_(callback),
+      attempts_(0),
+      progress_(0),
+      weak_ptr_factory_(this) {
+}
+
+TorControl::~TorControl() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+}
+
+void TorControl::Start(const base::FilePath& watch_dir) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  Stop();
+  watch_dir_ = watch_dir;
+  if (watch_dir_.empty())
+    return;
+  ReadControlInfo();
+}
+
+void TorControl::Stop() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  weak_ptr_factory_.InvalidateWeakPtrs();
+  retry_timer_.Stop();
+  socket_.reset();
+  write_buffer_ = nullptr;
+  read_buffer_ = nullptr;
+  pending_.clear();
+  attempts_ = 0;
+  ReportProgress(0, std::string());
+}
+
+void TorControl::ReadControlInfo() {
+  ++attempts_;
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE,
+      {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      base::BindOnce(&ReadControlInfoFiles, watch_dir_),
+      base::BindOnce(&TorControl::OnControlInfoRead,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
+
+void TorControl::OnControlInfoRead(std::unique_ptr<ControlInfo> info) {
+  if (!info) {
+    Retry();
+    return;
+  }
+
+  // Commands are pipelined, tor answers them in order and closes the
+  // connection if authentication fails.
+  std::string commands = "AUTHENTICATE " + info->cookie + "\r\n"
+                         "SETEVENTS STATUS_CLIENT\r\n"
+                         "GETINFO status/bootstrap-phase\r\n";
+  scoped_refptr<net::StringIOBuffer> buffer(
+      new net::StringIOBuffer(commands));
+  write_buffer_ = new net::DrainableIOBuffer(buffer.get(), buffer->size());
+  read_buffer_ = new net::IOBufferWithSize(kReadBufferSize);
+
+  socket_.reset(new net::TCPClientSocket(net::AddressList(info->endpoint),
+                                         nullptr, nullptr,
+                                         net::NetLogSource()));
+  int result = socket_->Connect(base::Bind(&TorControl::OnConnected,
+                                           weak_ptr_factory_.GetWeakPtr()));
+  if (result != net::ERR_IO_PENDING)
+    OnConnected(result);
+}
+
+void TorControl::OnConnected(int result) {
+  if (result != net::OK) {
+    Retry();
+    return;
+  }
+  DoWrite();
+  if (socket_)
+    DoRead();
+}
+
+void TorControl::DoWrite() {
+  int result = socket_->Write(write_buffer_.get(),
+                              write_buffer_->BytesRemaining(),
+                              base::Bind(&TorControl::OnWritten,
+                                         weak_ptr_factory_.GetWeakPtr()),
+                              NO_TRAFFIC_ANNOTATION_YET);
+  if (result != net::ERR_IO_PENDING)
+    OnWritten(result);
+}
+
+void TorControl::OnWritten(int result) {
+  if (result <= 0) {
+    Retry();
+    return;
+  }
+  write_buffer_->DidConsume(result);
+  if (write_buffer_->BytesRemaining() > 0)
+    DoWrite();
+}
+
+void TorControl::DoRead() {
+  // Completed reads are handled in a loop to keep the stack flat.
+  while (true) {
+    int result = socket_->Read(read_buffer_.get(), read_buffer_->size(),
+                               base::Bind(&TorControl::OnRead,
+                                          weak_ptr_factory_.GetWeakPtr()));
+    if (result == net::ERR_IO_PENDING || !HandleReadResult(result))
+      return;
+  }
+}
+
+void TorControl::OnRead(int result) {
+  if (HandleReadResult(result))
+    DoRead();
+}
+
+bool TorControl::HandleReadResult(int result) {
+  if (result <= 0) {
+    Retry();
+    return false;
+  }
+
+  pending_.append(read_buffer_->data(), result);
+  size_t end;
+  while ((end = pending_.find("\r\n")) != std::string::npos) {
+    std::string line = pending_.substr(0, end);
+    pending_.erase(0, end + 2);
+    HandleLine(line);
+    if (!socket_)
+      return false;
+  }
+  if (pending_.size() > kMaxLineLength) {
+    Retry();
+    return false;
+  }
+  return true;
+}
+
+void TorControl::HandleLine(const std::string& line) {
+  // 4xx and 5xx replies mean a command failed, most likely because the cookie
+  // belongs to a previous process.
+  if (line.empty() || line[0] == '4' || line[0] == '5') {
+    LOG(ERROR) << "Tor control: " << line;
+    Retry();
+    return;
+  }
+
+  int progress;
+  std::string summary;
+  if (ParseBootstrapStatus(line, &progress, &summary)) {
+    attempts_ = 0;
+    ReportProgress(progress, summary);
+  }
+}
+
+void TorControl::Retry() {
+  socket_.reset();
+  pending_.clear();
+  weak_ptr_factory_.InvalidateWeakPtrs();
+  if (attempts_ >= kMaxAttempts) {
+    LOG(ERROR) << "Unable to connect to the tor control port";
+    return;
+  }
+  retry_timer_.Start(FROM_HERE,
+                     base::TimeDelta::FromMilliseconds(kRetryDelayMs),
+                     base::Bind(&TorControl::ReadControlInfo,
+                                base::Unretained(this)));
+}
+
+void TorControl::ReportProgress(int progress, const std::string& summary) {
+  if (progress == progress_ && progress != 0)
+    return;
+  progress_ = progress;
+  BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
+                          base::Bind(callback_, progress, summary));
+}
+
+}  // namespace brave
@@ -0,0 +1,87 @@
+// Copyright (c) 2018 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_BROWSER_TOR_TOR_CONTROL_H_
+#define BRAVE_BROWSER_TOR_TOR_CONTROL_H_
+
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "net/base/ip_endpoint.h"
+
+namespace net {
+class DrainableIOBuffer;
+class IOBufferWithSize;
+class TCPClientSocket;
+}
+
+namespace brave {
+
+// Follows the bootstrap of a tor process through its control port.
+//
+// Tor writes the address of its control port and its authentication cookie to
+// the watch directory once it is up. Both are picked up from there, and after
+// authenticating the connection subscribes to the client status events that
+// report the bootstrap progress. Lives on the IO thread.
+class TorControl {
+ public:
+  // Called on the UI thread with the bootstrap progress, from 0 to 100, and
+  // tor's summary of the current phase.
+  typedef base::Callback<void(int, const std::string&)> ProgressCallback;
+
+  explicit TorControl(const ProgressCallback& callback);
+  ~TorControl();
+
+  // Connects to the tor process whose files are in |watch_dir|, dropping any
+  // previous connection.
+  void Start(const base::FilePath& watch_dir);
+  void Stop();
+
+ private:
+  struct ControlInfo;
+
+  // Runs on a worker, returns null until tor has written both files.
+  static std::unique_ptr<ControlInfo> ReadControlInfoFiles(
+      const base::FilePath& watch_dir);
+
+  void ReadControlInfo();
+  void OnControlInfoRead(std::unique_ptr<ControlInfo> info);
+  void OnConnected(int result);
+  void DoWrite();
+  void OnWritten(int result);
+  void DoRead();
+  void OnRead(int result);
+  // Returns false once the connection is dropped.
+  bool HandleReadResult(int result);
+  void HandleLine(const std::string& line);
+  // Drops the connection and tries again a little later.
+  void Retry();
+  void ReportProgress(int progress, const std::string& summary);
+
+  ProgressCallback callback_;
+  base::FilePath watch_dir_;
+  int attempts_;
+  base::OneShotTimer retry_timer_;
+
+  std::unique_ptr<net::TCPClientSocket> socket_;
+  scoped_refptr<net::DrainableIOBuffer> write_buffer_;
+  scoped_refptr<net::IOBufferWithSize> read_buffer_;
+  // Received data that doesn't form a complete line yet.
+  std::string pending_;
+  int progress_;
+
+  base::WeakPtrFactory<TorControl> weak_ptr_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(TorControl);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_TOR_TOR_CONTROL_H_
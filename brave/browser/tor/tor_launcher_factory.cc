@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <limits>
 
+#include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/path_service.h"
+#include "brave/browser/tor/tor_control.h"
 #include "chrome/common/chrome_paths.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/child_process_launcher_utils.h"
@@ -22,7 +24,13 @@ using content::BrowserThread;
 
 TorLauncherFactory::TorLauncherFactory(
   const base::FilePath::StringType& path, const std::string& proxy)
-  : path_(path) {
+  : bootstrap_progress_(0),
+    path_(path),
+    weak_ptr_factory_(this) {
+  tor_control_.reset(new TorControl(
+      base::Bind(&TorLauncherFactory::OnBootstrapProgress,
+                 weak_ptr_factory_.GetWeakPtr())));
+
   if (proxy.length()) {
     url::Parsed url;
     url::ParseStandardURL(
@@ -51,7 +59,10 @@ TorLauncherFactory::TorLauncherFactory(
                    base::Unretained(this)));
 }
 
-TorLauncherFactory::~TorLauncherFactory() {}
+TorLauncherFactory::~TorLauncherFactory() {
+  BrowserThread::DeleteSoon(BrowserThread::IO, FROM_HERE,
+                            tor_control_.release());
+}
 
 void TorLauncherFactory::LaunchTorProcess() {
   content::GetProcessLauncherTaskRunner()->PostTask(
@@ -60,6 +71,9 @@ void TorLauncherFactory::LaunchTorProcess() {
 }
 
 void TorLauncherFactory::RelaunchTorProcess() {
+  BrowserThread::PostTask(
+    BrowserThread::IO, FROM_HERE,
+    base::Bind(&TorControl::Stop, base::Unretained(tor_control_.get())));
   content::GetProcessLauncherTaskRunner()->PostTask(
     FROM_HERE, base::Bind(&TorLauncherFactory::RelaunchOnLauncherThread,
                           base::Unretained(this)));
@@ -70,6 +84,11 @@ void TorLauncherFactory::SetLauncherCallback(
   callback_ = callback;
 }
 
+void TorLauncherFactory::SetBootstrapCallback(
+    const TorBootstrapCallback& callback) {
+  bootstrap_callback_ = callback;
+}
+
 void TorLauncherFactory::LaunchOnLauncherThread() {
   base::FilePath user_data_dir;
   base::PathService::Get(chrome::DIR_USER_DATA, &user_data_dir);
@@ -103,6 +122,9 @@ void TorLauncherFactory::OnTorLauncherCrashed() {
 
 void TorLauncherFactory::OnTorCrashed(int64_t pid) {
   LOG(ERROR) << "Tor Process(" << pid << ") Crashed";
+  BrowserThread::PostTask(
+    BrowserThread::IO, FROM_HERE,
+    base::Bind(&TorControl::Stop, base::Unretained(tor_control_.get())));
   if (callback_)
     callback_.Run(TorProcessState::CRASHED, pid);
 }
@@ -111,6 +133,13 @@ void TorLauncherFactory::OnTorLaunched(bool result, int64_t pid) {
   tor_pid_ = pid;
   if (!result) {
     LOG(ERROR) << "Tor Launching Failed(" << pid <<")";
+  } else {
+    // The control port comes up shortly after the process, TorControl waits
+    // for tor to write its files.
+    BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&TorControl::Start, base::Unretained(tor_control_.get()),
+                 tor_watch_path_));
   }
   if (callback_) {
     if (result)
@@ -120,4 +149,12 @@ void TorLauncherFactory::OnTorLaunched(bool result, int64_t pid) {
   }
 }
 
+void TorLauncherFactory::OnBootstrapProgress(int progress,
+                                             const std::string& summary) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  bootstrap_progress_ = progress;
+  if (bootstrap_callback_)
+    bootstrap_callback_.Run(progress, summary);
+}
+
 }  // namespace brave
@@ -5,13 +5,17 @@
 #ifndef BRAVE_BROWSER_TOR_TOR_LAUNCHER_FACTORY_H_
 #define BRAVE_BROWSER_TOR_TOR_LAUNCHER_FACTORY_H_
 
+#include <memory>
 #include <string>
 
 #include "base/callback.h"
+#include "base/memory/weak_ptr.h"
 #include "brave/common/tor/tor.mojom.h"
 
 namespace brave {
 
+class TorControl;
+
 class TorLauncherFactory {
  public:
   TorLauncherFactory(const base::FilePath::StringType& path,
@@ -25,12 +29,21 @@ class TorLauncherFactory {
   };
 
   using TorLauncherCallback = base::Callback<void(TorProcessState, int64_t)>;
+  // Receives the bootstrap progress, from 0 to 100, and tor's summary of the
+  // current phase.
+  using TorBootstrapCallback =
+      base::Callback<void(int, const std::string&)>;
 
   void LaunchTorProcess();
   void RelaunchTorProcess();
   void SetLauncherCallback(const TorLauncherCallback& callback);
   int64_t GetTorPid() const { return tor_pid_; }
 
+  void SetBootstrapCallback(const TorBootstrapCallback& callback);
+  int GetBootstrapProgress() const { return bootstrap_progress_; }
+  // Whether tor has circuits to carry requests.
+  bool IsReady() const { return bootstrap_progress_ >= 100; }
+
  private:
   void LaunchOnLauncherThread();
   void RelaunchOnLauncherThread();
@@ -38,19 +51,25 @@ class TorLauncherFactory {
   void OnTorLauncherCrashed();
   void OnTorCrashed(int64_t pid);
   void OnTorLaunched(bool result, int64_t pid);
-
-
+  void OnBootstrapProgress(int progress, const std::string& summary);
 
   tor::mojom::TorLauncherPtr tor_launcher_;
 
   TorLauncherCallback callback_;
   int64_t tor_pid_;
 
+  // Lives on the IO thread.
+  std::unique_ptr<TorControl> tor_control_;
+  TorBootstrapCallback bootstrap_callback_;
+  int bootstrap_progress_;
+
   base::FilePath::StringType path_;
   std::string host_;
   std::string port_;
   base::FilePath tor_data_path_;
   base::FilePath tor_watch_path_;
+
+  base::WeakPtrFactory<TorLauncherFactory> weak_ptr_factory_;
 };
 
 }  // namespace brave
@@ -31,19 +31,28 @@ v8::Local<v8::Value> Converter<base::SharedMemory*>::ToV8(
     return v8::Null(isolate);
   }
 
-  if (!val->Map(sizeof(base::Pickle::Header)))
+  // Map the whole block at once when the handle knows its size, which it
+  // does for every handle sent over IPC.
+  if (!val->memory()) {
+    size_t size = val->handle().GetSize();
+    if (!val->Map(size ? size : sizeof(base::Pickle::Header)))
+      return v8::Null(isolate);
+  }
+  if (val->mapped_size() < sizeof(base::Pickle::Header))
     return v8::Null(isolate);
 
   // Get the payload size
   base::Pickle::Header* pickle_header =
       reinterpret_cast<base::Pickle::Header*>(val->memory());
-
-  // Now map in the rest of the block.
-  int pickle_size =
+  size_t pickle_size =
       sizeof(base::Pickle::Header) + pickle_header->payload_size;
-  val->Unmap();
-  if (!val->Map(pickle_size))
-    return v8::Null(isolate);
+
+  // Otherwise map in the rest of the block now.
+  if (val->mapped_size() < pickle_size) {
+    val->Unmap();
+    if (!val->Map(pickle_size))
+      return v8::Null(isolate);
+  }
 
   base::Pickle pickle(reinterpret_cast<char*>(val->memory()),
                       pickle_size);
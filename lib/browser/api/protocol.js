@@ -3,6 +3,107 @@ const {app, session} = require('electron')
 // Global protocol APIs.
 module.exports = process.atomBinding('protocol')
 
+const isStream = (value) => {
+  return value !== null && typeof value === 'object' &&
+    typeof value.read === 'function' && typeof value.on === 'function'
+}
+
+// Reads a Node stream through the pull interface of registerStreamProtocol.
+// Paused streams stop reading from their source once their buffer is full, so
+// a slow consumer holds back the producer.
+const readStream = (stream) => {
+  let pending = null
+  let position = 0
+  let ended = false
+  let failure = null
+
+  const flush = () => {
+    if (!pending) return
+    const {offset, size, callback} = pending
+    if (failure) {
+      pending = null
+      callback(failure)
+      return
+    }
+
+    // Data before |offset| belongs to a range that wasn't asked for.
+    let chunk
+    while ((chunk = stream.read()) !== null) {
+      if (!Buffer.isBuffer(chunk)) chunk = Buffer.from(chunk)
+      const skip = Math.min(Math.max(offset - position, 0), chunk.length)
+      position += skip
+      chunk = chunk.slice(skip)
+      if (chunk.length) break
+    }
+    if (chunk === null) {
+      if (ended) {
+        pending = null
+        callback(null)
+      }
+      return
+    }
+
+    // Clear the read first, unshift may emit 'readable' synchronously.
+    pending = null
+    if (chunk.length > size) {
+      stream.unshift(chunk.slice(size))
+      chunk = chunk.slice(0, size)
+    }
+    position += chunk.length
+    callback(chunk)
+  }
+
+  stream.on('readable', flush)
+  stream.once('end', () => {
+    ended = true
+    flush()
+  })
+  stream.once('error', (error) => {
+    failure = error
+    flush()
+  })
+
+  return (offset, size, callback) => {
+    pending = {offset, size, callback}
+    flush()
+  }
+}
+
+// Streams are destroyed once the request is complete or aborted, so their
+// underlying resources are released even when they aren't read to the end.
+const closeStream = (stream, close) => () => {
+  if (typeof stream.destroy === 'function') stream.destroy()
+  if (typeof close === 'function') close()
+}
+
+const toStreamResponse = (response) => {
+  if (isStream(response) || typeof response === 'function') {
+    response = {data: response}
+  }
+  if (response && isStream(response.data)) {
+    const {data, close} = response
+    response = Object.assign({}, response, {
+      data: readStream(data),
+      close: closeStream(data, close)
+    })
+  }
+  return response
+}
+
+// The native stream job only pulls from functions, Node streams are adapted
+// here. All Protocol objects share the prototype, so patching it once is
+// enough.
+app.once('session-created', (session) => {
+  const prototype = Object.getPrototypeOf(session.protocol)
+  const {registerStreamProtocol} = prototype
+  prototype.registerStreamProtocol = function (scheme, handler, ...args) {
+    const streamHandler = (request, callback) => {
+      handler(request, (response) => callback(toStreamResponse(response)))
+    }
+    return registerStreamProtocol.call(this, scheme, streamHandler, ...args)
+  }
+})
+
 // Fallback protocol APIs of default session.
 Object.setPrototypeOf(module.exports, new Proxy({}, {
   get (target, property) {
@@ -101,6 +101,10 @@ WebContents.prototype.send = function (channel, ...args) {
   if (channel == null) throw new Error('Missing required `channel` argument')
   return this._send(channel, args)
 }
+WebContents.prototype.sendCloned = function (channel, ...args) {
+  if (channel == null) throw new Error('Missing required `channel` argument')
+  return this._sendCloned(channel, args)
+}
 
 WebContents.prototype.clone = function(...args) {
   if (args.length === 0) {
@@ -182,7 +186,7 @@ WebContents.prototype._init = function () {
   this.on('ipc-message-sync', function (event, [channel, ...args]) {
     Object.defineProperty(event, 'returnValue', {
       set: function (value) {
-        return event.sendReply(JSON.stringify(value))
+        return event.sendReply(value)
       },
       get: function () {}
     })
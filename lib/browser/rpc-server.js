@@ -18,8 +18,15 @@ const FUNCTION_PROPERTIES = [
 // id => Function
 let rendererFunctions = v8Util.createDoubleIDWeakMap()
 
-// Return the description of object's members:
-let getObjectMembers = function (object) {
+// Whether a data member can be sent along with its description.
+const isPlainValue = function (value) {
+  return value === null ||
+      ['boolean', 'number', 'string'].includes(typeof value)
+}
+
+// Return the description of object's members, with the current value of
+// plain data members when |prefetch| is set:
+let getObjectMembers = function (object, prefetch = false) {
   let names = Object.getOwnPropertyNames(object)
   // For Function, we should not override following properties even though they
   // are "own" properties.
@@ -37,6 +44,9 @@ let getObjectMembers = function (object) {
     } else {
       if (descriptor.set || descriptor.writable) member.writable = true
       member.type = 'get'
+      if (prefetch && isPlainValue(descriptor.value)) {
+        member.value = descriptor.value
+      }
     }
     return member
   })
@@ -53,7 +63,8 @@ let getObjectPrototype = function (object) {
 }
 
 // Convert a real value into meta data.
-let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
+let valueToMeta = function (sender, value, optimizeSimpleObject = false,
+                            prefetch = false) {
   // Determine the type of value.
   const meta = { type: typeof value }
   if (meta.type === 'object') {
@@ -81,7 +92,7 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
 
   // Fill the meta object according to value's type.
   if (meta.type === 'array') {
-    meta.members = value.map((el) => valueToMeta(sender, el))
+    meta.members = value.map((el) => valueToMeta(sender, el, false, prefetch))
   } else if (meta.type === 'object' || meta.type === 'function') {
     meta.name = value.constructor ? value.constructor.name : ''
 
@@ -89,7 +100,7 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
     // passed to renderer we would assume the renderer keeps a reference of
     // it.
     meta.id = objectsRegistry.add(sender, value)
-    meta.members = getObjectMembers(value)
+    meta.members = getObjectMembers(value, prefetch)
     meta.proto = getObjectPrototype(value)
   } else if (meta.type === 'buffer') {
     meta.value = Buffer.from(value)
@@ -203,20 +214,27 @@ const unwrapArgs = function (sender, args) {
 }
 
 // Call a function and send reply asynchronously if it's a an asynchronous
-// style function and the caller didn't pass a callback.
-const callFunction = function (event, func, caller, args) {
+// style function and the caller didn't pass a callback. The reply goes to
+// event.returnValue unless a |reply| function is passed.
+const callFunction = function (event, func, caller, args, reply,
+                               prefetch = false) {
   let funcMarkedAsync, funcName, funcPassedCallback, ref, ret
+  if (reply == null) {
+    reply = function (meta) {
+      event.returnValue = meta
+    }
+  }
   funcMarkedAsync = v8Util.getHiddenValue(func, 'asynchronous')
   funcPassedCallback = typeof args[args.length - 1] === 'function'
   try {
     if (funcMarkedAsync && !funcPassedCallback) {
       args.push(function (ret) {
-        event.returnValue = valueToMeta(event.sender, ret, true)
+        reply(valueToMeta(event.sender, ret, true, prefetch))
       })
       func.apply(caller, args)
     } else {
       ret = func.apply(caller, args)
-      event.returnValue = valueToMeta(event.sender, ret, true)
+      reply(valueToMeta(event.sender, ret, true, prefetch))
     }
   } catch (error) {
     // Catch functions thrown further down in function invocation and wrap
@@ -339,6 +357,74 @@ ipcMain.on('ELECTRON_BROWSER_MEMBER_GET', function (event, id, name) {
   }
 })
 
+// Handlers for the requests of an ELECTRON_BROWSER_BATCH message, each one
+// calls |reply| with the meta of its result.
+const batchHandlers = {
+  'builtin': function (event, request, reply) {
+    reply(valueToMeta(event.sender, electron[request.name], false, true))
+  },
+  'current-window': function (event, request, reply) {
+    const window = event.sender.getOwnerBrowserWindow()
+    reply(valueToMeta(event.sender, window, false, true))
+  },
+  'current-web-contents': function (event, request, reply) {
+    reply(valueToMeta(event.sender, event.sender, false, true))
+  },
+  'get': function (event, request, reply) {
+    const obj = objectsRegistry.get(request.id)
+    reply(valueToMeta(event.sender, obj[request.name], false, true))
+  },
+  'set': function (event, request, reply) {
+    const obj = objectsRegistry.get(request.id)
+    obj[request.name] = request.value
+    reply(valueToMeta(event.sender, null))
+  },
+  'call': function (event, request, reply) {
+    const args = unwrapArgs(event.sender, request.args)
+    const obj = objectsRegistry.get(request.id)
+    callFunction(event, obj[request.name], obj, args, reply, true)
+  },
+  'function-call': function (event, request, reply) {
+    const args = unwrapArgs(event.sender, request.args)
+    const func = objectsRegistry.get(request.id)
+    callFunction(event, func, global, args, reply, true)
+  },
+  'constructor': function (event, request, reply) {
+    const args = unwrapArgs(event.sender, request.args)
+    const constructor = objectsRegistry.get(request.id)
+    const obj = new (Function.prototype.bind.apply(constructor, [null].concat(args)))
+    reply(valueToMeta(event.sender, obj, false, true))
+  }
+}
+
+// The requests made by remote.async in one renderer task. They are run in
+// order and answered together once every result, including the ones of
+// asynchronous functions, is known.
+ipcMain.on('ELECTRON_BROWSER_BATCH', function (event, batchId, requests) {
+  const results = new Array(requests.length)
+  let remaining = requests.length
+
+  requests.forEach(function (request, i) {
+    let replied = false
+    const reply = function (meta) {
+      if (replied) return
+      replied = true
+      results[i] = meta
+      if (--remaining === 0 && !event.sender.isDestroyed()) {
+        event.sender.send('ELECTRON_RENDERER_BATCH_REPLY', batchId, results)
+      }
+    }
+
+    try {
+      const handler = batchHandlers[request.type]
+      if (!handler) throw new TypeError(`Unknown request: ${request.type}`)
+      handler(event, request, reply)
+    } catch (error) {
+      reply(exceptionToMeta(error))
+    }
+  })
+})
+
 ipcMain.on('ELECTRON_BROWSER_DEREFERENCE', function (event, id) {
   objectsRegistry.remove(event.sender.id, id)
 })
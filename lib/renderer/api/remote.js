@@ -280,6 +280,144 @@ const metaToPlainObject = function (meta) {
   return obj
 }
 
+// Asynchronous remote objects mirror the synchronous ones, but every member
+// access returns a promise. The requests made in one task are sent to the
+// browser in a single ELECTRON_BROWSER_BATCH message and several batches can
+// be in flight at once, so nothing blocks on the browser.
+let nextBatchId = 0
+let queuedRequests = []
+const pendingBatches = new Map()
+
+// Async wrappers keep their synchronous counterpart alive, which owns the
+// reference to the browser object.
+const asyncObjectCache = new WeakMap()
+
+const queueRequest = function (request) {
+  return new Promise(function (resolve, reject) {
+    if (queuedRequests.length === 0) Promise.resolve().then(flushRequests)
+    queuedRequests.push({request, resolve, reject})
+  })
+}
+
+const flushRequests = function () {
+  const batch = queuedRequests
+  const batchId = ++nextBatchId
+  queuedRequests = []
+  pendingBatches.set(batchId, batch)
+  ipcRenderer.send('ELECTRON_BROWSER_BATCH', batchId,
+                   batch.map((entry) => entry.request))
+}
+
+// Populate the members of an async wrapper. Plain data members sent along
+// with the description resolve from |values| without asking the browser.
+// This matches |getObjectMembers| in rpc-server.
+const setAsyncMembers = function (object, metaId, members, values) {
+  for (let member of members) {
+    if (object.hasOwnProperty(member.name)) continue
+
+    let descriptor = { enumerable: member.enumerable, configurable: true }
+    if (member.type === 'method') {
+      descriptor.writable = true
+      descriptor.value = function (...args) {
+        return queueRequest({
+          type: 'call', id: metaId, name: member.name, args: wrapArgs(args)
+        })
+      }
+    } else if (member.type === 'get') {
+      descriptor.get = function () {
+        if (values && values.has(member.name)) {
+          return Promise.resolve(values.get(member.name))
+        }
+        return queueRequest({type: 'get', id: metaId, name: member.name})
+      }
+
+      if (member.writable) {
+        descriptor.set = function (value) {
+          if (values) values.delete(member.name)
+          queueRequest({type: 'set', id: metaId, name: member.name, value})
+          return value
+        }
+      }
+    }
+
+    Object.defineProperty(object, member.name, descriptor)
+  }
+}
+
+const setAsyncPrototype = function (object, metaId, descriptor) {
+  if (descriptor === null) return
+  let proto = {}
+  setAsyncMembers(proto, metaId, descriptor.members, null)
+  setAsyncPrototype(proto, metaId, descriptor.proto)
+  Object.setPrototypeOf(object, proto)
+}
+
+// Remember the plain data members sent with |meta|.
+const updateAsyncValues = function (values, meta) {
+  for (let member of meta.members) {
+    if (member.hasOwnProperty('value')) {
+      values.set(member.name, member.value)
+    } else {
+      values.delete(member.name)
+    }
+  }
+}
+
+// Convert meta data from browser into an async wrapper or a real value.
+const metaToAsyncValue = function (meta) {
+  switch (meta.type) {
+    case 'array':
+      return meta.members.map(metaToAsyncValue)
+    case 'object':
+    case 'function':
+      break
+    default:
+      return metaToValue(meta)
+  }
+
+  const target = metaToValue(meta)
+  let ret = asyncObjectCache.get(target)
+  if (ret) {
+    updateAsyncValues(privates(ret).values, meta)
+    return ret
+  }
+
+  if (meta.type === 'function') {
+    ret = function (...args) {
+      const type = this && this.constructor === ret
+          ? 'constructor' : 'function-call'
+      return queueRequest({type, id: meta.id, args: wrapArgs(args)})
+    }
+  } else {
+    ret = {}
+  }
+
+  const values = new Map()
+  updateAsyncValues(values, meta)
+  setAsyncMembers(ret, meta.id, meta.members, values)
+  setAsyncPrototype(ret, meta.id, meta.proto)
+
+  privates(ret).atomId = meta.id
+  privates(ret).target = target
+  privates(ret).values = values
+  asyncObjectCache.set(target, ret)
+  return ret
+}
+
+ipcRenderer.on('ELECTRON_RENDERER_BATCH_REPLY', function (event, batchId, results) {
+  const batch = pendingBatches.get(batchId)
+  if (!batch) return
+  pendingBatches.delete(batchId)
+
+  batch.forEach(function (entry, i) {
+    try {
+      entry.resolve(metaToAsyncValue(results[i]))
+    } catch (error) {
+      entry.reject(error)
+    }
+  })
+})
+
 // Browser calls a callback in renderer.
 ipcRenderer.on('ELECTRON_RENDERER_CALLBACK', function (event, id, args) {
   callbacksRegistry.apply(id, metaToValue(args))
@@ -307,6 +445,19 @@ binding.getCurrentWebContents = function () {
   return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS'))
 }
 
+// Promise based versions of the getters above, resolving to async wrappers.
+binding.async = {
+  getBuiltin: function (module) {
+    return queueRequest({type: 'builtin', name: module})
+  },
+  getCurrentWindow: function () {
+    return queueRequest({type: 'current-window'})
+  },
+  getCurrentWebContents: function () {
+    return queueRequest({type: 'current-web-contents'})
+  }
+}
+
 binding.getWebContents = function (tabId, cb) {
   const responseId = ipcRenderer.guid()
   ipcRenderer.on('ELECTRON_BROWSER_GET_WEB_CONTENTS_RESPONSE_' + responseId, (evt, res) => {
@@ -0,0 +1,176 @@
+#!/usr/bin/env python
+
+# Embeds a precompiled header index into an asar archive.
+#
+# The index is appended to the header pickle after the JSON string, so older
+# readers that only read the JSON keep working, while Archive::Init maps it in
+# place instead of parsing the JSON. The layout must match
+# atom/common/asar/archive_index.h.
+
+import argparse
+import json
+import os
+import shutil
+import struct
+import sys
+import tempfile
+
+INDEX_MAGIC = 0x58495341  # "ASIX"
+INDEX_VERSION = 1
+
+FLAG_DIRECTORY = 1 << 0
+FLAG_LINK = 1 << 1
+FLAG_UNPACKED = 1 << 2
+FLAG_EXECUTABLE = 1 << 3
+FLAG_INVALID = 1 << 4
+
+INT32_MAX = 2 ** 31 - 1
+UINT64_MAX = 2 ** 64 - 1
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('archive', help='Path to the .asar archive to update')
+  parser.add_argument('-o', '--output',
+                      help='Write the result here instead of in place')
+  args = parser.parse_args()
+
+  with open(args.archive, 'rb') as f:
+    header_json, data_offset = read_header(f)
+    header = json.loads(header_json.decode('utf-8'))
+    index = compile_index(header)
+
+    output = args.output or args.archive
+    fd, temp_path = tempfile.mkstemp(dir=os.path.dirname(
+        os.path.abspath(output)))
+    try:
+      with os.fdopen(fd, 'wb') as out:
+        write_header(out, header_json, index)
+        f.seek(data_offset)
+        shutil.copyfileobj(f, out)
+      shutil.copymode(args.archive, temp_path)
+      os.rename(temp_path, output)
+    except Exception:
+      os.remove(temp_path)
+      raise
+
+  return 0
+
+
+def read_header(f):
+  size_pickle = f.read(8)
+  if len(size_pickle) != 8:
+    raise ValueError('Failed to read header size')
+  header_size = struct.unpack('<II', size_pickle)[1]
+
+  header_pickle = f.read(header_size)
+  if len(header_pickle) != header_size:
+    raise ValueError('Failed to read header')
+  json_size = struct.unpack_from('<i', header_pickle, 4)[0]
+  header_json = header_pickle[8:8 + json_size]
+  return header_json, 8 + header_size
+
+
+def write_header(out, header_json, index):
+  payload = pickle_bytes(header_json) + pickle_bytes(index)
+  header_pickle = struct.pack('<I', len(payload)) + payload
+  out.write(struct.pack('<II', 4, len(header_pickle)))
+  out.write(header_pickle)
+
+
+def pickle_bytes(data):
+  padding = (4 - len(data) % 4) % 4
+  return struct.pack('<i', len(data)) + data + b'\0' * padding
+
+
+class StringTable(object):
+  def __init__(self):
+    self.data = bytearray()
+    self.offsets = {}
+
+  def intern(self, value):
+    value = value.encode('utf-8')
+    if value not in self.offsets:
+      self.offsets[value] = len(self.data)
+      self.data.extend(value)
+    return self.offsets[value], len(value)
+
+
+def is_int(value):
+  return (isinstance(value, int) or type(value).__name__ == 'long') and \
+      not isinstance(value, bool)
+
+
+def compile_node(strings, name, entry):
+  # Returns ([name_offset, name_size, flags, size, offset_low, offset_high],
+  #          files) where files is set for directories.
+  node = list(strings.intern(name)) + [0, 0, 0, 0]
+
+  if isinstance(entry.get('link'), type(u'')):
+    node[2] = FLAG_LINK
+    node[4], node[3] = strings.intern(entry['link'])
+    return node, None
+
+  if isinstance(entry.get('files'), dict):
+    node[2] = FLAG_DIRECTORY
+    return node, entry['files']
+
+  size = entry.get('size')
+  if not is_int(size) or not -INT32_MAX - 1 <= size <= INT32_MAX:
+    node[2] = FLAG_INVALID
+    return node, None
+  node[3] = size & 0xffffffff
+
+  if entry.get('unpacked') is True:
+    node[2] = FLAG_UNPACKED
+    return node, None
+
+  offset = entry.get('offset')
+  if not isinstance(offset, type(u'')) or not offset.isdigit() or \
+      int(offset) > UINT64_MAX:
+    node[2] = FLAG_INVALID
+    return node, None
+  offset = int(offset)
+  node[4] = offset & 0xffffffff
+  node[5] = offset >> 32
+
+  if entry.get('executable') is True:
+    node[2] |= FLAG_EXECUTABLE
+  return node, None
+
+
+def compile_index(header):
+  strings = StringTable()
+  root = list(strings.intern(u'')) + [FLAG_DIRECTORY, 0, 0, 0]
+  nodes = [root]
+
+  # Breadth first, so that the children of each directory are adjacent.
+  pending = [(header['files'], 0)]
+  while pending:
+    files, dir_index = pending.pop(0)
+    entries = sorted(
+        ((name.encode('utf-8'), name, entry)
+         for name, entry in files.items() if isinstance(entry, dict)),
+        key=lambda item: item[0])
+
+    nodes[dir_index][4] = len(nodes)
+    nodes[dir_index][3] = len(entries)
+    for _, name, entry in entries:
+      node, child_files = compile_node(strings, name, entry)
+      if child_files is not None:
+        pending.append((child_files, len(nodes)))
+      nodes.append(node)
+
+  while len(strings.data) % 4:
+    strings.data.append(0)
+
+  index = bytearray(struct.pack('<IIII', INDEX_MAGIC, INDEX_VERSION,
+                                len(nodes), len(strings.data)))
+  for node in nodes:
+    index.extend(struct.pack('<IIIIII', *node))
+  index.extend(strings.data)
+  return bytes(index)
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -269,6 +269,24 @@ describe('browser-window module', function () {
     })
   })
 
+  describe('webContents.captureThumbnail(options, callback)', function () {
+    it('throws without an output size', function () {
+      assert.throws(function () {
+        w.webContents.captureThumbnail({format: 'jpeg'}, function () {})
+      }, /width and height/)
+    })
+
+    it('throws for unsupported formats', function () {
+      assert.throws(function () {
+        w.webContents.captureThumbnail({
+          width: 100,
+          height: 100,
+          format: 'gif'
+        }, function () {})
+      }, /format/)
+    })
+  })
+
   describe('BrowserWindow.setSize(width, height)', function () {
     it('sets the window size', function (done) {
       var size = [300, 400]
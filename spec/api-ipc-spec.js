@@ -282,6 +282,37 @@ describe('ipc module', function () {
     })
   })
 
+  describe('remote.async', function () {
+    it('resolves members of remote objects', function () {
+      return remote.async.getCurrentWebContents().then(function (contents) {
+        return Promise.all([contents.id, contents.getURL()])
+      }).then(function ([id, url]) {
+        const contents = remote.getCurrentWebContents()
+        assert.equal(id, contents.id)
+        assert.equal(url, contents.getURL())
+      })
+    })
+
+    it('returns the same wrapper for the same object', function () {
+      return Promise.all([
+        remote.async.getCurrentWebContents(),
+        remote.async.getCurrentWindow().then((w) => w.webContents)
+      ]).then(function ([contents1, contents2]) {
+        assert(contents1 === contents2)
+      })
+    })
+
+    it('rejects when the remote call throws', function () {
+      return remote.async.getCurrentWindow().then(function (w) {
+        return w.setSize('not a number')
+      }).then(function () {
+        throw new Error('Promise was not rejected')
+      }, function (error) {
+        assert.ok(/Could not call remote function/.test(error.message))
+      })
+    })
+  })
+
   describe('remote class', function () {
     let cl = remote.require(path.join(fixtures, 'module', 'class.js'))
     let base = cl.base
@@ -355,6 +386,17 @@ describe('ipc module', function () {
       ipcRenderer.send('message', buffer)
     })
 
+    it('can send typed arrays and ArrayBuffers', function (done) {
+      const floats = new Float64Array([1, 2.5, -3])
+      const bytes = new Uint8Array([1, 2, 3]).buffer
+      ipcRenderer.once('message', function (event, floatsValue, bytesValue) {
+        assert.deepEqual(floatsValue, [1, 2.5, -3])
+        assert.ok(Buffer.from([1, 2, 3]).equals(bytesValue))
+        done()
+      })
+      ipcRenderer.send('message', floats, bytes)
+    })
+
     it('can send objects with DOM class prototypes', function (done) {
       ipcRenderer.once('message', function (event, value) {
         assert.equal(value.protocol, 'file:')
@@ -423,6 +465,35 @@ describe('ipc module', function () {
     })
   })
 
+  describe('ipcRenderer.sendCloned', function () {
+    it('keeps values that JSON can not represent', function (done) {
+      const date = new Date()
+      const map = new Map([['a', 1], ['b', new Set([2])]])
+      const floats = new Float64Array([1, 2.5, -3])
+      const cyclic = {hello: 'world'}
+      cyclic.self = cyclic
+
+      ipcRenderer.once('cloned-message', function (event, dateValue, mapValue, floatsValue, cyclicValue) {
+        assert.ok(dateValue instanceof Date)
+        assert.equal(dateValue.getTime(), date.getTime())
+        assert.ok(mapValue instanceof Map)
+        assert.equal(mapValue.get('a'), 1)
+        assert.ok(mapValue.get('b').has(2))
+        assert.ok(floatsValue instanceof Float64Array)
+        assert.deepEqual(Array.from(floatsValue), [1, 2.5, -3])
+        assert.equal(cyclicValue.self, cyclicValue)
+        done()
+      })
+      ipcRenderer.sendCloned('cloned-message', date, map, floats, cyclic)
+    })
+
+    it('throws for values that can not be cloned', function () {
+      assert.throws(function () {
+        ipcRenderer.sendCloned('cloned-message', function () {})
+      }, /could not be cloned/)
+    })
+  })
+
   describe('ipc.sendSync', function () {
     afterEach(function () {
       ipcMain.removeAllListeners('send-sync-message')
@@ -433,6 +504,32 @@ describe('ipc module', function () {
       assert.equal(msg, 'test')
     })
 
+    it('replies with the JSON description of event.returnValue', function () {
+      const reply = ipcRenderer.sendSync('eval', '({toJSON: () => "json"})')
+      assert.equal(reply, 'json')
+      const date = ipcRenderer.sendSync('eval', 'new Date(0)')
+      assert.equal(date, new Date(0).toJSON())
+    })
+
+    it('replies with binary data as a Uint8Array when cloned', function () {
+      const buffer = Buffer.from('hello')
+      const reply = ipcRenderer.sendSync('echo-cloned', buffer)
+      assert.ok(reply instanceof Uint8Array)
+      assert.ok(buffer.equals(Buffer.from(reply)))
+    })
+
+    it('replies with only the bytes of a pooled Buffer', function () {
+      const reply = ipcRenderer.sendSync('eval-cloned', "Buffer.from('pooled')")
+      assert.equal(reply.byteLength, 6)
+      assert.equal(reply.buffer.byteLength, 6)
+    })
+
+    it('replies to values that can not be cloned', function () {
+      const reply = ipcRenderer.sendSync('eval-cloned', '({a: 1, f: function () {}})')
+      assert.deepEqual(reply, {a: 1})
+      assert.equal(ipcRenderer.sendSync('eval', "Symbol('s')"), null)
+    })
+
     it('does not crash when reply is not sent and browser is destroyed', function (done) {
       this.timeout(10000)
 
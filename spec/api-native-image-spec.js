@@ -59,4 +59,51 @@ describe('nativeImage module', () => {
       assert.equal(image.getSize().width, 256)
     })
   })
+
+  describe('image.toPNG()', () => {
+    it('returns a copy that can be modified', () => {
+      const imagePath = path.join(__dirname, 'fixtures', 'assets', 'logo.png')
+      const image = nativeImage.createFromPath(imagePath)
+      const dataURL = image.toDataURL()
+      image.toPNG().fill(0)
+      assert.equal(image.toDataURL(), dataURL)
+      assert(!nativeImage.createFromBuffer(image.toPNG()).isEmpty())
+    })
+  })
+
+  describe('image.encode(options, callback)', () => {
+    const imagePath = path.join(__dirname, 'fixtures', 'assets', 'logo.png')
+
+    it('scales the image down to fit the given size', (done) => {
+      const image = nativeImage.createFromPath(imagePath)
+      image.encode({width: 269}, (error, buffer, length) => {
+        assert.equal(error, null)
+        assert.equal(buffer.length, length)
+        const scaled = nativeImage.createFromBuffer(buffer)
+        assert.equal(scaled.getSize().width, 269)
+        assert.equal(scaled.getSize().height, 95)
+        done()
+      })
+    })
+
+    it('writes into the given buffer when it is large enough', (done) => {
+      const image = nativeImage.createFromPath(imagePath)
+      const output = Buffer.alloc(1024 * 1024)
+      image.encode({format: 'jpeg', buffer: output}, (error, buffer, length) => {
+        assert.equal(error, null)
+        assert.strictEqual(buffer, output)
+        assert(length > 0 && length < output.length)
+        done()
+      })
+    })
+
+    it('returns a data URL', (done) => {
+      const image = nativeImage.createFromPath(imagePath)
+      image.encode({dataURL: true}, (error, dataURL) => {
+        assert.equal(error, null)
+        assert.equal(dataURL, image.toDataURL())
+        done()
+      })
+    })
+  })
 })
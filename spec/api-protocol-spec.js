@@ -569,6 +569,268 @@ describe('protocol module', function () {
     })
   })
 
+  describe('protocol.registerStreamProtocol', function () {
+    var buffer = new Buffer(text)
+    var read = function (offset, size, callback) {
+      callback(offset < buffer.length ? buffer.slice(offset, offset + size) : null)
+    }
+
+    it('sends a read function as response', function (done) {
+      var handler = function (request, callback) {
+        callback({data: read, mimeType: 'text/plain'})
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data) {
+            assert.equal(data, text)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('sends a stream as response', function (done) {
+      var handler = function (request, callback) {
+        var stream = new (remote.require('stream').PassThrough)()
+        stream.end(text)
+        callback(stream)
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          success: function (data) {
+            assert.equal(data, text)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('sends a byte range when the length is known', function (done) {
+      var handler = function (request, callback) {
+        callback({data: read, length: buffer.length})
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          headers: {Range: 'bytes=6-9'},
+          success: function (data, status, request) {
+            assert.equal(request.status, 206)
+            assert.equal(data, 'morg')
+            var range = 'bytes 6-9/' + buffer.length
+            assert.equal(request.getResponseHeader('Content-Range'), range)
+            done()
+          },
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('closes the source when the response is complete', function (done) {
+      var handler = function (request, callback) {
+        callback({data: read, length: buffer.length, close: done})
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false,
+          error: function (xhr, errorType, error) {
+            done(error)
+          }
+        })
+      })
+    })
+
+    it('closes the source when the request is aborted', function (done) {
+      var request
+      var pending = function (offset, size, callback) {
+        // Never deliver the chunk, the request is aborted first.
+        setTimeout(function () {
+          request.abort()
+        })
+      }
+      var handler = function (request, callback) {
+        callback({data: pending, close: done})
+      }
+      protocol.registerStreamProtocol(protocolName, handler, function (error) {
+        if (error) {
+          return done(error)
+        }
+        request = $.ajax({
+          url: protocolName + '://fake-host',
+          cache: false
+        })
+      })
+    })
+  })
+
+  describe('protocol.enableResponseCache', function () {
+    var url = protocolName + '://fake-host/cached'
+    var get = function (callback) {
+      $.ajax({
+        url: url,
+        success: function (data) {
+          callback(null, data)
+        },
+        error: function (xhr, errorType, error) {
+          callback(error)
+        }
+      })
+    }
+
+    afterEach(function (done) {
+      protocol.disableResponseCache(protocolName, function () {
+        done()
+      })
+    })
+
+    it('answers repeated requests without calling the handler', function (done) {
+      var calls = 0
+      var handler = function (request, callback) {
+        calls++
+        callback({data: text, cacheControl: 'max-age=60'})
+      }
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) return done(error)
+        protocol.enableResponseCache(protocolName, function (error) {
+          if (error) return done(error)
+          get(function (error, data) {
+            if (error) return done(error)
+            assert.equal(data, text)
+            get(function (error, data) {
+              if (error) return done(error)
+              assert.equal(data, text)
+              assert.equal(calls, 1)
+              done()
+            })
+          })
+        })
+      })
+    })
+
+    it('serves the cached body of buffer responses', function (done) {
+      var calls = 0
+      var handler = function (request, callback) {
+        calls++
+        callback({data: new Buffer(text), mimeType: 'text/plain', cacheControl: 'max-age=60'})
+      }
+      protocol.registerBufferProtocol(protocolName, handler, function (error) {
+        if (error) return done(error)
+        protocol.enableResponseCache(protocolName, function (error) {
+          if (error) return done(error)
+          get(function (error, data) {
+            if (error) return done(error)
+            assert.equal(data, text)
+            get(function (error, data) {
+              if (error) return done(error)
+              assert.equal(data, text)
+              assert.equal(calls, 1)
+              done()
+            })
+          })
+        })
+      })
+    })
+
+    it('calls the handler again after invalidation', function (done) {
+      var calls = 0
+      var handler = function (request, callback) {
+        calls++
+        callback({data: text, cacheControl: 'immutable'})
+      }
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) return done(error)
+        protocol.enableResponseCache(protocolName, function (error) {
+          if (error) return done(error)
+          get(function (error) {
+            if (error) return done(error)
+            protocol.invalidateResponseCache(protocolName, url, function () {
+              get(function (error, data) {
+                if (error) return done(error)
+                assert.equal(data, text)
+                assert.equal(calls, 2)
+                done()
+              })
+            })
+          })
+        })
+      })
+    })
+
+    it('does not store responses that were pending during invalidation', function (done) {
+      var calls = 0
+      var handler = function (request, callback) {
+        calls++
+        if (calls > 1) return callback({data: text, cacheControl: 'immutable'})
+        // Answer the first request only once the cache has been invalidated.
+        protocol.invalidateResponseCache(protocolName, url, function () {
+          callback({data: text, cacheControl: 'immutable'})
+        })
+      }
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) return done(error)
+        protocol.enableResponseCache(protocolName, function (error) {
+          if (error) return done(error)
+          get(function (error) {
+            if (error) return done(error)
+            get(function (error, data) {
+              if (error) return done(error)
+              assert.equal(data, text)
+              assert.equal(calls, 2)
+              done()
+            })
+          })
+        })
+      })
+    })
+
+    it('does not cache responses without cacheControl', function (done) {
+      var calls = 0
+      var handler = function (request, callback) {
+        calls++
+        callback(text)
+      }
+      protocol.registerStringProtocol(protocolName, handler, function (error) {
+        if (error) return done(error)
+        protocol.enableResponseCache(protocolName, function (error) {
+          if (error) return done(error)
+          get(function (error) {
+            if (error) return done(error)
+            get(function (error) {
+              if (error) return done(error)
+              assert.equal(calls, 2)
+              done()
+            })
+          })
+        })
+      })
+    })
+  })
+
   describe('protocol.isProtocolHandled', function () {
     it('returns true for file:', function (done) {
       protocol.isProtocolHandled('file', function (result) {
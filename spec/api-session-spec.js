@@ -1,4 +1,5 @@
 const assert = require('assert')
+const ChildProcess = require('child_process')
 const http = require('http')
 const path = require('path')
 const fs = require('fs')
@@ -203,6 +204,70 @@ describe('session module', function () {
     })
   })
 
+  describe('ses.appState', function () {
+    const appState = session.defaultSession.appState
+
+    afterEach(function () {
+      appState.remove('spec')
+    })
+
+    it('applies key level updates to a section', function (done) {
+      appState.set('spec', {a: 1, b: [2]})
+      appState.setKey('spec', 'c', 'three')
+      appState.removeKey('spec', 'a')
+      appState.get('spec', function (value) {
+        assert.deepEqual(value, {b: [2], c: 'three'})
+        done()
+      })
+    })
+
+    it('passes undefined for removed sections', function (done) {
+      appState.set('spec', true)
+      appState.remove('spec')
+      appState.get('spec', function (value) {
+        assert.equal(value, undefined)
+        done()
+      })
+    })
+
+    it('throws for invalid section names', function () {
+      assert.throws(function () {
+        appState.set('../spec', {})
+      }, /Invalid section name/)
+    })
+
+    it('does not migrate prefs into a state that has data', function (done) {
+      appState.set('spec', true)
+      appState.migrateFromPrefs(function (migrated) {
+        assert.equal(migrated, false)
+        appState.get('spec', function (value) {
+          assert.equal(value, true)
+          done()
+        })
+      })
+    })
+  })
+
+  describe('before the app is ready', function () {
+    it('hands out sessions once their prefs are loaded', function (done) {
+      const appPath = path.join(fixtures, 'api', 'session-ready-app')
+      const appProcess = ChildProcess.spawn(remote.process.execPath, [appPath])
+      let output = ''
+      appProcess.stdout.on('data', function (data) {
+        output += data
+      })
+      appProcess.on('close', function (code) {
+        assert.equal(code, 0)
+        assert.deepEqual(JSON.parse(output), {
+          beforeReady: 'Session can only be received when app is ready',
+          isOffTheRecord: true,
+          appState: true
+        })
+        done()
+      })
+    })
+  })
+
   describe('will-download event', function () {
     var w = null
 
@@ -320,6 +385,45 @@ describe('session module', function () {
       })
     })
 
+    it('reports progress in batches', function (done) {
+      var half = mockPDF.length / 2
+      var slowServer = http.createServer(function (req, res) {
+        res.writeHead(200, {
+          'Content-Length': mockPDF.length,
+          'Content-Type': 'application/pdf',
+          'Content-Disposition': contentDisposition
+        })
+        res.write(mockPDF.slice(0, half))
+        setTimeout(function () {
+          res.end(mockPDF.slice(half))
+          slowServer.close()
+        }, 500)
+      })
+      var ses = w.webContents.session
+      var reports = []
+      var listener = function (event, downloads) {
+        reports.push(downloads)
+      }
+      ses.setDownloadProgressInterval(50)
+      ses.on('download-progress', listener)
+      slowServer.listen(0, '127.0.0.1', function () {
+        var port = slowServer.address().port
+        ipcRenderer.sendSync('set-download-option', false, false)
+        w.loadURL(url + ':' + port)
+        ipcRenderer.once('download-done', function (event, state, url, mimeType, receivedBytes, totalBytes, disposition, filename, savePath) {
+          ses.removeListener('download-progress', listener)
+          ses.setDownloadProgressInterval(0)
+          assertDownload(event, state, url, mimeType, receivedBytes, totalBytes, disposition, filename, port, savePath)
+          assert(reports.length > 0)
+          var progress = reports[reports.length - 1][0]
+          assert.equal(progress.totalBytes, mockPDF.length)
+          assert(progress.receivedBytes > 0)
+          assert(progress.bytesPerSecond >= 0)
+          done()
+        })
+      })
+    })
+
     describe('when a save path is specified and the URL is unavailable', function () {
       it('does not display a save dialog and reports the done state as interrupted', function (done) {
         ipcRenderer.sendSync('set-download-option', false, false)
@@ -85,6 +85,37 @@ describe('webRequest module', function () {
       })
     })
 
+    it('can filter URLs with many patterns', function (done) {
+      var urls = []
+      for (var i = 0; i < 500; i++) {
+        urls.push('*://*.example' + i + '.com/*')
+      }
+      urls.push(defaultURL + 'filter/*')
+      ses.webRequest.onBeforeRequest({urls: urls}, function (details, callback) {
+        callback({
+          cancel: true
+        })
+      })
+      $.ajax({
+        url: defaultURL + 'nofilter/test',
+        success: function (data) {
+          assert.equal(data, '/nofilter/test')
+          $.ajax({
+            url: defaultURL + 'filter/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
     it('receives details object', function (done) {
       ses.webRequest.onBeforeRequest(function (details, callback) {
         assert.equal(typeof details.id, 'number')
@@ -433,6 +464,31 @@ describe('webRequest module', function () {
     })
   })
 
+  describe('batched listeners', function () {
+    afterEach(function () {
+      ses.webRequest.onCompleted(null)
+    })
+
+    it('receives arrays of details objects', function (done) {
+      ses.webRequest.onCompleted({batchSize: 2, batchInterval: 10000}, function (detailsArray) {
+        assert.equal(detailsArray.length, 2)
+        assert.equal(detailsArray[0].url, defaultURL + 'batch/1')
+        assert.equal(detailsArray[1].url, defaultURL + 'batch/2')
+        assert.equal(detailsArray[1].statusCode, 200)
+        done()
+      })
+      $.get(defaultURL + 'batch/1', function () {
+        $.get(defaultURL + 'batch/2')
+      })
+    })
+
+    it('rejects invalid batch options', function () {
+      assert.throws(function () {
+        ses.webRequest.onCompleted({batchSize: 0}, function () {})
+      })
+    })
+  })
+
   describe('webRequest.onErrorOccurred', function () {
     afterEach(function () {
       ses.webRequest.onErrorOccurred(null)
@@ -457,4 +513,75 @@ describe('webRequest module', function () {
       })
     })
   })
+
+  describe('webRequest.setRules', function () {
+    afterEach(function () {
+      ses.webRequest.setRules(null)
+      ses.webRequest.onHeadersReceived(null)
+    })
+
+    it('can block requests', function (done) {
+      ses.webRequest.setRules([{action: 'block', urls: [defaultURL + 'blocked/*']}])
+      $.ajax({
+        url: defaultURL + 'allowed/test',
+        success: function (data) {
+          assert.equal(data, '/allowed/test')
+          $.ajax({
+            url: defaultURL + 'blocked/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('modifies headers before listeners see them', function (done) {
+      ses.webRequest.setRules([{
+        action: 'modifyHeaders',
+        responseHeaders: {set: {'Custom': 'Rule'}}
+      }])
+      ses.webRequest.onHeadersReceived(function (details, callback) {
+        assert.deepEqual(details.responseHeaders['Custom'], ['Rule'])
+        callback({})
+      })
+      $.ajax({
+        url: defaultURL,
+        success: function (data, status, xhr) {
+          assert.equal(xhr.getResponseHeader('Custom'), 'Rule')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('throws on invalid rules', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{action: 'unknown'}])
+      })
+    })
+
+    it('throws on rules with invalid headers', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{
+          action: 'modifyHeaders',
+          responseHeaders: {set: {'X-Test': 'a\r\nSet-Cookie: b=c'}}
+        }])
+      })
+      assert.throws(function () {
+        ses.webRequest.setRules([{
+          action: 'modifyHeaders',
+          requestHeaders: {remove: ['bad name']}
+        }])
+      })
+    })
+  })
 })
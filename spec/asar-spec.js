@@ -670,6 +670,25 @@ describe('asar package', function () {
       })
     })
 
+    describe('extracted files', function () {
+      var createArchive = process.binding('atom_common_asar').createArchive
+      var archivePath = path.join(fixtures, 'asar', 'a.asar')
+
+      it('are shared between archives', function () {
+        var first = createArchive(archivePath).copyFileOut('file1')
+        var second = createArchive(archivePath).copyFileOut('file1')
+        assert.equal(first, second)
+        assert.equal(fs.readFileSync(first).toString().trim(), 'file1')
+      })
+
+      it('are extracted again when their size changed', function () {
+        var copy = createArchive(archivePath).copyFileOut('file2')
+        fs.writeFileSync(copy, 'damaged file2')
+        var again = createArchive(archivePath).copyFileOut('file2')
+        assert.equal(fs.readFileSync(again).toString().trim(), 'file2')
+      })
+    })
+
     describe('internalModuleReadFile', function () {
       var internalModuleReadFile = process.binding('fs').internalModuleReadFile
 
@@ -941,4 +960,29 @@ describe('asar package', function () {
       })
     })
   })
+
+  describe('archive cache', function () {
+    var asar = process.binding('atom_common_asar')
+
+    it('reuses opened archives', function () {
+      var p = path.join(fixtures, 'asar', 'logo.asar', 'logo.png')
+      nativeImage.createFromPath(p)
+      var before = asar.getArchiveCacheStats()
+      nativeImage.createFromPath(p)
+      var after = asar.getArchiveCacheStats()
+      assert(after.hits > before.hits)
+      assert.equal(after.opens, before.opens)
+    })
+
+    it('limits the total number of opened archives', function () {
+      asar.setArchiveCacheLimit(1)
+      try {
+        nativeImage.createFromPath(path.join(fixtures, 'asar', 'logo.asar', 'logo.png'))
+        nativeImage.createFromPath(path.join(fixtures, 'asar', 'unpack.asar', 'atom.png'))
+        assert.equal(asar.getArchiveCacheStats().size, 1)
+      } finally {
+        asar.setArchiveCacheLimit(0)
+      }
+    })
+  })
 })
@@ -0,0 +1,18 @@
+const {app, session} = require('electron')
+
+const result = {}
+
+try {
+  session.fromPartition('default')
+} catch (error) {
+  result.beforeReady = error.message
+}
+
+app.on('ready', function () {
+  result.isOffTheRecord = session.fromPartition('default').isOffTheRecord()
+  session.defaultSession.appState.get('spec', function () {
+    result.appState = true
+    console.log(JSON.stringify(result))
+    app.quit()
+  })
+})
@@ -40,6 +40,10 @@ ipcMain.on('message', function (event, ...args) {
   event.sender.send('message', ...args)
 })
 
+ipcMain.on('cloned-message', function (event, ...args) {
+  event.sender.sendCloned('cloned-message', ...args)
+})
+
 // Set productName so getUploadedReports() uses the right directory in specs
 if (process.platform === 'win32') {
   crashReporter.productName = 'Zombies'
@@ -66,10 +70,18 @@ ipcMain.on('eval', function (event, script) {
   event.returnValue = eval(script) // eslint-disable-line
 })
 
+ipcMain.on('eval-cloned', function (event, script) {
+  event.sendReplyCloned(eval(script)) // eslint-disable-line
+})
+
 ipcMain.on('echo', function (event, msg) {
   event.returnValue = msg
 })
 
+ipcMain.on('echo-cloned', function (event, msg) {
+  event.sendReplyCloned(msg)
+})
+
 const coverage = new Coverage({
   outputPath: path.join(__dirname, '..', '..', 'out', 'coverage')
 })